@@ -34,6 +34,9 @@
 #include <math.h>
 
 #define CALC_EPS       (1.0 / 100000.0)        ///< Epsilon, comparison with zero precision
+#define SENS_REL_STEP  (1.0 / 10000.0)         ///< Relative parameter step for the sensitivity of lambda
+#define SENS_MIN_VALUE (1.0 / 100.0)           ///< Parameter magnitude below which the step is no longer relative
+#define REACH_U_STEPS  10                      ///< Number of foraging intensity intervals sampled by the reachability pass
 
 #include "Decision.h"
 #include "Optimizer.h"
@@ -56,258 +59,83 @@ void Backward::SetDecision(Decision *dec) {
 
 void Backward::Stoch_HMcN_AddStochNone(double x_case, double y_case, BwStochResultStruct &result)
 {
-    // Stochasticity for variable x (reserves)
-	int    x_ln1_ind = (int)((x_case-_min_x) * _inverse_dx);	// Determine the first lower node
-	if (x_ln1_ind >= (int)_x_cnt)
-		x_ln1_ind  = _x_cnt-1;
-	double x_ln1     = (_min_x + x_ln1_ind * _dx);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double x_ln1 = _x_vec[x_ln1_ind];
-
-	int x_un1_ind = x_ln1_ind + 1;							// index of 1st upper node
-	if (x_un1_ind>=(int)_x_cnt)
-		x_un1_ind = _x_cnt-1;
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_x_un1 = (x_case-x_ln1)/_dx;			// probability of 1st upper node, linear case
-    double p_x_ln1 = 1-p_x_un1;						// probability of 1st lower node, linear case  
-	
-     // Stochasticity for variable y (condition)
-	int y_ln1_ind = (int)((y_case-_min_y) * _inverse_dy);	// Determine the first lower node
-	if (y_ln1_ind >= (int)_y_cnt)
-		y_ln1_ind  = _y_cnt-1;
-	double y_ln1   = (_min_y + y_ln1_ind * _dy);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double y_ln1 = _y_vec[y_ln1_ind];
-
-	int y_un1_ind = y_ln1_ind + 1;							// index of 1st upper node
-	if (y_un1_ind>=(int)_y_cnt)
-		y_un1_ind = _y_cnt-1;
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_y_un1 = (y_case-y_ln1)/_dy;					// probability of 1st upper node, linear case
-    double p_y_ln1 = 1-p_y_un1;						// probability of 1st lower node, linear case
-    
-	// Interpolate f according to above stochasticity:
-	result.curr_approx =
-		p_x_ln1*p_y_ln1*_f_curr(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_curr(x_un1_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_curr(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_curr(x_un1_ind,y_ln1_ind) ;
-
-	result.next_approx =
-		p_x_ln1*p_y_ln1*_f_next(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_next(x_un1_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_next(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_next(x_un1_ind,y_ln1_ind) ;
+	Stoch_HMcN_Stencil<2,2>(x_case, y_case, result);
 }
 
 
 void Backward::Stoch_HMcN_AddStochRes(double x_case, double y_case, BwStochResultStruct &result)
 {
-    // Stochasticity for variable x (reserves)
-	int x_ln1_ind = (int)((x_case-_min_x) * _inverse_dx);	// Determine the first lower node
-	if (x_ln1_ind >= (int)_x_cnt)
-		x_ln1_ind  = _x_cnt-1;
-	double x_ln1  = (_min_x + x_ln1_ind * _dx);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double x_ln1 = _x_vec[x_ln1_ind];
-
-	int x_ln2_ind = x_ln1_ind - 1;							// index of 2nd lower node
-	if (x_ln2_ind<0)
-		x_ln2_ind=0;
-
-	int x_un1_ind = x_ln1_ind + 1;							// index of 1st upper node
-	if (x_un1_ind>=(int)_x_cnt)
-		x_un1_ind = _x_cnt-1;
-
-	int x_un2_ind = x_ln1_ind + 2;							// index of 2nd upper node
-	if (x_un2_ind>=(int)_x_cnt)
-		x_un2_ind = _x_cnt-1;
-
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_x_un1_lc = (x_case-x_ln1)/_dx;					// probability of 1st upper node, linear case
-    double p_x_ln1_lc = 1-p_x_un1_lc;						// probability of 1st lower node, linear case
-    
-    // Control degree of stochasticity through stochfac alpha:
-    double p_x_ln2 = _stochfac_x * p_x_ln1_lc;									 // probability of 2nd lower node
-    double p_x_ln1 = (1-2*_stochfac_x) * p_x_ln1_lc + _stochfac_x * p_x_un1_lc;  // probability of 1st lower node
-    double p_x_un1 = _stochfac_x * p_x_ln1_lc + (1-2*_stochfac_x) * p_x_un1_lc;  // probability of 1st upper node
-    double p_x_un2 = _stochfac_x * p_x_un1_lc;									 // probability of 2nd upper node
-    
-    // Stochasticity for variable y (condition)
-	int    y_ln1_ind = (int)((y_case-_min_y) * _inverse_dy);	// Determine the lower upper node
-	if (y_ln1_ind >= (int)_y_cnt)
-		y_ln1_ind  = _y_cnt-1;
-	double y_ln1     = (_min_y + y_ln1_ind * _dy);			// value of 1st lower node, within range of grid
-	int y_un1_ind    = y_ln1_ind + 1;						// index of first upper node
-	if (y_un1_ind>=(int)_y_cnt)
-		y_un1_ind = _y_cnt-1;
-
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_y_un1 = (y_case-y_ln1)/_dy;                    // probability of 1st upper node  
-    double p_y_ln1 = 1-p_y_un1;                             // probability of 1st lower node
-    
-	// Interpolate f according to above stochasticity:
-	result.curr_approx =
-		p_x_ln1*p_y_ln1*_f_curr(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_curr(x_un1_ind,y_un1_ind) +
-		p_x_ln2*p_y_ln1*_f_curr(x_ln2_ind,y_ln1_ind) + p_x_ln2*p_y_un1*_f_curr(x_ln2_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_curr(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_curr(x_un1_ind,y_ln1_ind) +
-		p_x_un2*p_y_ln1*_f_curr(x_un2_ind,y_ln1_ind) + p_x_un2*p_y_un1*_f_curr(x_un2_ind,y_un1_ind);
-
-	result.next_approx =
-		p_x_ln1*p_y_ln1*_f_next(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_next(x_un1_ind,y_un1_ind) +
-		p_x_ln2*p_y_ln1*_f_next(x_ln2_ind,y_ln1_ind) + p_x_ln2*p_y_un1*_f_next(x_ln2_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_next(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_next(x_un1_ind,y_ln1_ind) +
-		p_x_un2*p_y_ln1*_f_next(x_un2_ind,y_ln1_ind) + p_x_un2*p_y_un1*_f_next(x_un2_ind,y_un1_ind);
+	Stoch_HMcN_Stencil<4,2>(x_case, y_case, result);
 }
 
 
 void Backward::Stoch_HMcN_AddStochHealth(double x_case, double y_case, BwStochResultStruct &result)
 {
-    // Stochasticity for variable x (reserves)
-	int    x_ln1_ind = (int)((x_case-_min_x) * _inverse_dx);	// Determine the first lower node
-	if (x_ln1_ind >= (int)_x_cnt)
-		x_ln1_ind  = _x_cnt-1;
-	double x_ln1     = (_min_x + x_ln1_ind * _dx);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double x_ln1 = _x_vec[x_ln1_ind];
-
-	int x_un1_ind = x_ln1_ind + 1;							// index of 1st upper node
-	if (x_un1_ind>=(int)_x_cnt)
-		x_un1_ind = _x_cnt-1;
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_x_un1 = (x_case-x_ln1)/_dx;			// probability of 1st upper node, linear case
-    double p_x_ln1 = 1-p_x_un1;						// probability of 1st lower node, linear case  
-	
-     // Stochasticity for variable y (condition)
-	int y_ln1_ind = (int)((y_case-_min_y) * _inverse_dy);	// Determine the first lower node
-	if (y_ln1_ind >= (int)_y_cnt)
-		y_ln1_ind  = _y_cnt-1;
-	double y_ln1   = (_min_y + y_ln1_ind * _dy);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double y_ln1 = _y_vec[y_ln1_ind];
-
-	int y_ln2_ind = y_ln1_ind - 1;							// index of 2nd lower node
-	if (y_ln2_ind<0)
-		y_ln2_ind=0;
-
-	int y_un1_ind = y_ln1_ind + 1;							// index of 1st upper node
-	if (y_un1_ind>=(int)_y_cnt)
-		y_un1_ind = _y_cnt-1;
-
-	int y_un2_ind = y_ln1_ind + 2;							// index of 2nd upper node
-	if (y_un2_ind>=(int)_y_cnt)
-		y_un2_ind = _y_cnt-1;
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_y_un1_lc = (y_case-y_ln1)/_dy;					// probability of 1st upper node, linear case
-    double p_y_ln1_lc = 1-p_y_un1_lc;						// probability of 1st lower node, linear case
-    
-    // Control degree of stochasticity through stochfac alpha:
-    double p_y_ln2 = _stochfac_x * p_y_ln1_lc;									 // probability of 2nd lower node
-    double p_y_ln1 = (1-2*_stochfac_x) * p_y_ln1_lc + _stochfac_x * p_y_un1_lc;  // probability of 1st lower node
-    double p_y_un1 = _stochfac_x * p_y_ln1_lc + (1-2*_stochfac_x) * p_y_un1_lc;  // probability of 1st upper node
-    double p_y_un2 = _stochfac_x * p_y_un1_lc;									 // probability of 2nd upper node
-    
-	// Interpolate f according to above stochasticity:
-	result.curr_approx =
-		p_x_ln1*p_y_ln1*_f_curr(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_curr(x_un1_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_curr(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_curr(x_un1_ind,y_ln1_ind) +
-		p_x_ln1*p_y_ln2*_f_curr(x_ln1_ind,y_ln2_ind) + p_x_un1*p_y_un2*_f_curr(x_un1_ind,y_un2_ind) +
-		p_x_ln1*p_y_un2*_f_curr(x_ln1_ind,y_un2_ind) + p_x_un1*p_y_ln2*_f_curr(x_un1_ind,y_ln2_ind) ;
-
-	result.next_approx =
-		p_x_ln1*p_y_ln1*_f_next(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_next(x_un1_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_next(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_next(x_un1_ind,y_ln1_ind) +
-		p_x_ln1*p_y_ln2*_f_next(x_ln1_ind,y_ln2_ind) + p_x_un1*p_y_un2*_f_next(x_un1_ind,y_un2_ind) +
-		p_x_ln1*p_y_un2*_f_next(x_ln1_ind,y_un2_ind) + p_x_un1*p_y_ln2*_f_next(x_un1_ind,y_ln2_ind) ;
+	Stoch_HMcN_Stencil<2,4>(x_case, y_case, result);
 }
 
 
 void Backward::Stoch_HMcN_AddStochResHealth(double x_case, double y_case, BwStochResultStruct &result)
 {
-    // Stochasticity for variable x (reserves)
-	int    x_ln1_ind = (int)((x_case-_min_x) * _inverse_dx);	// Determine the first lower node
-	if (x_ln1_ind >= (int)_x_cnt)
-		x_ln1_ind  = _x_cnt-1;
-	double x_ln1     = (_min_x + x_ln1_ind * _dx);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double x_ln1 = _x_vec[x_ln1_ind];
-
-	int x_ln2_ind = x_ln1_ind - 1;							// index of 2nd lower node
-	if (x_ln2_ind<0)
-		x_ln2_ind=0;
-
-	int x_un1_ind = x_ln1_ind + 1;							// index of 1st upper node
-	if (x_un1_ind>=(int)_x_cnt)
-		x_un1_ind = _x_cnt-1;
-
-	int x_un2_ind = x_ln1_ind + 2;							// index of 2nd upper node
-	if (x_un2_ind>=(int)_x_cnt)
-		x_un2_ind = _x_cnt-1;
-
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_x_un1_lc = (x_case-x_ln1)/_dx;					// probability of 1st upper node, linear case
-    double p_x_ln1_lc = 1-p_x_un1_lc;						// probability of 1st lower node, linear case
-    
-    // Control degree of stochasticity through stochfac alpha:
-    double p_x_ln2 = _stochfac_x * p_x_ln1_lc;									 // probability of 2nd lower node
-    double p_x_ln1 = (1-2*_stochfac_x) * p_x_ln1_lc + _stochfac_x * p_x_un1_lc;  // probability of 1st lower node
-    double p_x_un1 = _stochfac_x * p_x_ln1_lc + (1-2*_stochfac_x) * p_x_un1_lc;  // probability of 1st upper node
-    double p_x_un2 = _stochfac_x * p_x_un1_lc;									 // probability of 2nd upper node
-    
-	
-     // Stochasticity for variable y (condition)
-	int y_ln1_ind = (int)((y_case-_min_y) * _inverse_dy);	// Determine the first lower node
-	if (y_ln1_ind >= (int)_y_cnt)
-		y_ln1_ind  = _y_cnt-1;
-	double y_ln1   = (_min_y + y_ln1_ind * _dy);			// value of 1st lower node, within range of grid
-	//Same as:
-	// double y_ln1 = _y_vec[y_ln1_ind];
-
-	int y_ln2_ind = y_ln1_ind - 1;							// index of 2nd lower node
-	if (y_ln2_ind<0)
-		y_ln2_ind=0;
-
-	int y_un1_ind = y_ln1_ind + 1;							// index of 1st upper node
-	if (y_un1_ind>=(int)_y_cnt)
-		y_un1_ind = _y_cnt-1;
-
-	int y_un2_ind = y_ln1_ind + 2;							// index of 2nd upper node
-	if (y_un2_ind>=(int)_y_cnt)
-		y_un2_ind = _y_cnt-1;
-
-    // Set probabilities that the value of these nodes is taken:
-    double p_y_un1_lc = (y_case-y_ln1)/_dy;					// probability of 1st upper node, linear case
-    double p_y_ln1_lc = 1-p_y_un1_lc;						// probability of 1st lower node, linear case
-    
-    // Control degree of stochasticity through stochfac alpha:
-    double p_y_ln2 = _stochfac_x * p_y_ln1_lc;									 // probability of 2nd lower node
-    double p_y_ln1 = (1-2*_stochfac_x) * p_y_ln1_lc + _stochfac_x * p_y_un1_lc;  // probability of 1st lower node
-    double p_y_un1 = _stochfac_x * p_y_ln1_lc + (1-2*_stochfac_x) * p_y_un1_lc;  // probability of 1st upper node
-    double p_y_un2 = _stochfac_x * p_y_un1_lc;									 // probability of 2nd upper node
-    
-	// Interpolate f according to above stochasticity:
-	result.curr_approx =
-		p_x_ln1*p_y_ln1*_f_curr(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_curr(x_un1_ind,y_un1_ind) +
-		p_x_ln2*p_y_ln1*_f_curr(x_ln2_ind,y_ln1_ind) + p_x_ln2*p_y_un1*_f_curr(x_ln2_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_curr(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_curr(x_un1_ind,y_ln1_ind) +
-		p_x_un2*p_y_ln1*_f_curr(x_un2_ind,y_ln1_ind) + p_x_un2*p_y_un1*_f_curr(x_un2_ind,y_un1_ind) +
-		p_x_ln1*p_y_ln2*_f_curr(x_ln1_ind,y_ln2_ind) + p_x_un1*p_y_un2*_f_curr(x_un1_ind,y_un2_ind) +
-		p_x_ln2*p_y_ln2*_f_curr(x_ln2_ind,y_ln2_ind) + p_x_ln2*p_y_un2*_f_curr(x_ln2_ind,y_un2_ind) +
-		p_x_ln1*p_y_un2*_f_curr(x_ln1_ind,y_un2_ind) + p_x_un1*p_y_ln2*_f_curr(x_un1_ind,y_ln2_ind) +
-		p_x_un2*p_y_ln2*_f_curr(x_un2_ind,y_ln2_ind) + p_x_un2*p_y_un2*_f_curr(x_un2_ind,y_un2_ind);
-
-	result.next_approx =
-		p_x_ln1*p_y_ln1*_f_next(x_ln1_ind,y_ln1_ind) + p_x_un1*p_y_un1*_f_next(x_un1_ind,y_un1_ind) +
-		p_x_ln2*p_y_ln1*_f_next(x_ln2_ind,y_ln1_ind) + p_x_ln2*p_y_un1*_f_next(x_ln2_ind,y_un1_ind) +
-		p_x_ln1*p_y_un1*_f_next(x_ln1_ind,y_un1_ind) + p_x_un1*p_y_ln1*_f_next(x_un1_ind,y_ln1_ind) +
-		p_x_un2*p_y_ln1*_f_next(x_un2_ind,y_ln1_ind) + p_x_un2*p_y_un1*_f_next(x_un2_ind,y_un1_ind) +
-		p_x_ln1*p_y_ln2*_f_next(x_ln1_ind,y_ln2_ind) + p_x_un1*p_y_un2*_f_next(x_un1_ind,y_un2_ind) +
-		p_x_ln2*p_y_ln2*_f_next(x_ln2_ind,y_ln2_ind) + p_x_ln2*p_y_un2*_f_next(x_ln2_ind,y_un2_ind) +
-		p_x_ln1*p_y_un2*_f_next(x_ln1_ind,y_un2_ind) + p_x_un1*p_y_ln2*_f_next(x_un1_ind,y_ln2_ind) +
-		p_x_un2*p_y_ln2*_f_next(x_un2_ind,y_ln2_ind) + p_x_un2*p_y_un2*_f_next(x_un2_ind,y_un2_ind);
+	Stoch_HMcN_Stencil<4,4>(x_case, y_case, result);
+}
+
+
+void Backward::Stoch_HMcN_LowRank(double x_case, double y_case, BwStochResultStruct &result)
+{
+	int    xi[4], yi[4];
+	double px[4], py[4];
+	int    nx, ny;
+
+	// The stencil widths follow the additional stochasticity of each axis
+	if (_stoch_add_x) {
+		nx = 4;
+		GridStencilAxis<4>::Nodes(_x_grid, x_case, _stochfac_x, xi, px);
+	}
+	else {
+		nx = 2;
+		GridStencilAxis<2>::Nodes(_x_grid, x_case, _stochfac_x, xi, px);
+	}
+
+	if (_stoch_add_y) {
+		ny = 4;
+		GridStencilAxis<4>::Nodes(_y_grid, y_case, _stochfac_x, yi, py);
+	}
+	else {
+		ny = 2;
+		GridStencilAxis<2>::Nodes(_y_grid, y_case, _stochfac_x, yi, py);
+	}
+
+	result.curr_approx = InterpolateSlice(_lr_curr, nx,xi,px, ny,yi,py);
+	result.next_approx = InterpolateSlice(_lr_next, nx,xi,px, ny,yi,py);
+}
+
+
+double Backward::InterpolateSlice(BwSliceStruct &slice, int nx, int *xi, double *px, int ny, int *yi, double *py)
+{
+	double f = 0;
+
+	// Densely held slice of the decision epoch currently written
+	if (slice.rank < 0) {
+		for (int j=0;j<ny;j++) {
+			double fy = 0;
+			for (int i=0;i<nx;i++)
+				fy += px[i] * slice.u[xi[i] + yi[j]*_x_cnt];
+			f += py[j] * fy;
+		}
+		return f;
+	}
+
+	// Rank one terms are interpolated separately in x and y
+	for (int k=0;k<slice.rank;k++) {
+		double fx = 0, fy = 0;
+		for (int i=0;i<nx;i++)
+			fx += px[i] * slice.u[xi[i]*_lr_stride + k];
+		for (int j=0;j<ny;j++)
+			fy += py[j] * slice.v[yi[j]*_lr_stride + k];
+		f += fx * fy;
+	}
+	return f;
 }
 
 //--------------------------------------
@@ -363,20 +191,10 @@ double Backward::H_m (double x, double y, int e, int a, int o, int s, int t, dou
 	return H_mg(x, y, res.curr_approx, res.next_approx);
 }
 
-bool Backward::InitBackward(Settings *settings, double theta) {
+void Backward::InitParameters(Settings *settings, double theta) {
 
-    if (!_decision) {
-        printf("Backward::InitBackward() ERROR: 'decision' not initialized\n");
-		return false;
-    }
-    
-    // prepare parameters
-    
 	InitStateFuncs(settings,theta);
     
-    _decision->SetTheta(theta);		// Copy value, to be used in Forward
-    _decision->SetLambda(0.0);      // Initial value
-    
     _n                = settings->GetN();
 	_n_min            = settings->GetNMin();
     _t_cnt            = settings->GetTCnt();
@@ -395,79 +213,369 @@ bool Backward::InitBackward(Settings *settings, double theta) {
     _x_cnt            = settings->GetXCnt();
     _y_cnt            = settings->GetYCnt();
 
-    _dx               = settings->GetDx();
-    _dy               = settings->GetDy();
-	_inverse_dx       = 1.0 / _dx; 
-	_inverse_dy       = 1.0 / _dy;
-    
     _stochfac_x       = settings->GetStochFacX();
  
-	_min_x            = settings->GetXMin();
-	_min_y            = settings->GetYMin();
+	_x_grid.Init(settings->GetXMin(), settings->GetXMax(), settings->GetGridX(), settings->GetGridXRatio() );
+	_y_grid.Init(settings->GetYMin(), settings->GetYMax(), settings->GetGridY(), settings->GetGridYRatio() );
 
 	_x_vec.Init(_x_cnt);
 	_y_vec.Init(_y_cnt);
 	
     for (unsigned int x=0;x<_x_cnt;x++)
-        _x_vec[x] = _min_x+ x*_dx;
+        _x_vec[x] = _x_grid[x];
     for (unsigned int y=0;y<_y_cnt;y++)
-        _y_vec[y] = _min_y+ y*_dy;
+        _y_vec[y] = _y_grid[y];
 
 	_x_indep = settings->GetXindep();
     _y_indep = settings->GetYindep();  
 
 	_migr_dur = settings->GetMigrDur();
+	_enable_migration = settings->GetEnableMigration();
+
+	// The batch forward run starts cohorts in every start week and location, which reach the states pruned for the single cohort
+	_prune_states  = settings->GetPruneUnreachableStates() && !settings->GetUserInitStartPop() && settings->GetEnvYears() == 1 && !settings->GetForwardBatchAllStarts();
+	_prune_halo    = settings->GetPruneHalo();
+	_start_week_fw = settings->GetStartWeekFW();
+	_start_loc_fw  = settings->GetStartLocationFW();
+
+	// Initialize the _stoch_hmcn_func function pointer to of the four grid interpolation functions
+	// A call to Stoch_HMcN() then calls the selected function 
+	unsigned int idx = ((settings->GetStochAddReserves()?1:0) + (settings->GetStochAddHealth()?2:0));
+	switch(idx)
+	{
+	case 0: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochNone;      break;
+	case 1: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochRes;       break;
+	case 2: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochHealth;    break;
+	case 3: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochResHealth; break;
+	}
 
-	// Allocate the arrays once and re-use them later
-    _f_curr.Init(_x_cnt,_y_cnt);
-    _f_next.Init(_x_cnt,_y_cnt);
+	// The low-rank mode interpolates all variants directly from the factors
+	_stoch_add_x = settings->GetStochAddReserves();
+	_stoch_add_y = settings->GetStochAddHealth();
+	_low_rank    = _decision && _decision->IsLowRank();
+	if (_low_rank) {
+		_lr_stride       = _decision->GetLowRankStride();
+		_stoch_hmcn_func = &Backward::Stoch_HMcN_LowRank;
+	}
+}
+
+
+bool Backward::InitBackward(Settings *settings, double theta) {
+
+    if (!_decision) {
+        printf("Backward::InitBackward() ERROR: 'decision' not initialized\n");
+		return false;
+    }
+    
+    // prepare parameters
+    
+	if ( !_decision->IsInitialized() )
+		_decision->SetLowRank(settings->GetLowRankTolerance(), settings->GetLowRankMaxRank() );
+
+	InitParameters(settings, theta);
+    
+    _decision->SetTheta(theta);		// Copy value, to be used in Forward
+    _decision->SetGridRatio(_x_grid.GetRatio(), _y_grid.GetRatio() );
+    _decision->SetLambda(0.0);      // Initial value
 
     //----------------------------------------------
     // set up arrays and set terminal condition
 
     if ( !_decision->IsInitialized() ) {
+		// Fail before the allocation if the state arrays can not be held
+		double dense_mb;
+		double mb = _decision->EstimateMemoryMB( _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt, dense_mb );
+		printf("Decision state arrays: %.1f MB%s, dense f_u and f_strat %.1f MB\n", mb, _decision->IsLowRank() ? " with low-rank f" : "", dense_mb);
+		if (mb > DC_MEMORY_MAX_MB) {
+			printf("Backward::InitBackward() ERROR: the state arrays need %.1f MB, more than DC_MEMORY_MAX_MB (%.1f MB)%s\n",
+				mb, DC_MEMORY_MAX_MB, _decision->IsLowRank() ? ", the low-rank mode only compresses f" : "");
+			return false;
+		}
+
+		int layout = settings->GetDecisionLayout();
+		if (layout == DC_LAYOUT_AUTO)
+			layout = Decision::BenchmarkLayouts( _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt, _decision->IsLowRank(), true );
+		_decision->SetLayout(layout);
         _decision->InitDimensions( _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt );
 
-		for (unsigned int x=0;x<_x_cnt;x++) {
+		char *warmStartFile = settings->GetWarmStartFile();
+		bool warmStarted    = false;
+		if (warmStartFile[0] != 0) {
+			warmStarted = InitFromWarmStartFile(warmStartFile, settings->GetIncubation() );
+			if (!warmStarted) {
+				printf("Warning:  Warm start from '%s' failed, using the terminal condition f=1 instead\n",warmStartFile);
+			}
+		}
+
+		if (!warmStarted)
+			_decision->FillF(1);
+
+		// Decision epochs outermost, the low-rank mode holds only one of them densely
+		for (unsigned int t=0;t<_t_cnt;t++) {
 			for (unsigned int y=0;y<_y_cnt;y++) {
 				for (unsigned int e=0;e<_e_cnt;e++) {
 					for (unsigned int a=0;a<_a_cnt;a++) {
 						for (unsigned int o=0;o<_o_cnt;o++) {
 							for (unsigned int s=0;s<_s_cnt;s++) {
-								for (unsigned int t=0;t<_t_cnt;t++) {
-									_decision->SetF(x,y,e,a,o,s,t, 1);
-								} } } } } } }
-
-		for (unsigned int y=0;y<_y_cnt;y++) {
-			for (unsigned int e=0;e<_e_cnt;e++) {
-				for (unsigned int a=0;a<_a_cnt;a++) {
-					for (unsigned int o=0;o<_o_cnt;o++) {
-						for (unsigned int s=0;s<_s_cnt;s++) {
-							for (unsigned int t=0;t<_t_cnt;t++) {
 								_decision->SetF_strat(0,y,e,a,o,s,t, 'n');
 								_decision->SetF(0,y,e,a,o,s,t, 0);
 							} } } } } }
 
     }  
 
-	// Initialize the _stoch_hmcn_func function pointer to of the four grid interpolation functions
-	// A call to Stoch_HMcN() then calls the selected function 
-	unsigned int idx = ((settings->GetStochAddReserves()?1:0) + (settings->GetStochAddHealth()?2:0));
-	switch(idx)
-	{
-	case 0: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochNone;      break;
-	case 1: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochRes;       break;
-	case 2: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochHealth;    break;
-	case 3: _stoch_hmcn_func = &Backward::Stoch_HMcN_AddStochResHealth; break;
+	return true;
+}
+
+
+bool Backward::InitFromWarmStartFile(char *filename, unsigned int incubation) {
+
+	Decision prev;
+	if (!prev.LoadFromFile(filename) ) {
+		return false;
+	}
+
+	NArrayFixed<double,7> f_prev(prev.GetFView());
+	unsigned int x_prev = prev.GetDim(0);
+	unsigned int y_prev = prev.GetDim(1);
+	unsigned int e_prev = prev.GetDim(2);
+	unsigned int a_prev = prev.GetDim(3);
+
+	// Locations, migration durations and decision epochs can not be remapped
+	if (prev.GetDim(4)!=_o_cnt || prev.GetDim(5)!=_s_cnt || prev.GetDim(6)!=_t_cnt) {
+		printf("Backward::InitFromWarmStartFile(%s) error: locations, migration duration or decision epochs differ\n",filename);
+		return false;
+	}
+	if (a_prev < incubation+2 || _a_cnt < incubation+2) {
+		printf("Backward::InitFromWarmStartFile(%s) error: duration of incubation differs\n",filename);
+		return false;
 	}
 
+	printf("Warm start from '%s' (x=%u y=%u e=%u a=%u  =>  x=%u y=%u e=%u a=%u)\n",
+		filename, x_prev,y_prev,e_prev,a_prev, _x_cnt,_y_cnt,_e_cnt,_a_cnt);
+
+	// Reserves and health: linear interpolation, both grids span the same range [min,max],
+	// the previous nodes are rebuilt from the current axes and the spacing ratio of the file
+	GridAxis x_grid_prev, y_grid_prev;
+	x_grid_prev.Init(_x_grid[0], _x_grid[_x_cnt-1], x_prev-1, prev.GetGridXRatio() );
+	y_grid_prev.Init(_y_grid[0], _y_grid[_y_cnt-1], y_prev-1, prev.GetGridYRatio() );
+
+	NArray<int>    x_lo, x_hi, y_lo, y_hi;
+	NArray<double> x_w,  y_w;
+	x_lo.Init(_x_cnt); x_hi.Init(_x_cnt); x_w.Init(_x_cnt);
+	y_lo.Init(_y_cnt); y_hi.Init(_y_cnt); y_w.Init(_y_cnt);
+
+	for (unsigned int x=0;x<_x_cnt;x++) {
+		x_lo[x] = x_grid_prev.LowerIndex(_x_vec[x]);
+		x_hi[x] = (x_lo[x]+1 < (int)x_prev) ? x_lo[x]+1 : x_lo[x];
+		x_w[x]  = (x_hi[x] > x_lo[x]) ? (_x_vec[x]-x_grid_prev[x_lo[x]]) * x_grid_prev.InverseSpacing(x_lo[x]) : 0;
+	}
+	for (unsigned int y=0;y<_y_cnt;y++) {
+		y_lo[y] = y_grid_prev.LowerIndex(_y_vec[y]);
+		y_hi[y] = (y_lo[y]+1 < (int)y_prev) ? y_lo[y]+1 : y_lo[y];
+		y_w[y]  = (y_hi[y] > y_lo[y]) ? (_y_vec[y]-y_grid_prev[y_lo[y]]) * y_grid_prev.InverseSpacing(y_lo[y]) : 0;
+	}
+
+	// Age: no brood and incubation stay, the care stages are stretched onto the previous ones
+	// and the independence of the young maps onto the previous independence
+	NArray<int> a_map;
+	a_map.Init(_a_cnt);
+	unsigned int care_cnt      = _a_cnt - incubation - 2;
+	unsigned int care_cnt_prev = a_prev - incubation - 2;
+	for (unsigned int a=0;a<_a_cnt;a++) {
+		if (a <= incubation)
+			a_map[a] = a;
+		else if (a == _a_cnt-1)
+			a_map[a] = a_prev-1;
+		else if (care_cnt_prev == 0)
+			a_map[a] = a_prev-2;
+		else if (care_cnt == 1)
+			a_map[a] = incubation+1;
+		else
+			a_map[a] = incubation+1 + (int)floor( (double)(a-incubation-1) * (care_cnt_prev-1) / (double)(care_cnt-1) + 0.5);
+	}
+
+	for (unsigned int t=0;t<_t_cnt;t++) {
+		for (unsigned int e=0;e<_e_cnt;e++) {
+			// Experience: levels above the previous maximum keep the value of the maximum
+			unsigned int ep = (e < e_prev) ? e : e_prev-1;
+			for (unsigned int a=0;a<_a_cnt;a++) {
+				for (unsigned int o=0;o<_o_cnt;o++) {
+					for (unsigned int s=0;s<_s_cnt;s++) {
+						for (unsigned int x=0;x<_x_cnt;x++) {
+							for (unsigned int y=0;y<_y_cnt;y++) {
+								double f = 
+									(1-x_w[x]) * (1-y_w[y]) * f_prev(x_lo[x],y_lo[y],ep,a_map[a],o,s,t) +
+									(1-x_w[x]) *    y_w[y]  * f_prev(x_lo[x],y_hi[y],ep,a_map[a],o,s,t) +
+									   x_w[x]  * (1-y_w[y]) * f_prev(x_hi[x],y_lo[y],ep,a_map[a],o,s,t) +
+									   x_w[x]  *    y_w[y]  * f_prev(x_hi[x],y_hi[y],ep,a_map[a],o,s,t);
+								_decision->SetF(x,y,e,a,o,s,t, f);
+							} } } } } } }
+
 	return true;
 }
 
 
+//---------------------------------------
+// Reachable-state pruning
+//
+// Starting with the forward cohort of independent young, all states reachable under any behavioral
+// decision and foraging intensity are marked. Since the transitions do not depend on the decision, 
+// the set is a superset of the states the optimal strategy visits and can be computed once per run.
+// The grid points used by the interpolation of a reachable state are reachable themselves, so the 
+// skipped states never contribute to the reproductive value of the optimized ones.
+
+void Backward::MarkReachable(double x_lo, double x_hi, double y_lo, double y_hi, int e, int a, int o, int s, int t) {
+	// Lower node of the interpolation minus the 2nd lower node for added stochasticity
+	int xi_lo = _x_grid.LowerIndex(x_lo) - 1 - (int)_prune_halo;
+	int xi_hi = _x_grid.LowerIndex(x_hi) + 2 + (int)_prune_halo;
+	int yi_lo = _y_grid.LowerIndex(y_lo) - 1 - (int)_prune_halo;
+	int yi_hi = _y_grid.LowerIndex(y_hi) + 2 + (int)_prune_halo;
+
+	xi_lo = Chop(xi_lo, 0, _x_cnt-1);
+	xi_hi = Chop(xi_hi, 0, _x_cnt-1);
+	yi_lo = Chop(yi_lo, 0, _y_cnt-1);
+	yi_hi = Chop(yi_hi, 0, _y_cnt-1);
+
+	int en = Chop(e+1,0,(_e_cnt-1));
+
+	for (int x=xi_lo;x<=xi_hi;x++) {
+		for (int y=yi_lo;y<=yi_hi;y++) {
+			if (_reachable(x,y,e, a,o,s,t) == 0)
+				_reachable(x,y,e, a,o,s,t) = 1;
+			if (_reachable(x,y,en,a,o,s,t) == 0)
+				_reachable(x,y,en,a,o,s,t) = 1;
+		}
+	}
+}
+
+
+void Backward::MarkReachableSuccessors(int x, int y, int e, int a, int o, int s, int t, char strat, double u_lo) {
+	int t_next = (t+1)%_t_cnt;
+
+	double x_lo = _x_vec[_x_cnt-1], x_hi = _x_vec[0];
+	double y_lo = _y_vec[_y_cnt-1], y_hi = _y_vec[0];
+
+	int steps = (strat=='m') ? 0 : REACH_U_STEPS;  // Migration uses no foraging
+	for (int i=0;i<=steps;i++) {
+		double u = (steps==0) ? 0 : u_lo + (1.0-u_lo) * i / steps;
+		double xn = 0, yn = 0;
+
+		switch(strat) {
+		case 'n': xn = X_nc(_x_vec[x], e, a, o, u, t);    yn = Y_ns(_x_vec[x], _y_vec[y], u, t);       break;
+		case 's': xn = X_s( _x_vec[x], e, a, o, u, t);    yn = Y_s( _x_vec[x], _y_vec[y], u, t);       break;
+		case 'c': xn = X_c( _x_vec[x], e, a, o, u, t);    yn = Y_ns(_x_vec[x], _y_vec[y], u, t);       break;
+		case 'm': xn = X_m( _x_vec[x], e, 0, o, s, u, t); yn = Y_m( _x_vec[x], _y_vec[y], e, o, s, u, t); break;
+		}
+		if (xn < x_lo) x_lo = xn;
+		if (xn > x_hi) x_hi = xn;
+		if (yn < y_lo) y_lo = yn;
+		if (yn > y_hi) y_hi = yn;
+	}
+
+	switch(strat) {
+	case 'n': MarkReachable(x_lo,x_hi,y_lo,y_hi, e,0,    o,s,t_next); break;
+	case 's': MarkReachable(x_lo,x_hi,y_lo,y_hi, e,1,    o,s,t_next); break;
+	case 'c': MarkReachable(x_lo,x_hi,y_lo,y_hi, e,a+1,  o,s,t_next); break;
+	case 'm': 
+		if (s < (int)_s_cnt-1)
+			MarkReachable(x_lo,x_hi,y_lo,y_hi, e,0,o,s+1,t_next);
+		else
+			MarkReachable(x_lo,x_hi,y_lo,y_hi, e,0,(o+1)%_o_cnt,0,t_next);
+		break;
+	}
+}
+
+
+void Backward::ComputeReachableStates() {
+
+	_reachable.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+
+	// Starting cohort of the forward simulation
+	unsigned int o_start = (_start_loc_fw > 0) ? _start_loc_fw-1 : 0;
+	MarkReachable(_x_indep,_x_indep,_y_indep,_y_indep, 0,0,o_start,0,_start_week_fw % _t_cnt);
+
+	// Mark successors until no newly reached state remains
+	bool marked = true;
+	while (marked) {
+		marked = false;
+
+		for (unsigned int t=0;t<_t_cnt;t++) {
+
+			// Newly independent young join in the same decision epoch
+			for (unsigned int x=1;x<_x_cnt;x++) {
+				for (unsigned int y=0;y<_y_cnt;y++) {
+					for (unsigned int e=0;e<_e_cnt;e++) {
+						for (unsigned int o=0;o<_o_cnt;o++) {
+							if (_reachable(x,y,e,_a_cnt-1,o,0,t) == 1) {
+								MarkReachable(_x_indep,_x_indep,_y_indep,_y_indep, 0,0,o,0,t);
+							}
+						} } } }
+
+			for (unsigned int x=1;x<_x_cnt;x++) {
+				for (unsigned int y=0;y<_y_cnt;y++) {
+					for (unsigned int e=0;e<_e_cnt;e++) {
+						for (unsigned int a=0;a<_a_cnt;a++) {
+							for (unsigned int o=0;o<_o_cnt;o++) {
+								for (unsigned int s=0;s<_s_cnt;s++) {
+
+									if (_reachable(x,y,e,a,o,s,t) != 1)
+										continue;
+
+									_reachable(x,y,e,a,o,s,t) = 2;
+									marked = true;
+
+									if (s > 0) {
+										MarkReachableSuccessors(x,y,e,a,o,s,t, 'm', 0);
+									}
+									else if (a == 0) {
+										MarkReachableSuccessors(x,y,e,a,o,s,t, 'n', 0);
+										MarkReachableSuccessors(x,y,e,a,o,s,t, 's', 0);
+										if (_enable_migration)
+											MarkReachableSuccessors(x,y,e,a,o,s,t, 'm', 0);
+									}
+									else {
+										MarkReachableSuccessors(x,y,e,a,o,s,t, 'n', 0);
+
+										double u_crit = U_crit(e, a, o, t);
+										if (a < _a_cnt-1 && u_crit <= 1)
+											MarkReachableSuccessors(x,y,e,a,o,s,t, 'c', u_crit);
+									}
+								} } } } } }
+		}
+	}
+
+	// Fill the skipped states and report their share of the grid
+	unsigned int total = 0, skipped = 0;
+	for (unsigned int t=0;t<_t_cnt;t++) {
+		for (unsigned int x=1;x<_x_cnt;x++) {
+			for (unsigned int y=0;y<_y_cnt;y++) {
+				for (unsigned int e=0;e<_e_cnt;e++) {
+					for (unsigned int a=0;a<_a_cnt;a++) {
+						for (unsigned int o=0;o<_o_cnt;o++) {
+							for (unsigned int s=0;s<_s_cnt;s++) {
+								total++;
+								if (_reachable(x,y,e,a,o,s,t) == 0) {
+									SetPruned(x,y,e,a,o,s,t);
+									skipped++;
+								}
+							} } } } } } }
+
+	printf("Reachable-state pruning: %u of %u states skipped (%.1f%%)\n", skipped, total, 100.0 * skipped / total);
+	if (_reachable(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1) == 0) {
+		printf("Note: The reference state of the backward lambda is pruned, the average lambda is reported instead\n");
+	}
+	printf("\n");
+}
+
+
+void Backward::SetPruned(int x, int y, int e, int a, int o, int s, int t) {
+	_decision->SetF_all(x,y,e,a,o,s,t, 0, 0, 'p');
+}
+
+
 //---------------------------------------
 
-void Backward::CalcLambdaAndConvergence(NArray<double> &f_old , double lambda_old, BwConvResultStruct & result) {
+void Backward::CalcLambdaAndConvergence(NArray<double> &f_old, double f_old_state, double lambda_old, BwConvResultStruct & result) {
 	double lambda_worst = 1;		// Lambda value with highest difference to optimal 1.0
 	double lambda_max_delta = 0;	// Highest deviation against optimal lambda of 1
 	double lambda_average = 0;		// Average lambda over all state combinations
@@ -482,7 +590,7 @@ void Backward::CalcLambdaAndConvergence(NArray<double> &f_old , double lambda_ol
 						for (unsigned int s=0; s<_s_cnt; s++) {
 
 							unsigned int t = 0;	
-							double oldVal = f_old(x,y,e,a,o,s,t);
+							double oldVal = f_old(x,y,e,a,o,s);
 							double newVal = _decision->GetF(x,y,e,a,o,s,t);	
 								
 							if (oldVal > 0)
@@ -519,21 +627,31 @@ void Backward::CalcLambdaAndConvergence(NArray<double> &f_old , double lambda_ol
 	result.bw_convergence = lambda_max_delta < _crit;
 
 	// For comparison (lambda calculated for particular state)
-	double oldVal     =           f_old(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+	double oldVal     =           f_old_state;
 	double newVal     = _decision->GetF(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
-	result.lambda_bw_state  = (double) newVal/oldVal;;
+	if (oldVal > 0) {
+		result.lambda_bw_state  = newVal/oldVal;
+	}
+	else {
+		// The specific state is pruned as unreachable, its lambda is replaced by the average, see ComputeReachableStates()
+		result.lambda_bw_state  = lambda_average;
+	}
 }
 
 
 void Backward::UpdateFCurrFNext(int e, int a, int o, int s, int t) {
 	int en = Chop(e+1,0,(_e_cnt-1));
 
-	for (unsigned int xi=0;xi<_x_cnt;xi++) { 
-		for (unsigned int yi=0;yi<_y_cnt;yi++) {
-			_f_curr(xi,yi) = _decision->GetF(xi,yi, e ,a,o,s,t);
-			_f_next(xi,yi) = _decision->GetF(xi,yi, en,a,o,s,t);
-		}
+	// Low-rank mode: Stoch_HMcN_LowRank() reads the factors of the decision directly
+	if (_low_rank) {
+		_decision->GetSlice(e ,a,o,s,t, _lr_curr.rank, _lr_curr.u, _lr_curr.v);
+		_decision->GetSlice(en,a,o,s,t, _lr_next.rank, _lr_next.u, _lr_next.v);
+		return;
 	}
+
+	// f(:,:,e,a,o,s,t) is a strided plane in any storage layout, the stencils read it in place
+	_f_curr = _decision->GetFPlane(e ,a,o,s,t);
+	_f_next = _decision->GetFPlane(en,a,o,s,t);
 }
 
 
@@ -582,63 +700,49 @@ void Backward::ComputeHMigrate(int res, int cond, int ex, int age, int loc, int
 
 
 
-double Backward::Compute(Settings *settings, double theta) {
-
-	if (!InitBackward(settings, theta) )
-		return 0;
+// One backward year over all decision epochs, week t_cnt-1 reads epoch 0 of the following year
+void Backward::ComputeYear() {
 
-	double lambda       = 0;
-	double lambda_old   = 0;
-	int year            = 0; 
-	int yearTotal       = _decision->GetYear();
-	bool converged      = false;
-
-	double u_opt_m=0;
-    
-    NArray<double> f_old;
-    f_old.Init(  _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt );
-        
-
-    //-----------------------------------------------
-    // ITERATION
-    
-	while ((!converged && year<_n) || year<_n_min)
-	{
-		year++;
-		yearTotal++;
-
-		// f_old NArray is filled with member-wise copy of current decision f NArray
-        f_old = _decision->GetF();  
-        
-        for (int week=(_t_cnt-1);week>=0;week--)
-        {
+    for (int week=(_t_cnt-1);week>=0;week--)
+    {
+        // The low-rank mode compresses the previous decision epoch and holds this one densely
+        _decision->SelectEpoch(week);
 
 #ifdef BW_TIMING
-            _timer_week.Clear();
-            _timer_week.Start();
+        _timer_week.Clear();
+        _timer_week.Start();
 #endif
-            
-            // set week t_cnt = week0; note that definition is different from R and Matlab here because index starts at 0
-            int week_next = (week+1)%_t_cnt;
-            
-            // Calculate best strategy for age < age_max
-            
-            for (unsigned int res=1;res<_x_cnt;res++) 
-			{
-                // for (unsigned int cond=1;cond<_y_cnt;cond++)   // original
-				for (unsigned int cond=0;cond<_y_cnt;cond++)
-				{   
-					for (_loc_idx=0;_loc_idx<_o_cnt;_loc_idx++) 
-					{						
-						for (unsigned int ex=0;ex<_e_cnt;ex++) 
-						{              
-
-							BwOptResultStruct opt_nocare, opt_start, opt_migrate;
-
+        
+        // set week t_cnt = week0; note that definition is different from R and Matlab here because index starts at 0
+        int week_next = (week+1)%_t_cnt;
+        
+        // Calculate best strategy for age < age_max
+        
+        for (unsigned int res=1;res<_x_cnt;res++) 
+		{
+            // for (unsigned int cond=1;cond<_y_cnt;cond++)   // original
+			for (unsigned int cond=0;cond<_y_cnt;cond++)
+			{   
+				for (_loc_idx=0;_loc_idx<_o_cnt;_loc_idx++) 
+				{						
+					for (unsigned int ex=0;ex<_e_cnt;ex++) 
+					{              
+
+						BwOptResultStruct opt_nocare, opt_start, opt_migrate;
+
+						// Reachable-state pruning: 'no care' is needed by all states with a=0, s=0 and by the brood states
+						bool reach_nocare = IsReachable(res,cond,ex,0,_loc_idx,0,week);
+						bool reach_brood  = false;
+						for (unsigned int age=1;age<(_a_cnt-1) && !reach_brood;age++) 
+							reach_brood = IsReachable(res,cond,ex,age,_loc_idx,0,week);
+
+						if (reach_nocare || reach_brood) {
 							// no care
 							UpdateFCurrFNext(ex,0,_loc_idx,0,week_next);				          // UpdateFCurrFNext(e,a,o,s,t) -> f of state at t+1 when 'nocare' is performed			
 							ComputeHNoCare(res,cond, ex, 0, _loc_idx, 0, week, opt_nocare);       // -> u_opt_nc, H_nocare
+						}
 
+						if (reach_nocare) {
 							// start brood
 							UpdateFCurrFNext(ex,1,_loc_idx,0,week_next);                          // UpdateFCurrFNext(e,a,o,s,t) -> f of state at t+1 when 'start' is performed
 							ComputeHStart(res,cond, ex, 0, _loc_idx, 0, week, opt_start);         // -> u_opt_s, H_start
@@ -652,7 +756,7 @@ double Backward::Compute(Settings *settings, double theta) {
 							}
 							ComputeHMigrate(res,cond, ex, 0, _loc_idx, 0, week, opt_migrate);     // -> u_opt_m, H_migrate
 
-							
+						
 							// extract best strategy and corresponding f and u
 							BwOptResultStruct *opt_best = &opt_nocare;
 
@@ -662,96 +766,155 @@ double Backward::Compute(Settings *settings, double theta) {
 								opt_best = &opt_start;
 
 							_decision->SetF_all(res,cond,ex,0,_loc_idx,0,week,  opt_best->H, opt_best->u,opt_best->s);
+						}
+						else {
+							SetPruned(res,cond,ex,0,_loc_idx,0,week);
+						}
 
 
-							// Migration longer than one decision epoch
-							if (_migr_dur > 1) {
-							
-								// loop over duration of migration (except final week of migration)
-								for (int dur=1; dur<_migr_dur-1; dur++) { 
-									UpdateFCurrFNext(ex,0,_loc_idx,dur+1,week_next);
-									ComputeHMigrate(    res,cond,ex,0,_loc_idx,dur,week, opt_migrate);									
-									_decision->SetF_all(res,cond,ex,0,_loc_idx,dur,week, opt_migrate.H,opt_migrate.u,opt_migrate.s); 
+						// Migration longer than one decision epoch
+						if (_migr_dur > 1) {
+						
+							// loop over duration of migration (except final week of migration)
+							for (int dur=1; dur<_migr_dur-1; dur++) { 
+								if (!IsReachable(res,cond,ex,0,_loc_idx,dur,week)) {
+									SetPruned(res,cond,ex,0,_loc_idx,dur,week);
+									continue;
 								}
+								UpdateFCurrFNext(ex,0,_loc_idx,dur+1,week_next);
+								ComputeHMigrate(    res,cond,ex,0,_loc_idx,dur,week, opt_migrate);									
+								_decision->SetF_all(res,cond,ex,0,_loc_idx,dur,week, opt_migrate.H,opt_migrate.u,opt_migrate.s); 
+							}
 
-								// last week of migration							
+							// last week of migration							
+							if (IsReachable(res,cond,ex,0,_loc_idx,_s_cnt-1,week)) {
 								UpdateFCurrFNext(ex,0,(_loc_idx+1)%_o_cnt,0,week_next);								
 								ComputeHMigrate(    res,cond,ex,0,_loc_idx,_s_cnt-1,week,  opt_migrate);							
 								_decision->SetF_all(res,cond,ex,0,_loc_idx,_s_cnt-1,week,  opt_migrate.H,opt_migrate.u,opt_migrate.s); 
 							}
+							else {
+								SetPruned(res,cond,ex,0,_loc_idx,_s_cnt-1,week);
+							}
+						}
 
-							// loop over brood
-							for (unsigned int age=1;age<(_a_cnt-1);age++) 
+						// loop over brood
+						for (unsigned int age=1;age<(_a_cnt-1);age++) 
+						{
+							if (!IsReachable(res,cond,ex,age,_loc_idx,0,week)) {
+								SetPruned(res,cond,ex,age,_loc_idx,0,week);
+							}
+							// if u_crit > 1, forced to abandon brood
+							else if (U_crit(ex, age, _loc_idx, week) > 1) {
+								_decision->SetF_all(res,cond,ex,age,_loc_idx,0,week, opt_nocare.H,opt_nocare.u,opt_nocare.s); 
+							}
+							else  // else care for brood
 							{
-								// if u_crit > 1, forced to abandon brood
-								if (U_crit(ex, age, _loc_idx, week) > 1) {
-									_decision->SetF_all(res,cond,ex,age,_loc_idx,0,week, opt_nocare.H,opt_nocare.u,opt_nocare.s); 
-								}
-								else  // else care for brood
-								{
-									BwOptResultStruct opt_care;
-
-									UpdateFCurrFNext(ex,age+1,_loc_idx,0,week_next);    
-									ComputeHCare(res,cond, ex, age, _loc_idx, 0, week, opt_care);
-
-									// Decide if care or no care
-									BwOptResultStruct *opt_best = &opt_nocare;
-									if (opt_care.H >= opt_nocare.H && fabs(opt_care.H)>=CALC_EPS)
-										opt_best = &opt_care;
-									_decision->SetF_all(res,cond,ex,age,_loc_idx,0,week,   opt_best->H,opt_best->u,opt_best->s);
-                                
-								} //end care for brood
-                            
-							} // end loop over brood
-                        
-						} // end loop over experience 'ex' for age < age_max
-					} // end loop over locations '_loc_idx' for age < age_max
-                } // end loop over condition 'cond' for age < age_max
-            } // end loop over reserves 'res' for age < age_max
-            
-            
-            // Calculate best strategy for age = age_max            
-            for (unsigned int res=1;res<_x_cnt;res++) {
-                // for (unsigned int cond=1;cond<_y_cnt;cond++) {  // original
-				for (unsigned int cond=0;cond<_y_cnt;cond++) {
-					for (unsigned int _loc_idx=0;_loc_idx<_o_cnt;_loc_idx++) {
-						for (unsigned int ex=0;ex<_e_cnt;ex++) {
-                        
-							BwOptResultStruct opt_nocare;
+								BwOptResultStruct opt_care;
 
-							// no care							
-							UpdateFCurrFNext(ex,0,_loc_idx,0,week_next); 
-							ComputeHNoCare(res,cond, ex, 0, _loc_idx, 0, week, opt_nocare);
-                        
-							// brood becomes independent							
-							UpdateFCurrFNext(0   ,0,_loc_idx,0,week);
+								UpdateFCurrFNext(ex,age+1,_loc_idx,0,week_next);    
+								ComputeHCare(res,cond, ex, age, _loc_idx, 0, week, opt_care);
 
-							
-							BwStochResultStruct stoch;
-							Stoch_HMcN(_x_indep, _y_indep, stoch);
+								// Decide if care or no care
+								BwOptResultStruct *opt_best = &opt_nocare;
+								if (opt_care.H >= opt_nocare.H && fabs(opt_care.H)>=CALC_EPS)
+									opt_best = &opt_care;
+								_decision->SetF_all(res,cond,ex,age,_loc_idx,0,week,   opt_best->H,opt_best->u,opt_best->s);
+                            
+							} //end care for brood
                         
-							double fVal = opt_nocare.H + _n_brood * stoch.curr_approx;
-
-							_decision->SetF_all(res,cond,ex,(_a_cnt-1),_loc_idx,0,week,   fVal,opt_nocare.u, opt_nocare.s); 
-						} // end loop over  'ex'       for a=a_max
-					} // end loop over  '_loc_idx' for a=a_max
-                } // end loop over  'cond'     for a=a_max
-            } // end loop over  'res'      for a=a_max
-            
+						} // end loop over brood
+                    
+					} // end loop over experience 'ex' for age < age_max
+				} // end loop over locations '_loc_idx' for age < age_max
+            } // end loop over condition 'cond' for age < age_max
+        } // end loop over reserves 'res' for age < age_max
+        
+        
+        // Calculate best strategy for age = age_max            
+        for (unsigned int res=1;res<_x_cnt;res++) {
+            // for (unsigned int cond=1;cond<_y_cnt;cond++) {  // original
+			for (unsigned int cond=0;cond<_y_cnt;cond++) {
+				for (unsigned int _loc_idx=0;_loc_idx<_o_cnt;_loc_idx++) {
+					for (unsigned int ex=0;ex<_e_cnt;ex++) {
+                    
+						if (!IsReachable(res,cond,ex,(_a_cnt-1),_loc_idx,0,week)) {
+							SetPruned(res,cond,ex,(_a_cnt-1),_loc_idx,0,week);
+							continue;
+						}
+
+						BwOptResultStruct opt_nocare;
+
+						// no care							
+						UpdateFCurrFNext(ex,0,_loc_idx,0,week_next); 
+						ComputeHNoCare(res,cond, ex, 0, _loc_idx, 0, week, opt_nocare);
+                    
+						// brood becomes independent							
+						UpdateFCurrFNext(0   ,0,_loc_idx,0,week);
+
+						
+						BwStochResultStruct stoch;
+						Stoch_HMcN(_x_indep, _y_indep, stoch);
+                    
+						double fVal = opt_nocare.H + _n_brood * stoch.curr_approx;
+
+						_decision->SetF_all(res,cond,ex,(_a_cnt-1),_loc_idx,0,week,   fVal,opt_nocare.u, opt_nocare.s); 
+					} // end loop over  'ex'       for a=a_max
+				} // end loop over  '_loc_idx' for a=a_max
+            } // end loop over  'cond'     for a=a_max
+        } // end loop over  'res'      for a=a_max
+        
 #ifdef BW_TIMING
-            printf("====================== Backward Cycle %d / Decision epoch %d ===========\n",yearTotal, week);
+        printf("====================== Backward Cycle %d / Decision epoch %d ===========\n",_decision->GetYear()+1, week);
 
-            _timer_week.Stop();
-            printf("Decision epochs total %12.2f ns\n",_timer_week.GetNanoSeconds() );
+        _timer_week.Stop();
+        printf("Decision epochs total %12.2f ns\n",_timer_week.GetNanoSeconds() );
 #endif
 
-        } // end loop over weeks
+    } // end loop over weeks
+}
+
+
+double Backward::Compute(Settings *settings, double theta) {
+
+	if (!InitBackward(settings, theta) )
+		return 0;
+
+	if (_prune_states)
+		ComputeReachableStates();
+
+	double lambda       = 0;
+	double lambda_old   = 0;
+	int year            = 0; 
+	int yearTotal       = _decision->GetYear();
+	bool converged      = false;
+
+	double u_opt_m=0;
+    
+    // Lambda compares decision epoch 0 and one specific state with the previous year
+    NArray<double> f_old;
+    f_old.Init(  _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt );
+    double f_old_state = 0;
+        
+
+    //-----------------------------------------------
+    // ITERATION
+    
+	while ((!converged && year<_n) || year<_n_min)
+	{
+		year++;
+		yearTotal++;
+
+		// f_old NArray is filled with a copy of decision epoch 0 of the current decision f
+        _decision->GetEpochF(0, f_old);
+        f_old_state = _decision->GetF(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+        
+        ComputeYear();
         
         
         // calculate lambda
 		BwConvResultStruct conv;
 
-		CalcLambdaAndConvergence(f_old, lambda_old, conv);
+		CalcLambdaAndConvergence(f_old, f_old_state, lambda_old, conv);
 
 		lambda     = conv.lambda_bw_state;   		
 		converged  = conv.bw_convergence;
@@ -761,6 +924,11 @@ double Backward::Compute(Settings *settings, double theta) {
 		printf("=========== Backward iteration %2d  done ===========\n",yearTotal);	 
 		printf("........... Lambda:  average = %f   specific state = %f\n",conv.lambda_bw_average,conv.lambda_bw_state);
 		printf("........... Lambda:  worst   = %f   not converged %d of %d \n", conv.lambda_bw_worst,conv.bw_notconv_count,conv.bw_state_count );
+		if (_low_rank) {
+			double rank_avg, err_max;
+			_decision->GetLowRankStatistics(rank_avg, err_max);
+			printf("........... Low-rank f:  average rank = %.2f of %u   largest relative error = %g\n", rank_avg, _lr_stride, err_max);
+		}
 		printf("\n");
 
 		_decision->SetYear(yearTotal);
@@ -777,3 +945,220 @@ double Backward::Compute(Settings *settings, double theta) {
     _decision->SetLambda(lambda);
     return lambda;
 }
+
+
+//---------------------------------------
+// Non-stationary horizon
+//
+// The food supply series holds FoodSupplyYears consecutive years. The stationary solution for the 
+// final year serves as terminal condition, then each year of the series is computed once from the
+// last to the first one. Only one year of the decision is held in memory, the policy of each year
+// is written to its own file and read back by the forward run.
+
+double Backward::ComputeHorizon(Settings *settings, double theta) {
+
+	unsigned int years = settings->GetEnvYears();
+
+	// Terminal condition: Compute() uses the environment of the final year
+	printf("=========== Backward horizon: terminal condition of year %d ===========\n\n",years-1);
+	double lambda = Compute(settings, theta);
+	if (!_decision->IsInitialized() )
+		return 0;
+
+	int yearTotal = _decision->GetYear();
+
+	NArray<double> f_old;
+	f_old.Init(  _x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt );
+
+	for (int year=(int)years-1;year>=0;year--) {
+		yearTotal++;
+
+		_decision->GetEpochF(0, f_old);
+		double f_old_state = _decision->GetF(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+
+		SetEnvYear(year);
+		ComputeYear();
+
+		// Lambda is the growth of the reproductive values over this year of the series
+		BwConvResultStruct conv;
+		CalcLambdaAndConvergence(f_old, f_old_state, lambda, conv);
+		lambda = conv.lambda_bw_state;
+
+		char filename[FILENAME_MAX];
+		sprintf_s(filename, DC_HORIZON_POLICY_FILE, settings->GetFilePrefix(), year);
+		if (!_decision->SavePolicyToFile(filename) )
+			return 0;
+
+		printf("=========== Backward horizon year %2d  done ===========\n",year);
+		printf("........... Lambda:  average = %f   specific state = %f\n",conv.lambda_bw_average,conv.lambda_bw_state);
+		printf("........... Policy saved to '%s'\n\n",filename);
+
+		_decision->SetYear(yearTotal);
+		_decision->SetLambda(conv.lambda_bw_average);
+		_decision->SetLambdaState(conv.lambda_bw_state);
+		_decision->SetLambdaWorst(conv.lambda_bw_worst);
+	}
+
+	_decision->SetLambda(lambda);
+	return lambda;
+}
+
+
+//---------------------------------------
+// Eigenvalue perturbation of lambda
+//
+// At convergence the reproductive values f of the decision are the left and the forward state
+// distribution w is the right eigenvector of the annual projection. With the weekly projections A_t
+// the derivative of lambda with respect to a parameter p is
+//
+//     d lambda / d p  =  lambda * sum_t  < f_t+1, dA_t/dp w_t >  /  < f_t+1, A_t w_t >
+//
+// Each term is independent of the scaling of f and w, so the reproductive values of the final 
+// backward year and the state distribution of the final forward year can be used directly.
+// Since the strategy is optimal, dA_t/dp is evaluated with the stored behavioral decision kept fixed.
+// The foraging intensity is re-optimized, because its optimum often sticks to a kink of the grid 
+// interpolation and then moves with the parameter.
+
+void Backward::ComputePolicyPayoff(NArray<double> &fw_props, NArray<double> &payoff) {
+
+	const char strategies[4] = { 'n', 's', 'c', 'm' };
+
+	payoff.Init(_t_cnt, 2);
+
+	for (unsigned int week=0;week<_t_cnt;week++) {
+		int    week_next  = (week+1)%_t_cnt;
+		double transition = 0;
+		double brood      = 0;
+
+		for (unsigned int e=0;e<_e_cnt;e++) {
+			for (unsigned int a=0;a<_a_cnt;a++) {
+				for (_loc_idx=0;_loc_idx<_o_cnt;_loc_idx++) {
+					unsigned int o = _loc_idx;
+					for (unsigned int s=0;s<_s_cnt;s++) {
+
+						// One pass per strategy, so the f values of the target state are only loaded once
+						for (int k=0;k<4;k++) {
+							char strat  = strategies[k];
+							bool loaded = false;
+
+							for (unsigned int res=1;res<_x_cnt;res++) {
+								for (unsigned int cond=0;cond<_y_cnt;cond++) {
+									double w = fw_props(res,cond,e,a,o,s,week);
+									if (w <= 0.0 || _decision->GetF_strat(res,cond,e,a,o,s,week) != strat)
+										continue;
+
+									if (!loaded) {
+										switch(strat) {
+										case 'n': UpdateFCurrFNext(e,0  ,o,s,week_next); break;
+										case 's': UpdateFCurrFNext(e,1  ,o,s,week_next); break;
+										case 'c': UpdateFCurrFNext(e,a+1,o,s,week_next); break;
+										case 'm': 
+											if (s < (_s_cnt-1))
+												UpdateFCurrFNext(e,0,o,s+1,week_next);
+											else
+												UpdateFCurrFNext(e,0,(o+1)%_o_cnt,0,week_next);
+											break;
+										}
+										loaded = true;
+									}
+
+									BwOptResultStruct opt;
+									switch(strat) {
+									case 'n': ComputeHNoCare( res,cond,e,a,o,s,week,opt); break;
+									case 's': ComputeHStart(  res,cond,e,a,o,s,week,opt); break;
+									case 'c': ComputeHCare(   res,cond,e,a,o,s,week,opt); break;
+									case 'm': ComputeHMigrate(res,cond,e,0,o,s,week,opt); break;
+									}
+									transition += w * opt.H;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		// Young becoming independent within the same decision epoch
+		for (unsigned int o=0;o<_o_cnt;o++) {
+			double w = 0;
+			for (unsigned int res=1;res<_x_cnt;res++) {
+				for (unsigned int cond=0;cond<_y_cnt;cond++) {
+					for (unsigned int e=0;e<_e_cnt;e++) {
+						w += fw_props(res,cond,e,_a_cnt-1,o,0,week);
+					}
+				}
+			}
+
+			if (w > 0.0) {
+				UpdateFCurrFNext(0,0,o,0,week);
+
+				BwStochResultStruct stoch;
+				Stoch_HMcN(_x_indep, _y_indep, stoch);
+
+				brood += w * _n_brood * stoch.curr_approx;
+			}
+		}
+
+		payoff(week,0) = transition;
+		payoff(week,1) = brood;
+	}
+}
+
+
+double Backward::ComputeSensitivity(Settings *settings, NArray<double> &fw_props, int idx) {
+
+	if (!_decision || !_decision->IsInitialized() ) {
+		printf("Backward::ComputeSensitivity() ERROR: 'decision' not initialized\n");
+		return 0;
+	}
+
+	if (fw_props.GetDims() != 7) {
+		printf("Backward::ComputeSensitivity() ERROR: forward state distribution does not match the decision\n");
+		return 0;
+	}
+	for (unsigned int d=0;d<7;d++) {
+		if (fw_props.GetDim(d) != _decision->GetDim(d) ) {
+			printf("Backward::ComputeSensitivity() ERROR: forward state distribution does not match the decision\n");
+			return 0;
+		}
+	}
+
+	double theta = _decision->GetTheta();
+	double value = (idx < 0) ? theta : settings->GetSensitivityParam(idx);
+
+	// Central difference of the fixed-strategy payoff, the step is relative to the parameter value
+	double step  = SENS_REL_STEP * ( (fabs(value) > SENS_MIN_VALUE) ? fabs(value) : SENS_MIN_VALUE );
+
+	NArray<double> payoff, payoff_plus, payoff_minus;
+
+	if (idx < 0) {
+		InitParameters(settings, value + step);
+		ComputePolicyPayoff(fw_props, payoff_plus);
+		InitParameters(settings, value - step);
+		ComputePolicyPayoff(fw_props, payoff_minus);
+	}
+	else {
+		settings->SetSensitivityParam(idx, value + step);
+		InitParameters(settings, theta);
+		ComputePolicyPayoff(fw_props, payoff_plus);
+		settings->SetSensitivityParam(idx, value - step);
+		InitParameters(settings, theta);
+		ComputePolicyPayoff(fw_props, payoff_minus);
+		settings->SetSensitivityParam(idx, value);
+	}
+	InitParameters(settings, theta);
+	ComputePolicyPayoff(fw_props, payoff);
+
+	double sum = 0;
+	for (unsigned int week=0;week<_t_cnt;week++) {
+		// The week projects w_t with the brood added onto v_{t+1}, so v_{t+1}' M_t w_t is the payoff of the 
+		// transitions alone. The brood valued at week t only enters the derivative of the numerator.
+		double projected = payoff(week,0);
+		if (projected > 0.0) {
+			double dpayoff = (payoff_plus(week,0) + payoff_plus(week,1) - payoff_minus(week,0) - payoff_minus(week,1)) / (2.0*step);
+			sum += dpayoff / projected;
+		}
+	}
+
+	return _decision->GetLambda() * sum;
+}
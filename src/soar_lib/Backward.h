@@ -32,6 +32,8 @@
 
 #include "..\soar_support_lib\Nanotimer.h"
 #include "..\soar_support_lib\NArray.h"
+#include "..\soar_support_lib\GridAxis.h"
+#include "..\soar_support_lib\GridStencil.h"
 
 #include "StateFuncs.h"
 #include "Optimizer.h"
@@ -71,12 +73,8 @@ private:
 
     int				_a_max;       ///< Age of independance
 
-	double			 _min_x;		///< Reserves min 
-	double			 _min_y;		///< Health min
-    double			 _dx;			///< Reserved delta step in x
-    double			 _dy;			///< Health delta step in y
-	double			 _inverse_dx;   ///< 1.0/_dx, used for optimization since multiplication is faster than division
-	double			 _inverse_dy;	///< 1.0/_dy, used for optimization since multiplication is faster than division
+	GridAxis		 _x_grid;		///< Reserves grid nodes with lookup of the lower node
+	GridAxis		 _y_grid;		///< Health grid nodes with lookup of the lower node
     unsigned int	 _x_cnt;		///< Number of reserves grid points in x
     unsigned int	 _y_cnt;		///< Number of health grid points in y
     double			 _stochfac_x;	///< Degree of potentially added stochasticity retrieved from Settings
@@ -87,6 +85,15 @@ private:
     double			_p_exp;       ///< Probability of growth of experience per decision epoch
 
 	int				_migr_dur;    ///< Duration of migration
+	bool			_enable_migration; ///< Migration option enabled
+
+	bool			_prune_states;   ///< Restrict the optimization to states reachable from the forward starting cohort
+	unsigned int	_prune_halo;     ///< Number of grid points added around the reachable reserves and health
+	unsigned int	_start_week_fw;  ///< Start epoch of the forward starting cohort
+	unsigned int	_start_loc_fw;   ///< Start location of the forward starting cohort (1 based)
+
+	bool			_stoch_add_x;    ///< Additional stochasticity for reserves
+	bool			_stoch_add_y;    ///< Additional stochasticity for health
 	///@} End of group started by \name
         
 
@@ -97,8 +104,25 @@ private:
 	NArray<double>	_x_vec;		 ///< Read only array containing the x value from x_min to x_max for each gridstep
 	NArray<double>	_y_vec;		 ///< Read only array containing the y value from y_min to y_max for each gridstep
 
-	NArray<double>	 _f_curr;	///< 2D Array for current value
-	NArray<double>   _f_next;	///< 2D Array for current value
+	NArray<char>	 _reachable; ///< Reachability of the states: 0 unreachable, 1 reachable, 2 reachable and successors marked
+
+	NArrayView<double> _f_curr;	///< 2D view of the decision, f at the current experience
+	NArrayView<double> _f_next;	///< 2D view of the decision, f at the next experience
+
+	/**
+	 * \ingroup SoarLib
+	 * \brief Reserves-health slice of f stored by the decision in low-rank mode, see Decision::GetSlice()
+	 */
+	struct BwSliceStruct {
+		int     rank;			///< Rank of the factors, -1 for a dense slice
+		double *u;				///< Reserves factors or the dense slice
+		double *v;				///< Health factors
+	};
+
+	bool			 _low_rank;	///< The decision stores f as low-rank factors
+	unsigned int	 _lr_stride; ///< Distance of the factors of consecutive grid points
+	BwSliceStruct	 _lr_curr;	///< Low-rank counterpart of _f_curr
+	BwSliceStruct	 _lr_next;	///< Low-rank counterpart of _f_next
 
 #ifdef BW_TIMING
     NanoTimer _timer_week;		///< Timer to time the calculations for one simulated week	
@@ -155,6 +179,27 @@ private:
 	   */
 	void Stoch_HMcN_AddStochResHealth(double x_case, double y_case, BwStochResultStruct &result);
 
+	  /**
+	   * Computes the interpolation of any of the above variants directly from the low-rank factors
+	   * of the decision: sum_k (sum_i p_i u_k(x_i)) (sum_j p_j v_k(y_j))
+	   * @param x_case  Input in x dimension
+	   * @param y_case  Input in y dimension
+	   * @param result  Output structure containing stochasticity approximations
+	   */
+	void Stoch_HMcN_LowRank(double x_case, double y_case, BwStochResultStruct &result);
+
+	/// \brief Interpolates f_curr and f_next with a separable stencil of WX reserves and WY health nodes
+	template <int WX, int WY>
+	void Stoch_HMcN_Stencil(double x_case, double y_case, BwStochResultStruct &result)
+	{
+		GridStencil<WX,WY> stencil(_x_grid, _y_grid, x_case, y_case, _stochfac_x);
+		result.curr_approx = stencil.Apply(_f_curr.GetData(), _f_curr.GetStride(0), _f_curr.GetStride(1));
+		result.next_approx = stencil.Apply(_f_next.GetData(), _f_next.GetStride(0), _f_next.GetStride(1));
+	}
+
+	/// \brief Computes the weighted sum of the slice over the grid points xi[0..nx-1] times yi[0..ny-1]
+	double InterpolateSlice(BwSliceStruct &slice, int nx, int *xi, double *px, int ny, int *yi, double *py);
+
 	  /**
 	   * Calls the active variant for linear interpolation between grid points (Inline function)
 	   * @param x_case  Input in x dimension
@@ -177,6 +222,9 @@ private:
    
 	void UpdateFCurrFNext(int e, int a, int o, int s, int t);
 
+	/// \brief Computes one backward year, from decision epoch t_cnt-1 down to 0
+	void ComputeYear();
+
 	/**
 	 * \ingroup SoarLib
 	 * \brief Result structure for the CalcLambdaAndConvergence() function
@@ -190,7 +238,14 @@ private:
 		bool   bw_convergence;	   ///< Indicator of convergence
     };
 
-	void CalcLambdaAndConvergence(NArray<double> &f_old ,double lambda_old, BwConvResultStruct & result);
+	  /**
+	   * Computes lambda from the reproductive values of the current and the previous year
+	   * @param f_old        f of decision epoch 0 of the previous year [x][y][e][a][o][s]
+	   * @param f_old_state  f of the specific state of the previous year
+	   * @param lambda_old   Lambda of the previous year
+	   * @param result       Output structure
+	   */
+	void CalcLambdaAndConvergence(NArray<double> &f_old, double f_old_state, double lambda_old, BwConvResultStruct & result);
 
 
 	/**
@@ -234,7 +289,66 @@ private:
 	void ComputeHCare(   int res, int cond, int ex, int age, int loc, int s, int week,BwOptResultStruct &result); 
 	void ComputeHMigrate(int res, int cond, int ex, int age, int loc, int s, int week,BwOptResultStruct &result); 
 	
+	void InitParameters(Settings *set, double theta);
 	bool InitBackward(Settings *set, double theta);
+
+	  /**
+	   * Initializes f of the decision from an earlier backward result. If the grid sizes, the maximal
+	   * experience or the age of independence differ, f is remapped onto the current dimensions.
+	   * @param filename    Decision file of the earlier run
+	   * @param incubation  Duration of incubation, the age states up to it are taken unchanged
+	   * \return True if successful, else loading error or incompatible dimensions
+	   */
+	bool InitFromWarmStartFile(char *filename, unsigned int incubation);
+
+
+	/// \name Reachable-state pruning
+	/// @{ 
+	  /**
+	   * Marks all states the forward starting cohort can reach under any strategy and foraging intensity.
+	   * The reserves and health reached are widened by the stochasticity and the halo.
+	   */
+	void ComputeReachableStates();
+
+	  /**
+	   * Marks the grid points covering the reserves [x_lo,x_hi] and health [y_lo,y_hi] as reachable 
+	   * for the experience e and its increase.
+	   */
+	void MarkReachable(double x_lo, double x_hi, double y_lo, double y_hi, int e, int a, int o, int s, int t);
+
+	/// \brief Marks the successors of a reachable state for one strategy, sampling u in [u_lo,1]
+	void MarkReachableSuccessors(int x, int y, int e, int a, int o, int s, int t, char strat, double u_lo);
+
+	/// \brief Returns TRUE if the state needs to be optimized (Inline function)
+	bool IsReachable(int x, int y, int e, int a, int o, int s, int t) {
+		return !_prune_states || _reachable(x,y,e,a,o,s,t) != 0;
+	}
+
+	/// \brief Sets the fill value of a skipped state: f=0, u=0 and the behavioral decision 'p' (pruned)
+	void SetPruned(int x, int y, int e, int a, int o, int s, int t);
+	///@} End of group started by \name
+
+
+	/// \name Eigenvalue perturbation of lambda
+	/// @{ 
+	  /**
+	   * Computes for each decision epoch the payoff of the population given by the forward
+	   * state distribution when following the fixed strategy stored in the decision.
+	   * @param fw_props  Forward state distribution (same dimensions as the decision)
+	   * @param payoff    Output array [epoch][0]: payoff of the state transitions,  [epoch][1]: payoff of the young becoming independent
+	   */
+	void ComputePolicyPayoff(NArray<double> &fw_props, NArray<double> &payoff);
+
+	  /**
+	   * Computes the derivative of lambda with respect to a parameter from the reproductive values
+	   * of the decision and the forward state distribution (eigenvalue perturbation).
+	   * @param set       Settings used for the backward and forward run
+	   * @param fw_props  Forward state distribution (same dimensions as the decision)
+	   * @param idx       Index of the sensitivity parameter in Settings or -1 for theta
+	   * \return d lambda / d parameter
+	   */
+	double ComputeSensitivity(Settings *set, NArray<double> &fw_props, int idx);
+	///@} End of group started by \name
 public:
     Backward();
     ~Backward();
@@ -244,6 +358,17 @@ public:
     // Compute() returns the lambda
     double Compute(Settings *set, double theta);
 
+	/**
+	 * Computes each year of a multi-year food supply series once, starting from the stationary
+	 * solution of the final year, and saves the policy of year y to DC_HORIZON_POLICY_FILE.
+	 * \return Lambda of the first year of the series
+	 */
+	double ComputeHorizon(Settings *set, double theta);
+
+	// Sensitivity of lambda with respect to theta or the scalar parameters of Settings (requires a converged decision)
+	double ComputeThetaSensitivity(Settings *set, NArray<double> &fw_props) { return ComputeSensitivity(set, fw_props, -1); }
+	double ComputeParamSensitivity(Settings *set, NArray<double> &fw_props, unsigned int idx) { return ComputeSensitivity(set, fw_props, (int)idx); }
+
 	// payoff functions - Called via optimizer
     double H_nc (double x, double y, int e, int a, int o, int s, int t, double u);
     double H_s (double x, double y, int e, int a, int o, int s, int t, double u);
@@ -25,10 +25,98 @@
 */
 
 #include <stdio.h>
+#include <math.h>
 #include "Decision.h"
+#include "..\soar_support_lib\NanoTimer.h"
 
 #pragma warning ( disable: 4996) // warning C4996: 'fopen': This function or variable may be unsafe.
 
+/// Dimension of [x][y][e][a][o][s][t] stored at each position of the state arrays, for each layout
+static const unsigned int dcLayoutOrder[DC_LAYOUT_CNT][7] = {
+	{ 0,1,2,3,4,5,6 },		// separate
+	{ 0,1,2,3,4,5,6 },		// record, behind the f,f_u dimension
+	{ 2,0,1,3,4,5,6 },		// experience pair
+	{ 1,0,2,3,4,5,6 }		// health first
+};
+
+/**
+ * \brief Returns the view [x][y][e][a][o][s][t] of a state array stored in the order of a layout
+ * \param arr     The state array
+ * \param order   Dimension stored at each position, see dcLayoutOrder
+ * \param first   Number of leading record dimensions of arr, 0 or 1
+ * \param record  Index within the leading record dimension
+ */
+template<class T> static NArrayView<T> DcLayoutView(const NArray<T> &arr, const unsigned int *order, unsigned int first, unsigned int record)
+{
+	NArrayView<T> stored = arr.View();
+	if (stored.GetDims()==0)
+		return stored;
+
+	unsigned int  dims[7];
+	size_t        strides[7];
+	for (unsigned int i=0;i<7;i++) {
+		dims[order[i]]    = stored.GetDim(first+i);
+		strides[order[i]] = stored.GetStride(first+i);
+	}
+	return NArrayView<T>(stored.GetData() + record*stored.GetStride(0), 7, dims, strides);
+}
+
+/// \brief Backward pattern of BenchmarkLayouts(): reads the planes of f at e and e+1 of the next epoch and writes all values of each state
+static double DcBenchmarkBackward(Decision &dc)
+{
+	int xDim = dc.GetDim(0), yDim = dc.GetDim(1), eDim = dc.GetDim(2), aDim = dc.GetDim(3);
+	int oDim = dc.GetDim(4), sDim = dc.GetDim(5), tDim = dc.GetDim(6);
+
+	double sum = 0;
+	for (int t=tDim-1;t>=0;t--) {
+		int t_next = (t+1)%tDim;
+		for (int x=1;x<xDim;x++) {
+			for (int y=0;y<yDim;y++) {
+				for (int o=0;o<oDim;o++) {
+					for (int e=0;e<eDim;e++) {
+						int en = (e+1<eDim) ? e+1 : e;
+						int y0 = (y>0) ? y-1 : 0;
+						NArrayView<double> curr = dc.GetFPlane(e ,0,o,0,t_next);
+						NArrayView<double> next = dc.GetFPlane(en,0,o,0,t_next);
+
+						double f = 0.25*(curr(x-1,y0) + curr(x,y0) + curr(x-1,y) + curr(x,y))
+						         + 0.25*(next(x-1,y0) + next(x,y0) + next(x-1,y) + next(x,y));
+						for (int a=0;a<aDim;a++)
+							for (int s=0;s<sDim;s++)
+								dc.SetF_all(x,y,e,a,o,s,t, f, 0.5, 'n');
+						sum += f;
+					} } } } }
+	return sum;
+}
+
+/// \brief Forward pattern of BenchmarkLayouts(): reads f_u and f_strat in the order of the states
+static double DcBenchmarkForward(Decision &dc)
+{
+	int xDim = dc.GetDim(0), yDim = dc.GetDim(1), eDim = dc.GetDim(2), aDim = dc.GetDim(3);
+	int oDim = dc.GetDim(4), sDim = dc.GetDim(5), tDim = dc.GetDim(6);
+
+	double sum = 0;
+	for (int t=0;t<tDim;t++) {
+		for (int s=0;s<sDim;s++) {
+			for (int o=0;o<oDim;o++) {
+				for (int a=0;a<aDim;a++) {
+					for (int e=0;e<eDim;e++) {
+						for (int y=0;y<yDim;y++) {
+							for (int x=1;x<xDim;x++) {
+								if (dc.GetF_strat(x,y,e,a,o,s,t) != 'm')
+									sum += dc.GetF_u(x,y,e,a,o,s,t);
+							} } } } } } }
+	return sum;
+}
+
+/// \brief Writes a view [x][y][e][a][o][s][t] in the binary format of NArray::SaveBinary(), the file format does not depend on the layout
+template<class T> static bool DcSaveViewBinary(const NArrayView<T> &view, FILE *file)
+{
+	NArray<T> arr(view.GetDim(0),view.GetDim(1),view.GetDim(2),view.GetDim(3),view.GetDim(4),view.GetDim(5),view.GetDim(6));
+	arr.View().CopyFrom(view);
+	return arr.SaveBinary(file);
+}
+
 Decision::Decision() {
 	Reset();
 }
@@ -43,6 +131,95 @@ void Decision::Reset() {
 	_bw_not_converged = 0;
 	_bw_state_count   = 0;
 	_year             = 0;
+	_grid_x_ratio     = 1.0;
+	_grid_y_ratio     = 1.0;
+
+	_low_rank         = false;
+	_lr_tol           = 0;
+	_lr_max_rank      = 0;
+	_f_epoch_t        = -1;
+	_f_epoch_dirty    = false;
+	_lr_err_max       = 0;
+
+	_layout           = DC_LAYOUT_SEPARATE;
+}
+
+void Decision::SetLowRank(double tol, unsigned int max_rank) {
+	if (_initialized) {
+		printf("Decision::SetLowRank() already initialized\n");
+		return;
+	}
+	_low_rank    = (tol > 0);
+	_lr_tol      = tol;
+	_lr_max_rank = max_rank;
+}
+
+void Decision::SetLayout(int layout) {
+	if (_initialized) {
+		printf("Decision::SetLayout() already initialized\n");
+		return;
+	}
+	if (layout < 0 || layout >= DC_LAYOUT_CNT) {
+		printf("Decision::SetLayout(%d) unknown layout, using separate arrays\n",layout);
+		layout = DC_LAYOUT_SEPARATE;
+	}
+	_layout = layout;
+}
+
+const char *Decision::GetLayoutName(int layout) {
+	switch (layout) {
+	case DC_LAYOUT_SEPARATE:     return "separate";
+	case DC_LAYOUT_RECORD:       return "record";
+	case DC_LAYOUT_EXP_PAIR:     return "experience pair";
+	case DC_LAYOUT_HEALTH_FIRST: return "health first";
+	}
+	return "unknown";
+}
+
+int Decision::BenchmarkLayouts(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim, bool lowRank, bool verbose) {
+	// Two epochs already show the pattern of a year, week t reads epoch t+1
+	int tBench = (tDim < 2) ? tDim : 2;
+
+	int    best      = DC_LAYOUT_SEPARATE;
+	float  best_time = 0;
+	double sum       = 0;
+	for (int layout=0;layout<DC_LAYOUT_CNT;layout++) {
+		if (lowRank && layout == DC_LAYOUT_RECORD)
+			continue;
+
+		Decision dc;
+		dc.SetLayout(layout);
+		dc.InitDimensions(xDim,yDim,eDim,aDim,oDim,sDim,tBench);
+		dc.FillF(1);
+
+		// The first pass touches the pages of the new arrays, the second is timed
+		NanoTimer timerBw, timerFw;
+		for (int pass=0;pass<2;pass++) {
+			timerBw.Clear();
+			timerFw.Clear();
+
+			timerBw.Start();
+			sum += DcBenchmarkBackward(dc);
+			timerBw.Stop();
+
+			timerFw.Start();
+			sum += DcBenchmarkForward(dc);
+			timerFw.Stop();
+		}
+
+		float time = timerBw.GetNanoSeconds() + timerFw.GetNanoSeconds();
+		if (verbose)
+			printf("Decision layout %-16s  backward %9.2f ms  forward %9.2f ms\n", GetLayoutName(layout), 
+				timerBw.GetNanoSeconds()/1000, timerFw.GetNanoSeconds()/1000);
+		if (layout == DC_LAYOUT_SEPARATE || time < best_time) {
+			best      = layout;
+			best_time = time;
+		}
+	}
+
+	if (verbose)
+		printf("Decision layout %s selected (checksum %g)\n", GetLayoutName(best), sum);
+	return best;
 }
 
 void Decision::InitDimensions(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim) {
@@ -51,45 +228,318 @@ void Decision::InitDimensions(int xDim, int yDim, int eDim, int aDim, int oDim,
 		return;
 	}
 
-	_f.Init(xDim,yDim,eDim,aDim,oDim,sDim,tDim);
-	_f_u.Init(xDim,yDim,eDim,aDim,oDim,sDim,tDim);
-	_f_strat.Init(xDim,yDim,eDim,aDim,oDim,sDim,tDim);
+	if (_low_rank && _layout == DC_LAYOUT_RECORD) {
+		printf("Decision::InitDimensions() the record layout needs dense f, using separate arrays\n");
+		_layout = DC_LAYOUT_SEPARATE;
+	}
+
+	// Dimensions in the order of the layout
+	int          dims[7] = { xDim, yDim, eDim, aDim, oDim, sDim, tDim };
+	unsigned int d[7];
+	for (unsigned int i=0;i<7;i++)
+		d[i] = dims[ dcLayoutOrder[_layout][i] ];
+
+	if (_low_rank) {
+		_lr_u.Init(_lr_max_rank,xDim,eDim,aDim,oDim,sDim,tDim);
+		_lr_v.Init(_lr_max_rank,yDim,eDim,aDim,oDim,sDim,tDim);
+		_lr_rank.Init(eDim,aDim,oDim,sDim,tDim);
+		_f_epoch.Init(xDim,yDim,eDim,aDim,oDim,sDim);
+		_f_epoch_t     = -1;
+		_f_epoch_dirty = false;
+		_lr_err_max    = 0;
+	}
+	else if (_layout == DC_LAYOUT_RECORD) {
+		_f.Init(2,d[0],d[1],d[2],d[3],d[4],d[5],d[6]);
+	}
+	else {
+		_f.Init(d[0],d[1],d[2],d[3],d[4],d[5],d[6]);
+	}
+	if (_layout == DC_LAYOUT_RECORD) {
+		NArray<double> empty;
+		_f_u.Swap(empty);
+	}
+	else {
+		_f_u.Init(d[0],d[1],d[2],d[3],d[4],d[5],d[6]);
+	}
+	_f_strat.Init(d[0],d[1],d[2],d[3],d[4],d[5],d[6]);
+	AttachStateArrays();
 
 	_initialized = true;
 }
 
+double Decision::EstimateMemoryMB(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim, double &dense_mb) {
+	double slices = (double)eDim * aDim * oDim * sDim * tDim;
+	double states = slices * xDim * yDim;
+
+	// f_u and f_strat (in the record layout f_u is part of f)
+	dense_mb = states * (sizeof(double) + sizeof(char)) / (1024.0*1024.0);
+
+	double f_bytes;
+	if (_low_rank)
+		f_bytes = slices * (_lr_max_rank*(xDim+yDim)*sizeof(double) + sizeof(unsigned char)) + states / tDim * sizeof(double);
+	else
+		f_bytes = states * sizeof(double);
+
+	return dense_mb + f_bytes / (1024.0*1024.0);
+}
+
+void Decision::AttachStateArrays() {
+	const unsigned int *order = dcLayoutOrder[_layout];
+	if (_layout == DC_LAYOUT_RECORD) {
+		_view_f   = DcLayoutView(_f, order, 1, 0);
+		_view_f_u = DcLayoutView(_f, order, 1, 1);
+	}
+	else {
+		_view_f   = DcLayoutView(_f,   order, 0, 0);
+		_view_f_u = DcLayoutView(_f_u, order, 0, 0);
+	}
+	_view_f_strat = DcLayoutView(_f_strat, order, 0, 0);
+
+	_acc_f.Attach(_view_f);
+	_acc_f_u.Attach(_view_f_u);
+	_acc_f_strat.Attach(_view_f_strat);
+}
+
+NArrayView<double> Decision::GetFPlane(int e, int a, int o, int s, int t) {
+	if (_view_f.GetDims()==0)
+		return NArrayView<double>();
+	return _view_f.Fix(6,t).Fix(5,s).Fix(4,o).Fix(3,a).Fix(2,e);
+}
+
 void   Decision::SetF(int x, int y, int e, int a, int o, int s, int t, double value) 
 {
-	_f(x,y,e,a,o,s,t) = value;
+	if (_low_rank) {
+		SelectEpoch(t);
+		_f_epoch(x,y,e,a,o,s) = value;
+		_f_epoch_dirty = true;
+		return;
+	}
+	_acc_f(x,y,e,a,o,s,t) = value;
+}
+void   Decision::FillF(double value)
+{
+	if (_low_rank) {
+		// Each epoch is compressed when the next one is selected
+		for (unsigned int t=0;t<GetDim(6);t++) {
+			SelectEpoch(t);
+			_f_epoch.Fill(value);
+			_f_epoch_dirty = true;
+		}
+		return;
+	}
+	_view_f.Fill(value);
 }
 double Decision::GetF(int x, int y, int e, int a,  int o, int s, int t)
 {
-	return _f(x,y,e,a,o,s,t);
+	if (_low_rank) {
+		if (t == _f_epoch_t)
+			return _f_epoch(x,y,e,a,o,s);
+
+		double f    = 0;
+		int    rank = _lr_rank(e,a,o,s,t);
+		for (int k=0;k<rank;k++)
+			f += _lr_u(k,x,e,a,o,s,t) * _lr_v(k,y,e,a,o,s,t);
+		return f;
+	}
+	return _acc_f(x,y,e,a,o,s,t);
 }
 
 void   Decision::SetF_u(int x, int y, int e, int a,  int o, int s, int t, double value)
 {
-	_f_u(x,y,e,a,o,s,t) = value;
+	_acc_f_u(x,y,e,a,o,s,t) = value;
 }
 double Decision::GetF_u(int x, int y, int e, int a,  int o, int s, int t)
 {
-	return _f_u(x,y,e,a,o,s,t);
+	return _acc_f_u(x,y,e,a,o,s,t);
 }
 
 void   Decision::SetF_strat(int x, int y, int e, int a,  int o, int s, int t, char value)
 {
-	_f_strat(x,y,e,a,o,s,t) = value;
+	_acc_f_strat(x,y,e,a,o,s,t) = value;
 }
 char   Decision::GetF_strat(int x, int y, int e, int a,  int o, int s, int t)
 {
-	return _f_strat(x,y,e,a,o,s,t);
+	return _acc_f_strat(x,y,e,a,o,s,t);
 }
 
 void   Decision::SetF_all(int x, int y, int e, int a, int o, int s, int t, double f, double f_u, char f_strat)
 {
-	_f(      x,y,e,a,o,s,t) = f;
-	_f_u(    x,y,e,a,o,s,t) = f_u;
-	_f_strat(x,y,e,a,o,s,t) = f_strat;
+	SetF(x,y,e,a,o,s,t, f);
+	_acc_f_u(    x,y,e,a,o,s,t) = f_u;
+	_acc_f_strat(x,y,e,a,o,s,t) = f_strat;
+}
+
+
+void Decision::GetEpochF(int t, NArray<double> &f_epoch)
+{
+	unsigned int xDim = GetDim(0), yDim = GetDim(1), eDim = GetDim(2);
+	unsigned int aDim = GetDim(3), oDim = GetDim(4), sDim = GetDim(5);
+
+	if (f_epoch.GetDims() != 6)
+		f_epoch.Init(xDim,yDim,eDim,aDim,oDim,sDim);
+
+	for (unsigned int s=0;s<sDim;s++) {
+		for (unsigned int o=0;o<oDim;o++) {
+			for (unsigned int a=0;a<aDim;a++) {
+				for (unsigned int e=0;e<eDim;e++) {
+					for (unsigned int y=0;y<yDim;y++) {
+						for (unsigned int x=0;x<xDim;x++) {
+							f_epoch(x,y,e,a,o,s) = GetF(x,y,e,a,o,s,t);
+						} } } } } }
+}
+
+
+//---------------------------------------
+// Low-rank storage of f
+//
+// Each reserves-health slice is approximated by a cross approximation with complete pivoting:
+// the largest entry of the residual selects a row and a column, their outer product divided by
+// the pivot is subtracted. The residual is the exact error of the approximation, so adding terms
+// until its largest entry falls below the tolerance controls the error in the max norm.
+
+void Decision::SelectEpoch(int t) {
+	if (!_low_rank || t == _f_epoch_t)
+		return;
+
+	CommitEpoch();
+
+	unsigned int xDim = GetDim(0), yDim = GetDim(1), eDim = GetDim(2);
+	unsigned int aDim = GetDim(3), oDim = GetDim(4), sDim = GetDim(5);
+
+	// Expand the factors of the new epoch
+	for (unsigned int s=0;s<sDim;s++) {
+		for (unsigned int o=0;o<oDim;o++) {
+			for (unsigned int a=0;a<aDim;a++) {
+				for (unsigned int e=0;e<eDim;e++) {
+					int rank = _lr_rank(e,a,o,s,t);
+					for (unsigned int y=0;y<yDim;y++) {
+						for (unsigned int x=0;x<xDim;x++) {
+							double f = 0;
+							for (int k=0;k<rank;k++)
+								f += _lr_u(k,x,e,a,o,s,t) * _lr_v(k,y,e,a,o,s,t);
+							_f_epoch(x,y,e,a,o,s) = f;
+						} }
+				} } } }
+
+	_f_epoch_t     = t;
+	_f_epoch_dirty = false;
+}
+
+
+void Decision::CommitEpoch() {
+	if (!_low_rank || _f_epoch_t < 0 || !_f_epoch_dirty)
+		return;
+
+	unsigned int xDim = GetDim(0), yDim = GetDim(1), eDim = GetDim(2);
+	unsigned int aDim = GetDim(3), oDim = GetDim(4), sDim = GetDim(5);
+	int t = _f_epoch_t;
+
+	NArray<double> r;
+	r.Init(xDim,yDim);
+
+	for (unsigned int s=0;s<sDim;s++) {
+		for (unsigned int o=0;o<oDim;o++) {
+			for (unsigned int a=0;a<aDim;a++) {
+				for (unsigned int e=0;e<eDim;e++) {
+
+					// Residual starts with the slice
+					double f_max = 0;
+					for (unsigned int y=0;y<yDim;y++) {
+						for (unsigned int x=0;x<xDim;x++) {
+							r(x,y) = _f_epoch(x,y,e,a,o,s);
+							if (fabs(r(x,y)) > f_max)
+								f_max = fabs(r(x,y));
+						} }
+
+					unsigned int rank = 0;
+					double       err  = 0;
+					while (true) {
+						// Pivot: largest entry of the residual
+						unsigned int xp = 0, yp = 0;
+						err = 0;
+						for (unsigned int y=0;y<yDim;y++) {
+							for (unsigned int x=0;x<xDim;x++) {
+								if (fabs(r(x,y)) > err) {
+									err = fabs(r(x,y));
+									xp  = x;
+									yp  = y;
+								}
+							} }
+
+						if (err <= _lr_tol * f_max || rank == _lr_max_rank)
+							break;
+
+						double pivot = r(xp,yp);
+						for (unsigned int x=0;x<xDim;x++)
+							_lr_u(rank,x,e,a,o,s,t) = r(x,yp);
+						for (unsigned int y=0;y<yDim;y++)
+							_lr_v(rank,y,e,a,o,s,t) = r(xp,y) / pivot;
+
+						for (unsigned int y=0;y<yDim;y++) {
+							double v = _lr_v(rank,y,e,a,o,s,t);
+							for (unsigned int x=0;x<xDim;x++)
+								r(x,y) -= _lr_u(rank,x,e,a,o,s,t) * v;
+						}
+						rank++;
+					}
+
+					_lr_rank(e,a,o,s,t) = (unsigned char)rank;
+					if (f_max > 0 && err / f_max > _lr_err_max)
+						_lr_err_max = err / f_max;
+				} } } }
+
+	_f_epoch_dirty = false;
+}
+
+
+void Decision::GetSlice(int e, int a, int o, int s, int t, int &rank, double *&u, double *&v) {
+	if (t == _f_epoch_t) {
+		rank = -1;
+		u    = &_f_epoch(0,0,e,a,o,s);
+		v    = 0;
+		return;
+	}
+	rank = _lr_rank(e,a,o,s,t);
+	u    = &_lr_u(0,0,e,a,o,s,t);
+	v    = &_lr_v(0,0,e,a,o,s,t);
+}
+
+
+void Decision::GetLowRankStatistics(double &rank_avg, double &err_max) {
+	size_t size = _lr_rank.GetSize();
+	unsigned char *rank = _lr_rank.GetData();
+
+	rank_avg = 0;
+	for (size_t i=0;i<size;i++)
+		rank_avg += rank[i];
+	rank_avg = (size > 0) ? rank_avg / size : 0;
+
+	err_max     = _lr_err_max;
+	_lr_err_max = 0;
+}
+
+
+bool Decision::SaveFBinary(FILE *file) {
+	if (!_low_rank)
+		return (_layout == DC_LAYOUT_SEPARATE) ? _f.SaveBinary(file) : DcSaveViewBinary(_view_f, file);
+
+	// Same layout as NArray::SaveBinary(), the epochs are the slowest dimension
+	unsigned int n = 7;
+	if (fwrite(&n, sizeof(unsigned int), 1, file) != 1)
+		return false;
+	for (unsigned int d=0;d<n;d++) {
+		unsigned int dim = GetDim(d);
+		if (fwrite(&dim, sizeof(unsigned int), 1, file) != 1)
+			return false;
+	}
+
+	NArray<double> f_epoch;
+	for (unsigned int t=0;t<GetDim(6);t++) {
+		GetEpochF(t, f_epoch);
+		if (fwrite(f_epoch.GetData(), sizeof(double), f_epoch.GetSize(), file) != f_epoch.GetSize() )
+			return false;
+	}
+	return true;
 }
 
 
@@ -102,9 +552,15 @@ bool   Decision::SaveToFile(char *filename)
 		return false;
 	}
 
-	_f.SaveBinary(file);
-	_f_u.SaveBinary(file);
-	_f_strat.SaveBinary(file);
+	SaveFBinary(file);
+	if (_layout == DC_LAYOUT_SEPARATE) {
+		_f_u.SaveBinary(file);
+		_f_strat.SaveBinary(file);
+	}
+	else {
+		DcSaveViewBinary(_view_f_u, file);
+		DcSaveViewBinary(_view_f_strat, file);
+	}
 
 	fwrite(&_lambda,1,sizeof(double), file);
 	fwrite(&_theta,1,sizeof(double), file);
@@ -114,6 +570,8 @@ bool   Decision::SaveToFile(char *filename)
 	fwrite(&_lambda_worst,1,sizeof(double), file);     
 	fwrite(&_bw_not_converged,1,sizeof(int), file);    
 	fwrite(&_bw_state_count,1,sizeof(int), file);      
+	fwrite(&_grid_x_ratio,1,sizeof(double), file);
+	fwrite(&_grid_y_ratio,1,sizeof(double), file);
 	
 	fclose(file);
 	return true;
@@ -127,18 +585,25 @@ bool Decision::LoadFromFile(char *filename)
 		return false;
 	}
 
+	// the file holds separate arrays [x][y][e][a][o][s][t]
+	_layout = DC_LAYOUT_SEPARATE;
+
+	// a failed load leaves the arrays empty, the accessors must not keep the freed data
 	if (!_f.LoadBinary(file) ) {
 		printf("Decision::load_from_file(%s) error  file read error on 'f'\n",filename);
+		AttachStateArrays();
 		return false;
 	}
 
 	if (!_f_u.LoadBinary(file) ) {
 		printf("Decision::load_from_file(%s) error  file read error on 'f_u'\n",filename);
+		AttachStateArrays();
 		return false;
 	} 
 
 	if (!_f_strat.LoadBinary(file) ) {
 		printf("Decision::load_from_file(%s) error  file read error on 'f_strat'\n",filename);
+		AttachStateArrays();
 		return false;
 	} 
 	
@@ -151,10 +616,75 @@ bool Decision::LoadFromFile(char *filename)
 	fread(&_bw_not_converged,1,sizeof(int), file);    
 	fread(&_bw_state_count,1,sizeof(int), file);      
 
+	// files written before the geometric grids end here, they hold uniform grids
+	if (fread(&_grid_x_ratio,1,sizeof(double), file) != sizeof(double) || fread(&_grid_y_ratio,1,sizeof(double), file) != sizeof(double) ) {
+		_grid_x_ratio = 1.0;
+		_grid_y_ratio = 1.0;
+	}
+
 	fclose(file);
 
+	_low_rank    = false;
 	_initialized = true;
+	AttachStateArrays();
+
+	return true;
+}
+
+
+bool Decision::SavePolicyToFile(char *filename)
+{
+	FILE *file = fopen(filename,"wb");
+	if (file==0) {
+		printf("Decision::SavePolicyToFile(%s) error opening the file for writing\n",filename);
+		return false;
+	}
+
+	bool ok;
+	if (_layout == DC_LAYOUT_SEPARATE)
+		ok = _f_u.SaveBinary(file) && _f_strat.SaveBinary(file);
+	else
+		ok = DcSaveViewBinary(_view_f_u, file) && DcSaveViewBinary(_view_f_strat, file);
+	fclose(file);
+
+	if (!ok)
+		printf("Decision::SavePolicyToFile(%s) error  file write error\n",filename);
+	return ok;
+}
+
+bool Decision::LoadPolicyFromFile(char *filename)
+{
+	FILE *file = fopen(filename,"rb");
+	if (file==0) {
+		printf("Decision::LoadPolicyFromFile(%s) error opening the file for reading\n",filename);
+		return false;
+	}
+
+	// Load into temporaries, so a failed load leaves the current policy intact
+	NArray<double> f_u;
+	NArray<char>   f_strat;
+	bool ok = f_u.LoadBinary(file) && f_strat.LoadBinary(file);
+	fclose(file);
+
+	if (!ok) {
+		printf("Decision::LoadPolicyFromFile(%s) error  file read error\n",filename);
+		return false;
+	}
+	if (f_u.GetSize() != _view_f_u.GetSize() || f_strat.GetSize() != _view_f_strat.GetSize() ) {
+		printf("Decision::LoadPolicyFromFile(%s) error  policy does not match the state space\n",filename);
+		return false;
+	}
 
+	// The other layouts copy the file order into their own
+	if (_layout == DC_LAYOUT_SEPARATE) {
+		_f_u.Swap(f_u);
+		_f_strat.Swap(f_strat);
+		AttachStateArrays();
+	}
+	else {
+		_view_f_u.CopyFrom(f_u.View());
+		_view_f_strat.CopyFrom(f_strat.View());
+	}
 	return true;
 }
 
@@ -178,6 +708,45 @@ void Decision::SaveSummaryStatisticsToFile(char *filename) {
 // Print summary statistics either to console or into a file
 
 
+Decision::DcStratStatistics::DcStratStatistics(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int t) : week(t)
+{
+	dims[0] = xDim;	dims[1] = yDim;	dims[2] = eDim;
+	dims[3] = aDim;	dims[4] = oDim;	dims[5] = sDim;
+	for (int k=0;k<4;k++) {
+		min[k].InitToValue(1000000); // maximal value
+		max[k].InitToValue(      0); // minimal value
+	}
+}
+
+void Decision::DcStratStatistics::operator()(const char &strat, size_t i)
+{
+	int k = (strat=='s') ? 0 : (strat=='c') ? 1 : (strat=='n') ? 2 : (strat=='m') ? 3 : -1;
+	if (k < 0)
+		return;
+
+	// index of the state within the week, x fastest
+	int idx[6];
+	for (int d=0;d<6;d++) {
+		idx[d] = (int) (i % dims[d]);
+		i     /= dims[d];
+	}
+	UpdateMinMaxStat(min[k], max[k], idx[0],idx[1],idx[2],idx[3],idx[4],idx[5],week);
+}
+
+void Decision::DcStratStatistics::Merge(const DcStratStatistics &other)
+{
+	for (int k=0;k<4;k++) {
+		if (other.min[k].cnt==0)
+			continue;
+
+		int cnt = min[k].cnt + other.min[k].cnt;
+		const DcStatisticsStruct &omin = other.min[k], &omax = other.max[k];
+		UpdateMinMaxStat(min[k], max[k], omin.x,omin.y,omin.e,omin.a,omin.o,omin.s,omin.t);
+		UpdateMinMaxStat(min[k], max[k], omax.x,omax.y,omax.e,omax.a,omax.o,omax.s,omax.t);
+		min[k].cnt = max[k].cnt = cnt;
+	}
+}
+
 void Decision::UpdateMinMaxStat(DcStatisticsStruct &min, DcStatisticsStruct &max, int x, int y, int e, int a, int o, int s, int t)
 {
 	min.cnt++;
@@ -205,77 +774,33 @@ void Decision::WriteSummaryStatistics(FILE *file, bool weeklyOutput) {
 
 	int xDim,yDim,eDim,aDim,oDim,sDim,tDim;
 
-	xDim = _f.GetDim(0);
-	yDim = _f.GetDim(1);
-	eDim = _f.GetDim(2);
-	aDim = _f.GetDim(3);
-	oDim = _f.GetDim(4);
-	sDim = _f.GetDim(5);
-	tDim = _f.GetDim(6);
-
-	DcStatisticsStruct sTotalMin, sTotalMax,cTotalMin, cTotalMax,nTotalMin, nTotalMax, mTotalMin, mTotalMax;
+	xDim = GetDim(0);
+	yDim = GetDim(1);
+	eDim = GetDim(2);
+	aDim = GetDim(3);
+	oDim = GetDim(4);
+	sDim = GetDim(5);
+	tDim = GetDim(6);
 
-	sTotalMin.InitToValue(1000000); // maximal value
-	cTotalMin.InitToValue(1000000); 
-	nTotalMin.InitToValue(1000000); 
-	mTotalMin.InitToValue(1000000); 
+	// Statistics of start, care, no care and migrate, the totals merge the weeks
+	DcStratStatistics total(xDim,yDim,eDim,aDim,oDim,sDim,0);
 
-	sTotalMax.InitToValue(      0); // minimal value
-	cTotalMax.InitToValue(      0); 
-	nTotalMax.InitToValue(      0); 
-	mTotalMax.InitToValue(      0); 
+	DcStatisticsStruct &sTotalMin = total.min[0], &sTotalMax = total.max[0];
+	DcStatisticsStruct &cTotalMin = total.min[1], &cTotalMax = total.max[1];
+	DcStatisticsStruct &nTotalMin = total.min[2], &nTotalMax = total.max[2];
+	DcStatisticsStruct &mTotalMin = total.min[3], &mTotalMax = total.max[3];
 
 	for (int week=0; week<tDim; week++) {
-		DcStatisticsStruct sWeekMin, sWeekMax, cWeekMin, cWeekMax, nWeekMin, nWeekMax, mWeekMin,mWeekMax;
-
-		sWeekMin.InitToValue(1000000); // maximal value
-		cWeekMin.InitToValue(1000000);
-		nWeekMin.InitToValue(1000000);
-		mWeekMin.InitToValue(1000000);
-
-		sWeekMax.InitToValue(      0); // minimal value
-		cWeekMax.InitToValue(      0); 
-		nWeekMax.InitToValue(      0); 
-		mWeekMax.InitToValue(      0); 
-
-		for (int x=0;x<xDim;x++) {
-			for (int y=0;y<yDim;y++) {
-				for (int e=0;e<eDim;e++) {
-					for (int a=0;a<aDim;a++) {
-						for (int o=0; o<oDim; o++) {
-							for (int s=0; s<sDim; s++) {
-
-								char strat = _f_strat(x,y,e,a,o,s,week);
-								
-								// start
-								if (strat=='s') {
-									UpdateMinMaxStat(sTotalMin, sTotalMax, x,y,e,a,o,s,week);
-									UpdateMinMaxStat(sWeekMin,  sWeekMax,  x,y,e,a,o,s,week);	
-								}
-
-								// care
-								else if (strat=='c') {
-									UpdateMinMaxStat(cTotalMin, cTotalMax, x,y,e,a,o,s,week);
-									UpdateMinMaxStat(cWeekMin,  cWeekMax,  x,y,e,a,o,s,week);
-								}
-
-								// no care
-								else if (strat=='n') {
-									UpdateMinMaxStat(nTotalMin, nTotalMax, x,y,e,a,o,s,week);
-									UpdateMinMaxStat(nWeekMin,  nWeekMax,  x,y,e,a,o,s,week);
-								}
+		// the statistics do not depend on the visiting order, so the week is reduced in parallel blocks
+		// (serially in the layouts where the week is not contiguous)
+		DcStratStatistics weekStat(xDim,yDim,eDim,aDim,oDim,sDim,week);
+		_view_f_strat.Fix(6, week).Reduce(weekStat);
+		total.Merge(weekStat);
 
-								// migrate
-								else if (strat=='m') {
-									UpdateMinMaxStat(mTotalMin, mTotalMax, x,y,e,a,o,s,week);
-									UpdateMinMaxStat(mWeekMin,  mWeekMax,  x,y,e,a,o,s,week);		
-								}
-							}
-						}
-					}
-				}
-			}
-		}
+		DcStatisticsStruct &sWeekMin = weekStat.min[0], &sWeekMax = weekStat.max[0];
+		DcStatisticsStruct &cWeekMin = weekStat.min[1], &cWeekMax = weekStat.max[1];
+		DcStatisticsStruct &nWeekMin = weekStat.min[2], &nWeekMax = weekStat.max[2];
+		DcStatisticsStruct &mWeekMin = weekStat.min[3], &mWeekMax = weekStat.max[3];
 
 		if (sWeekMin.cnt==0) {
 			sWeekMin.InitToValue(-1);
@@ -369,7 +894,7 @@ void Decision::SaveStatesToBinaryFiles(char *fileprefix)
 		return;
 	}
 	else {
-		_f.SaveBinary(file_f);
+		SaveFBinary(file_f);
 		fclose(file_f);
 	}
 
@@ -379,7 +904,10 @@ void Decision::SaveStatesToBinaryFiles(char *fileprefix)
 		return;
 	}
 	else {
-		_f_u.SaveBinary(file_fu);
+		if (_layout == DC_LAYOUT_SEPARATE)
+			_f_u.SaveBinary(file_fu);
+		else
+			DcSaveViewBinary(_view_f_u, file_fu);
 		fclose(file_fu);
 	}
 
@@ -390,7 +918,10 @@ void Decision::SaveStatesToBinaryFiles(char *fileprefix)
 		return;
 	}
 	else {
-		_f_strat.SaveBinary(file_fs);
+		if (_layout == DC_LAYOUT_SEPARATE)
+			_f_strat.SaveBinary(file_fs);
+		else
+			DcSaveViewBinary(_view_f_strat, file_fs);
 		fclose(file_fs);
 	}
 }
@@ -29,6 +29,18 @@
 #define DECISION_H
 
 #include "..\soar_support_lib\NArray.h"
+#include "..\soar_support_lib\NArrayFixed.h"
+
+#define DC_HORIZON_POLICY_FILE "%s_policy_BW_%03d.bin"  ///< Policy file of one year of the non-stationary horizon (file prefix, year)
+
+#define DC_LAYOUT_AUTO         -1  ///< Storage layout selected by Decision::BenchmarkLayouts()
+#define DC_LAYOUT_SEPARATE      0  ///< f, f_u and f_strat in separate arrays [x][y][e][a][o][s][t]
+#define DC_LAYOUT_RECORD        1  ///< f and f_u of a state side by side [f,f_u][x][y][e][a][o][s][t], f_strat separate
+#define DC_LAYOUT_EXP_PAIR      2  ///< Experience fastest [e][x][y][a][o][s][t], f(e) and f(e+1) of the p_exp blend adjacent
+#define DC_LAYOUT_HEALTH_FIRST  3  ///< Health fastest [y][x][e][a][o][s][t]
+#define DC_LAYOUT_CNT           4  ///< Number of storage layouts
+
+#define DC_MEMORY_MAX_MB   16384.0  ///< Largest estimated memory of the state arrays, Backward::InitBackward() stops above it
 
 /**
  * \ingroup SoarLib
@@ -41,10 +53,39 @@ class Decision {
 private:
 	bool	_initialized;		///< Flags if the state arrays need initialization
 
-	NArray<double>	_f;			///< State array for reproductive value
-	NArray<double>	_f_u;		///< State array for optimal foraging intensity
+	NArray<double>	_f;			///< State array for reproductive value, in the record layout f and f_u
+	NArray<double>	_f_u;		///< State array for optimal foraging intensity, empty in the record layout
 	NArray<char>	_f_strat;	///< State array for optimal behavioral decision (n=no care, c=care, s=start, m=migrate)
 
+	/// \name Storage layout, the arrays above hold the dimensions in the order of the layout
+	/// @{ 
+	int					_layout;		///< Storage layout, one of DC_LAYOUT_SEPARATE..DC_LAYOUT_HEALTH_FIRST
+	NArrayView<double>	_view_f;		///< View [x][y][e][a][o][s][t] of f, empty in low-rank mode
+	NArrayView<double>	_view_f_u;		///< View [x][y][e][a][o][s][t] of f_u
+	NArrayView<char>	_view_f_strat;	///< View [x][y][e][a][o][s][t] of f_strat
+	///@} End of group started by \name
+
+	NArrayFixed<double,7> _acc_f;		///< 7D access to _view_f, empty in low-rank mode
+	NArrayFixed<double,7> _acc_f_u;		///< 7D access to _view_f_u
+	NArrayFixed<char,7>   _acc_f_strat;	///< 7D access to _view_f_strat
+
+	/// \brief Builds the views of the layout and attaches the 7D accessors, needed after the state arrays were allocated, loaded or swapped
+	void AttachStateArrays();
+
+	/// \name Low-rank storage of the reproductive value (experimental)
+	/// @{ 
+	bool			_low_rank;		///< Stores f as low-rank factors of the reserves-health slices instead of _f
+	double			_lr_tol;		///< Relative error (max norm) up to which a slice is approximated
+	unsigned int	_lr_max_rank;	///< Maximum rank of a slice
+	NArray<double>	_lr_u;			///< Reserves factors  [k][x][e][a][o][s][t]
+	NArray<double>	_lr_v;			///< Health factors    [k][y][e][a][o][s][t]
+	NArray<unsigned char> _lr_rank;	///< Rank of each slice [e][a][o][s][t]
+	NArray<double>	_f_epoch;		///< Dense f of the decision epoch currently written [x][y][e][a][o][s]
+	int				_f_epoch_t;		///< Decision epoch held in _f_epoch, -1 if none
+	bool			_f_epoch_dirty;	///< _f_epoch was changed since it was expanded from the factors
+	double			_lr_err_max;	///< Largest relative error of the slices compressed so far
+	///@} End of group started by \name
+
 	double	_lambda;			///< Todo: Describe purpose
 	double  _lambda_avg;		///< Todo: Describe purpose		
 	double  _lambda_state;		///< Todo: Describe purpose
@@ -56,6 +97,8 @@ private:
     double	_conv_level_max;	///< Todo: Describe purpose
     double	_conv_level_sum;	///< Todo: Describe purpose
 	int     _year;				///< Total number of periods in backward iteration
+	double  _grid_x_ratio;		///< Spacing ratio of the reserves grid the decision was computed on
+	double  _grid_y_ratio;		///< Spacing ratio of the health grid the decision was computed on
 
 
 	/**
@@ -79,10 +122,27 @@ private:
 		}
 	};
 
+	/// \brief Compresses the densely held decision epoch into factors if it was changed
+	void CommitEpoch();
+
+	/// \brief Writes f in the binary format of NArray, in low-rank mode expanded epoch by epoch
+	bool SaveFBinary(FILE *file);
+
 	/// \brief Updates two DcStatisticsStruct for min and max values with the current values
-	void UpdateMinMaxStat(DcStatisticsStruct &min, DcStatisticsStruct &max, 
+	static void UpdateMinMaxStat(DcStatisticsStruct &min, DcStatisticsStruct &max, 
 		int x, int y, int e, int a, int o, int s, int t=0);
 
+	/// \brief Min and max values of start, care, no care and migrate in one week, accumulator of NArrayView::Reduce()
+	struct DcStratStatistics {
+		DcStatisticsStruct min[4], max[4];	///< Index 0..3 for 's', 'c', 'n' and 'm'
+		unsigned int       dims[6];			///< Dimensions x..s of the week
+		int                week;			///< The week
+
+		DcStratStatistics(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int t);
+		void operator()(const char &strat, size_t i);
+		void Merge(const DcStratStatistics &other);
+	};
+
 public:
 	/// \brief Constructor
 	Decision();
@@ -95,6 +155,58 @@ public:
 	/// \brief Initializes the state arrays to given dimensions
 	void InitDimensions(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim);
 
+	/**
+	 * \brief Returns the memory in MB the state arrays of InitDimensions() take
+	 *
+	 * In low-rank mode these are the factors of f at the maximum rank, the dense epoch of f and 
+	 * the dense f_u and f_strat, which dominate for large grids.
+	 * \param dense_mb  Returns the share of f_u and f_strat
+	 */
+	double EstimateMemoryMB(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim, double &dense_mb);
+
+	/**
+	 * \brief Selects the low-rank storage of f for the following InitDimensions() (experimental)
+	 *
+	 * Each reserves-health slice of f is stored as sum_k u_k(x) v_k(y) with the rank chosen so that the
+	 * largest deviation stays below tol times the largest value of the slice. Only the decision epoch
+	 * currently written is held densely. A tolerance of 0 keeps the dense storage. f_u and f_strat
+	 * are still stored densely, so the memory saving covers f only, see EstimateMemoryMB().
+	 * \param tol       Relative error of the slices
+	 * \param max_rank  Maximum rank of a slice
+	 */
+	void SetLowRank(double tol, unsigned int max_rank);
+
+	/// \brief Returns TRUE if f is stored as low-rank factors
+	bool IsLowRank()		{	return _low_rank;		}
+
+	/**
+	 * \brief Selects the storage layout of the state arrays for the following InitDimensions()
+	 *
+	 * The layouts differ only in the order of the elements in memory, all accessors keep the 
+	 * order [x][y][e][a][o][s][t]. The record layout needs dense f and falls back to separate 
+	 * arrays in low-rank mode.
+	 * \param layout  One of DC_LAYOUT_SEPARATE..DC_LAYOUT_HEALTH_FIRST
+	 */
+	void SetLayout(int layout);
+
+	/// \brief Returns the storage layout of the state arrays
+	int  GetLayout()		{	return _layout;			}
+
+	/// \brief Returns the name of a storage layout
+	static const char *GetLayoutName(int layout);
+
+	/**
+	 * \brief Times the access patterns of Backward and Forward on each storage layout and returns the fastest
+	 *
+	 * The state arrays are allocated with the given dimensions, but at most two decision epochs.
+	 * Backward reads the reserves-health planes of f at experience e and e+1 and writes f, f_u and 
+	 * f_strat of each state, Forward reads f_u and f_strat in the order of the states.
+	 * \param lowRank  Excludes the layouts needing dense f
+	 * \param verbose  Prints the time of each layout
+	 * \return The fastest layout
+	 */
+	static int BenchmarkLayouts(int xDim, int yDim, int eDim, int aDim, int oDim, int sDim, int tDim, bool lowRank, bool verbose);
+
 
 	/// \brief Returns TRUE if the state arrays are allocated
 	bool IsInitialized()	{	return _initialized;	}
@@ -102,8 +214,22 @@ public:
 
 	/// \name State array access
 	/// @{ 
-	/// \brief Return reference to f array object
-	NArray<double> & GetF()	{	return _f;	};
+	/// \brief Return reference to the f storage array in the order of GetLayout(), use GetFView() or GetDim() for [x][y][e][a][o][s][t]
+	NArray<double> & GetFStorage()	{	return _f;	};
+	/// \brief Return reference to the f_u storage array in the order of GetLayout(), use GetF_uView() or GetDim() for [x][y][e][a][o][s][t]
+	NArray<double> & GetF_uStorage()	{	return _f_u;	};
+	/// \brief Return reference to the f_strat storage array in the order of GetLayout(), use GetF_stratView() or GetDim() for [x][y][e][a][o][s][t]
+	NArray<char> & GetF_stratStorage()	{	return _f_strat;	};
+
+	/// \brief Returns the view [x][y][e][a][o][s][t] of f in any layout, empty in low-rank mode
+	NArrayView<double> GetFView()			{	return _view_f;			}
+	/// \brief Returns the view [x][y][e][a][o][s][t] of f_u in any layout
+	NArrayView<double> GetF_uView()			{	return _view_f_u;		}
+	/// \brief Returns the view [x][y][e][a][o][s][t] of f_strat in any layout
+	NArrayView<char>   GetF_stratView()		{	return _view_f_strat;	}
+
+	/// \brief Returns the 2D view [x][y] of f at (e,a,o,s,t), empty in low-rank mode
+	NArrayView<double> GetFPlane(int e, int a, int o, int s, int t);
 
 	/// \brief Sets the reproductive value for a given state vector 
 	void   SetF(int x, int y, int e, int a, int o, int s, int t, double value);
@@ -122,6 +248,39 @@ public:
 
 	/// \brief Sets all three values (reproductive value,optimal foraging intensity, optimal behavioral decision) for a given state vector 
 	void   SetF_all(int x, int y, int e, int a, int o, int s, int t, double f, double f_u, char f_strat);
+
+	/// \brief Sets the reproductive value of all states, in parallel blocks or epoch by epoch in low-rank mode
+	void   FillF(double value);
+
+	/// \brief Returns the dimension d of the state arrays
+	unsigned int GetDim(unsigned int d)		{	return _view_f_strat.GetDim(d);	}
+
+	/// \brief Copies the reproductive values of decision epoch t into the 6 dimensional array f_epoch [x][y][e][a][o][s]
+	void   GetEpochF(int t, NArray<double> &f_epoch);
+	///@} End of group started by \name
+
+
+	/// \name Low-rank slice access
+	/// @{ 
+	/**
+	 * \brief Makes t the densely held decision epoch, the previous one is compressed into factors.
+	 * Only needed in low-rank mode, SetF() selects the epoch as well.
+	 */
+	void   SelectEpoch(int t);
+
+	/**
+	 * \brief Returns the storage of the reserves-health slice (e,a,o,s,t) in low-rank mode
+	 * \param rank  Output: rank of the slice, -1 if the slice is held densely
+	 * \param u     Output: reserves factors u[x*GetLowRankStride()+k], or the dense slice u[x+y*xDim]
+	 * \param v     Output: health factors v[y*GetLowRankStride()+k]
+	 */
+	void   GetSlice(int e, int a, int o, int s, int t, int &rank, double *&u, double *&v);
+
+	/// \brief Returns the distance of the factors of consecutive grid points
+	unsigned int GetLowRankStride()	{	return _lr_max_rank;	}
+
+	/// \brief Returns the average rank of the slices and the largest relative error since the last call
+	void   GetLowRankStatistics(double &rank_avg, double &err_max);
 	///@} End of group started by \name
 
 
@@ -155,6 +314,10 @@ public:
 	void   SetYear(int y)				{	_year = y;					}
 	int    GetYear()					{	return _year;				}
 
+	void   SetGridRatio(double x, double y)	{	_grid_x_ratio = x;	_grid_y_ratio = y;	}
+	double GetGridXRatio()				{	return _grid_x_ratio;		}
+	double GetGridYRatio()				{	return _grid_y_ratio;		}
+
 
 	/// \name Saving and loading of decision state
 	/// @{ 
@@ -169,6 +332,19 @@ public:
 	 * \return True if succesfull, else loading error
 	 */
 	bool LoadFromFile(char *filename);
+
+	/**
+	 * \brief Save the policy (f_u and f_strat) of all decision epochs into a binary file, used 
+	 * to stream the years of a non-stationary horizon
+	 * \return True if succesfull, else save error
+	 */
+	bool SavePolicyToFile(char *filename);
+
+	/**
+	 * \brief Load a policy saved by SavePolicyToFile() into the initialized decision;
+	 * \return True if succesfull, else loading error or dimension mismatch
+	 */
+	bool LoadPolicyFromFile(char *filename);
 	///@} End of group started by \name	
 	
 	/// \name Statistics output
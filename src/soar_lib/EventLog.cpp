@@ -0,0 +1,136 @@
+/**
+* \file EventLog.cpp
+* \brief Implementation of class EventLog
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#include "EventLog.h"
+
+#pragma warning ( disable: 4996) // warning C4996: 'fopen': This function or variable may be unsafe.
+
+EventLog::EventLog(unsigned int chunk_size) {
+	_chunk_size = (chunk_size > 0) ? chunk_size : 1;
+	_file       = 0;
+	_written    = 0;
+
+	_id.reserve(_chunk_size);
+	_year.reserve(_chunk_size);
+	_week.reserve(_chunk_size);
+	_type.reserve(_chunk_size);
+	_value.reserve(_chunk_size);
+}
+
+EventLog::~EventLog() {
+	Close();
+}
+
+void EventLog::Clear() {
+	_id.clear();
+	_year.clear();
+	_week.clear();
+	_type.clear();
+	_value.clear();
+	_written = 0;
+}
+
+// Starts a new log written to filename
+bool EventLog::Open(char *filename) {
+	Close();
+	Clear();
+
+	_file = fopen(filename,"wb");
+	if (_file==0) {
+		printf("EventLog::Open(%s) error opening the file for writing\n",filename);
+		return false;
+	}
+	return true;
+}
+
+// Writes the buffered events as one chunk and empties the pool, keeping its memory
+bool EventLog::Flush() {
+	if (_file==0 || _id.empty())
+		return true;
+
+	unsigned int n = _id.size();
+	bool okay = fwrite(&n, sizeof(unsigned int), 1, _file) == 1
+	         && fwrite(&_id[0],    sizeof(unsigned int),  n, _file) == n
+	         && fwrite(&_year[0],  sizeof(unsigned int),  n, _file) == n
+	         && fwrite(&_week[0],  sizeof(unsigned char), n, _file) == n
+	         && fwrite(&_type[0],  sizeof(unsigned char), n, _file) == n
+	         && fwrite(&_value[0], sizeof(int),           n, _file) == n;
+	if (!okay)
+		printf("EventLog::Flush() error writing %d events\n",n);
+
+	_written += n;
+	_id.clear();
+	_year.clear();
+	_week.clear();
+	_type.clear();
+	_value.clear();
+	return okay;
+}
+
+// Writes the remaining events and closes the file
+bool EventLog::Close() {
+	if (_file==0)
+		return true;
+
+	bool okay = Flush();
+	fclose(_file);
+	_file = 0;
+	return okay;
+}
+
+// Loads all chunks of a log file into memory
+bool EventLog::LoadFromFile(char *filename) {
+	Close();
+	Clear();
+
+	FILE *file = fopen(filename,"rb");
+	if (file==0) {
+		printf("EventLog::LoadFromFile(%s) error opening the file for reading\n",filename);
+		return false;
+	}
+
+	unsigned int n;
+	bool okay = true;
+	while (okay && fread(&n, sizeof(unsigned int), 1, file) == 1) {
+		unsigned int m = _id.size();
+		_id.resize(m+n);
+		_year.resize(m+n);
+		_week.resize(m+n);
+		_type.resize(m+n);
+		_value.resize(m+n);
+		okay = n == 0 
+		    || (fread(&_id[m],    sizeof(unsigned int),  n, file) == n
+		     && fread(&_year[m],  sizeof(unsigned int),  n, file) == n
+		     && fread(&_week[m],  sizeof(unsigned char), n, file) == n
+		     && fread(&_type[m],  sizeof(unsigned char), n, file) == n
+		     && fread(&_value[m], sizeof(int),           n, file) == n);
+	}
+	fclose(file);
+
+	if (!okay) {
+		printf("EventLog::LoadFromFile(%s) error file read error\n",filename);
+		Clear();
+	}
+	return okay;
+}
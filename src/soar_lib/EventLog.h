@@ -0,0 +1,120 @@
+/**
+* \file EventLog.h
+* \brief Declaration of class EventLog
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <stdio.h>
+#include <vector>
+
+#define EVENTLOG_CHUNK_SIZE 65536		///< Number of buffered events written as one chunk
+
+/**
+ * \ingroup SoarLib
+ * \brief Life-history event types of the EventLog
+ */
+enum EventType {
+	EVENT_INDEPENDENCE = 0,		///< Individual became independent, value: identity of the parent or -1 for the starting cohort
+	EVENT_BROOD_START,			///< Reproduction started, value: location
+	EVENT_BROOD_ABANDON,		///< Brood abandoned, value: brood age
+	EVENT_FLEDGING,				///< Young became independent, value: number of young
+	EVENT_MIGRATION_START,		///< Migration started, value: location of departure
+	EVENT_DEATH_PREDATION,		///< Death by predation, value: state index
+	EVENT_DEATH_DISEASE,		///< Death by disease, value: state index
+	EVENT_DEATH_STARVATION,		///< Death by depletion of reserves, value: state index
+	EVENT_RESAMPLE_REMOVED,		///< Individual removed by the resampling of the population, value: -1
+	EVENT_RESAMPLE_COPY			///< Individual added as copy by the resampling of the population, value: identity of the original
+};
+
+/**
+ * \ingroup SoarLib
+ * \brief Append-only columnar log of the life-history events of a simulated population
+ * <HR />
+ *
+ * All individuals share one pool of columns for identity, year, week, event type and value, 
+ * so recording does not allocate per individual. With an open file the pool is written as a 
+ * chunk whenever it holds the chunk size of events and is then reused, otherwise all events 
+ * stay in memory.
+ *
+ * Each chunk of the file consists of the event count n followed by the columns
+ * unsigned int id[n], unsigned int year[n], unsigned char week[n], unsigned char type[n], int value[n].
+ *
+ * \code
+ *   EventLog log;
+ *   log.Open("run_lifehistory_FW.bin");
+ *   log.Add(id, year, week, EVENT_BROOD_START, o);
+ *   log.Close();
+ *
+ *   EventLog all;
+ *   all.LoadFromFile("run_lifehistory_FW.bin");
+ * \endcode
+ *
+ * <H2 class="groupheader">Include</H2>
+ */
+class EventLog {
+private:
+	std::vector<unsigned int>  _id;		///< Identity of the individual
+	std::vector<unsigned int>  _year;	///< Year of the event
+	std::vector<unsigned char> _week;	///< Week of the event
+	std::vector<unsigned char> _type;	///< Event type, see EventType
+	std::vector<int>           _value;	///< Event specific value, see EventType
+
+	unsigned int _chunk_size;	///< Number of events per chunk
+	FILE *       _file;			///< Output file, 0 keeps the events in memory
+	unsigned int _written;		///< Number of events already written to the file
+
+public:
+	EventLog(unsigned int chunk_size = EVENTLOG_CHUNK_SIZE);
+	~EventLog();
+
+	bool Open(char *filename);
+	bool Flush();
+	bool Close();
+	bool LoadFromFile(char *filename);
+
+	/// Appends an event, writes a chunk if the pool is full
+	void Add(unsigned int id, unsigned int year, unsigned int week, EventType type, int value) {
+		_id.push_back(id);
+		_year.push_back(year);
+		_week.push_back((unsigned char)week);
+		_type.push_back((unsigned char)type);
+		_value.push_back(value);
+		if (_file != 0 && _id.size() >= _chunk_size)
+			Flush();
+	}
+
+	/// Removes all buffered events
+	void Clear();
+
+	unsigned int GetCount()   { return _written + _id.size(); }	///< Number of events logged since Open() or Clear()
+	unsigned int GetSize()    { return _id.size(); }			///< Number of events in memory
+
+	unsigned int GetId(unsigned int i)    { return _id[i]; }
+	unsigned int GetYear(unsigned int i)  { return _year[i]; }
+	unsigned int GetWeek(unsigned int i)  { return _week[i]; }
+	EventType    GetType(unsigned int i)  { return (EventType)_type[i]; }
+	int          GetValue(unsigned int i) { return _value[i]; }
+};
+
+#endif
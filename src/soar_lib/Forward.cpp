@@ -30,21 +30,64 @@
 #include <iostream>
 #include <fstream>
 #include <math.h>
+#include <float.h>
 #include <algorithm>
 #include <iterator>
 #include <limits>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "Decision.h"
 #include "Settings.h"
-#include "Individual.h"
 
 #pragma warning ( disable: 4996) // warning C4996: 'fopen': This function or variable may be unsafe.
 
 #define CALC_PRECISION (100000.0)
 #define CALC_EPS       (1.0 / CALC_PRECISION)
 
+#define FW_KRYLOV_DIM          12		///< Number of annual projections per Arnoldi cycle of the eigen solver
+#define FW_EIGEN_RESIDUAL_FAC  0.01		///< Eigen solver stops at a relative residual below this fraction of the convergence criterion
+#define FW_QR_MAX_STEPS        60		///< Maximum QR steps until an unreduced block of the projected matrix splits
+#define FW_EIGEN_ZERO_REL      1.0e-12	///< Stable distribution values below this fraction of the maximum are rounding noise
+
+#define FW_ACTION_NO_CARE      0		///< Marginal summary action: no care, also states skipped by the pruning
+#define FW_ACTION_START        1		///< Marginal summary action: start reproduction
+#define FW_ACTION_CARE         2		///< Marginal summary action: care for young
+#define FW_ACTION_MIGRATE      3		///< Marginal summary action: migrate
+#define FW_ACTION_CNT          4		///< Number of actions of the marginal summaries
+#define FW_ACTION_NONE         255		///< States with depleted reserves (x=0) take no action
+
+#define FW_LH_REMAINING        1.0e-10	///< Life-history metrics stop below this probability to be alive
+#define FW_LH_MAX_YEARS        1000		///< Life-history metrics stop after this number of years of age
+
+#define FW_OPERATOR_MAX_MB     4096.0	///< Largest estimated memory of the week operators of all weeks, above it each week is built when projected
+
+#define FW_BATCH_BLOCK         8		///< Number of seeds summed in registers by the batched week operator
+
+#define FW_MC_ALIVE            0		///< Monte Carlo fate: the individual survives the week
+#define FW_MC_PREDATION        1		///< Monte Carlo fate: death by predation
+#define FW_MC_DISEASE          2		///< Monte Carlo fate: death by disease
+#define FW_MC_STARVATION       3		///< Monte Carlo fate: death by depletion of reserves
+#define FW_MC_DRAW_X           0		///< Random number of the reserves grid node of an independent young
+#define FW_MC_DRAW_Y           1		///< Random number of the health grid node of an independent young
+#define FW_MC_DRAW_FATE        2		///< Random number of the weekly transition
+#define FW_MC_DRAW_COPY        3		///< Random number of the resampling
+#define FW_MC_RESAMPLE_FAC     2		///< The population is resampled to the cohort size when it grew or shrank by this factor
+
 Forward::Forward() {
-	_decision = 0;
+	_decision    = 0;
+	_monte_carlo = false;
+	_mc_seed     = 1;
+	_mc_log      = false;
+	_batch_all_starts = false;
+	_low_cost_convergence = false;
+	_low_cost_final_check = false;
+	_save_marginals       = false;
+	_save_full_dynamics   = true;
+	_op_on_demand         = false;
+	_op_week              = -1;
 }
 
 Forward::~Forward() {
@@ -109,6 +152,24 @@ void   Forward::SaveMortalityPatterns(char *filename)
 	fclose(file);
 }
 
+void   Forward::SaveBatchResults(char *filename)
+{
+	if (_batch_lambda.GetSize()==0)  {
+		return;
+	}
+
+	FILE *file = fopen(filename,"wb");
+	if (file==0) {
+		printf("Forward::SaveBatchResults(%s) error opening the file for writing\n",filename);
+		return;
+	}    
+
+	_batch_lambda.SaveBinary(file);
+	_batch_props.SaveBinary(file);
+
+	fclose(file);
+}
+
 bool Forward::LoadFwFromFile(char *filename) 
 {
 	FILE *file = fopen(filename,"rb");
@@ -148,303 +209,59 @@ bool Forward::LoadFwFromFile(char *filename)
 // ------------------------------------------------------------------
 void Forward::Stoch_HMcN_AddStochNone(double x_case, double y_case, FwStochXYPropResultStruct &cases)
 {
-	// Stochasticity for variable x (reserves)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator X_un1_It  = std::upper_bound(_x_vec.begin(), _x_vec.end(), x_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int X_ln1_Ind = Chop((int) std::distance(_x_vec.begin(),X_un1_It)-1, 0, _x_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double X_ln1  = _x_vec[X_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int X_un1_Ind = Chop(X_ln1_Ind + 1, 0, _x_cnt-1);                          // index of 1st upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Xun1 = (x_case-X_ln1)/_dx;									   // probability of 1st upper node, linear case
-	double p_Xln1 = 1-p_Xun1;											   // probability of 1st lower node, linear case
-
-	// Stochasticity for variable y (condition)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator Y_un1_It  = std::upper_bound(_y_vec.begin(), _y_vec.end(), y_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int Y_ln1_Ind = Chop((int) std::distance(_y_vec.begin(),Y_un1_It)-1, 0, _y_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double Y_ln1  = _y_vec[Y_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other surrounding node:
-	int Y_un1_Ind = Chop(Y_ln1_Ind + 1, 0, _y_cnt-1);                          // index of 1st upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Yun1 = (y_case-Y_ln1)/_dy;									   // probability of 1st upper node, linear case
-	double p_Yln1 = 1-p_Yun1;											   // probability of 1st lower node, linear case
-
-
-	// return results:
-	cases.x_grid[0] = X_ln1_Ind;
-	cases.x_grid[1] = X_un1_Ind;
-
-	cases.y_grid[0] = Y_ln1_Ind;
-	cases.y_grid[1] = Y_un1_Ind;
-
-	cases.x_prop[0] = p_Xln1;
-	cases.x_prop[1] = p_Xun1;
-
-	cases.y_prop[0] = p_Yln1;
-	cases.y_prop[1] = p_Yun1;
+	GridStencilAxis<2>::Nodes(_x_grid, x_case, _stochfac_x, cases.x_grid, cases.x_prop);
+	GridStencilAxis<2>::Nodes(_y_grid, y_case, _stochfac_x, cases.y_grid, cases.y_prop);
 }
 
 
 // ------------------------------------------------------------------
 // Additional stochasticity for reserves (default)
 // ------------------------------------------------------------------
-// Function to interpolate between grid points and to introduce additional stochasticity following Houston and McNamara 1999, e.g. to prevent grid effects or to include additional environmental stochasticity. 
 void Forward::Stoch_HMcN_AddStochRes(double x_case, double y_case, FwStochXYPropResultStruct &cases)
 {
-	// Stochasticity for variable x (reserves)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator X_un1_It  = std::upper_bound(_x_vec.begin(), _x_vec.end(), x_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int X_ln1_Ind = Chop((int) std::distance(_x_vec.begin(),X_un1_It)-1, 0, _x_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double X_ln1  = _x_vec[X_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int X_ln2_Ind = Chop(X_ln1_Ind - 1, 0, _x_cnt-1);						   // index of 2nd lower node
-	int X_un1_Ind = Chop(X_ln1_Ind + 1, 0, _x_cnt-1);                          // index of 1st upper node
-	int X_un2_Ind = Chop(X_ln1_Ind + 2, 0, _x_cnt-1);						   // index of 2nd upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Xun1_lc = (x_case-X_ln1)/_dx;									   // probability of 1st upper node, linear case
-	double p_Xln1_lc = 1-p_Xun1_lc;											   // probability of 1st lower node, linear case
-
-	// Control degree of stochasticity through stochfac alpha:
-	double p_Xln2 = _stochfac_x * p_Xln1_lc;								   // probability of 2nd lower node
-	double p_Xln1 = (1-2*_stochfac_x) * p_Xln1_lc + _stochfac_x * p_Xun1_lc;   // cumulative probability of 1st lower node
-	double p_Xun1 = _stochfac_x * p_Xln1_lc + (1-2*_stochfac_x) * p_Xun1_lc;   // cumulative probability of 1st upper node
-	double p_Xun2 = _stochfac_x * p_Xun1_lc;								   // cumulative probability of 2nd upper node - actually not needed, should be 1.0
-
-	// Stochasticity for variable y (condition)
-
-	// Determine the first upper node:
-	std::vector<double>::iterator Y_un1_It  = std::upper_bound(_y_vec.begin(), _y_vec.end(), y_case) ;
-	// iterator pointing to first element which doesn't compare less than y_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than y_case
-
-	int Y_ln1_Ind = Chop((int) std::distance(_y_vec.begin(),Y_un1_It)-1, 0, _y_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account 
-	// for std::distance (or that C starts from 0 respectively)
-
-	double Y_ln1  = _y_vec[Y_ln1_Ind];										   // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int Y_un1_Ind = Chop(Y_ln1_Ind + 1, 0, _y_cnt-1);						   // index of first upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Yun1 = (y_case-Y_ln1)/_dy;                                        // probability of 1st upper node
-	double p_Yln1 = 1-p_Yun1;                                                  // probability of 1st lower node
-
-	// return results:
-	cases.x_grid[0] = X_ln2_Ind;
-	cases.x_grid[1] = X_ln1_Ind;
-	cases.x_grid[2] = X_un1_Ind;
-	cases.x_grid[3] = X_un2_Ind;
-
-	cases.y_grid[0] = Y_ln1_Ind;
-	cases.y_grid[1] = Y_un1_Ind;
-
-	cases.x_prop[0] = p_Xln2;
-	cases.x_prop[1] = p_Xln1;
-	cases.x_prop[2] = p_Xun1;
-	cases.x_prop[3] = p_Xun2;
-
-	cases.y_prop[0] = p_Yln1;
-	cases.y_prop[1] = p_Yun1;
-
+	GridStencilAxis<4>::Nodes(_x_grid, x_case, _stochfac_x, cases.x_grid, cases.x_prop);
+	GridStencilAxis<2>::Nodes(_y_grid, y_case, _stochfac_x, cases.y_grid, cases.y_prop);
 }
 
 
 // ------------------------------------------------------------------
 // Additional stochasticity for health only
 // ------------------------------------------------------------------
-// Function to introduce stochasticity, e.g. to prevent grid effects or to include additional environmental stochasticity
 void Forward::Stoch_HMcN_AddStochHealth(double x_case, double y_case, FwStochXYPropResultStruct &cases)
 {
-	// Stochasticity for variable x (reserves)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator X_un1_It  = std::upper_bound(_x_vec.begin(), _x_vec.end(), x_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int X_ln1_Ind = Chop((int) std::distance(_x_vec.begin(),X_un1_It)-1, 0, _x_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double X_ln1  = _x_vec[X_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other surrounding node:
-	int X_un1_Ind = Chop(X_ln1_Ind + 1, 0, _x_cnt-1);                          // index of 1st upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Xun1 = (x_case-X_ln1)/_dx;									   // probability of 1st upper node, linear case
-	double p_Xln1 = 1-p_Xun1;											   // probability of 1st lower node, linear case
-
-	// Stochasticity for variable y (condition)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator Y_un1_It  = std::upper_bound(_y_vec.begin(), _y_vec.end(), y_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int Y_ln1_Ind = Chop((int) std::distance(_y_vec.begin(),Y_un1_It)-1, 0, _y_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double Y_ln1  = _y_vec[Y_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int Y_ln2_Ind = Chop(Y_ln1_Ind - 1, 0, _y_cnt-1);						   // index of 2nd lower node
-	int Y_un1_Ind = Chop(Y_ln1_Ind + 1, 0, _y_cnt-1);                          // index of 1st upper node
-	int Y_un2_Ind = Chop(Y_ln1_Ind + 2, 0, _y_cnt-1);						   // index of 2nd upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Yun1_lc = (y_case-Y_ln1)/_dy;									   // probability of 1st upper node, linear case
-	double p_Yln1_lc = 1-p_Yun1_lc;											   // probability of 1st lower node, linear case
-
-	// Control degree of stochasticity through stochfac alpha:
-	double p_Yln2 = _stochfac_x * p_Yln1_lc;								   // probability of 2nd lower node
-	double p_Yln1 = (1-2*_stochfac_x) * p_Yln1_lc + _stochfac_x * p_Yun1_lc;   // cumulative probability of 1st lower node
-	double p_Yun1 = _stochfac_x * p_Yln1_lc + (1-2*_stochfac_x) * p_Yun1_lc;   // cumulative probability of 1st upper node
-	double p_Yun2 = _stochfac_x * p_Yun1_lc;								   // cumulative probability of 2nd upper node - actually not needed, should be 1.0
-
-
-	// return results:
-	cases.x_grid[0] = X_ln1_Ind;
-	cases.x_grid[1] = X_un1_Ind;
-
-	cases.y_grid[0] = Y_ln2_Ind;
-	cases.y_grid[1] = Y_ln1_Ind;
-	cases.y_grid[2] = Y_un1_Ind;
-	cases.y_grid[3] = Y_un2_Ind;
-
-	cases.x_prop[0] = p_Xln1;
-	cases.x_prop[1] = p_Xun1;
-
-	cases.y_prop[0] = p_Yln2;
-	cases.y_prop[1] = p_Yln1;
-	cases.y_prop[2] = p_Yun1;
-	cases.y_prop[3] = p_Yun2;
-
+	GridStencilAxis<2>::Nodes(_x_grid, x_case, _stochfac_x, cases.x_grid, cases.x_prop);
+	GridStencilAxis<4>::Nodes(_y_grid, y_case, _stochfac_x, cases.y_grid, cases.y_prop);
 }
 
 // ------------------------------------------------------------------
 // Additional stochasticity for reserves and health
 // ------------------------------------------------------------------
-// Function to introduce stochasticity, e.g. to prevent grid effects or to include additional environmental stochasticity
 void Forward::Stoch_HMcN_AddStochResHealth(double x_case, double y_case, FwStochXYPropResultStruct &cases)
 {
-	// Stochasticity for variable x (reserves)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator X_un1_It  = std::upper_bound(_x_vec.begin(), _x_vec.end(), x_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int X_ln1_Ind = Chop((int) std::distance(_x_vec.begin(),X_un1_It)-1, 0, _x_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double X_ln1  = _x_vec[X_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int X_ln2_Ind = Chop(X_ln1_Ind - 1, 0, _x_cnt-1);						   // index of 2nd lower node
-	int X_un1_Ind = Chop(X_ln1_Ind + 1, 0, _x_cnt-1);                          // index of 1st upper node
-	int X_un2_Ind = Chop(X_ln1_Ind + 2, 0, _x_cnt-1);						   // index of 2nd upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Xun1_lc = (x_case-X_ln1)/_dx;									   // probability of 1st upper node, linear case
-	double p_Xln1_lc = 1-p_Xun1_lc;											   // probability of 1st lower node, linear case
-
-	// Control degree of stochasticity through stochfac alpha:
-	double p_Xln2 = _stochfac_x * p_Xln1_lc;								   // probability of 2nd lower node
-	double p_Xln1 = (1-2*_stochfac_x) * p_Xln1_lc + _stochfac_x * p_Xun1_lc;   // cumulative probability of 1st lower node
-	double p_Xun1 = _stochfac_x * p_Xln1_lc + (1-2*_stochfac_x) * p_Xun1_lc;   // cumulative probability of 1st upper node
-	double p_Xun2 = _stochfac_x * p_Xun1_lc;								   // cumulative probability of 2nd upper node - actually not needed, should be 1.0
-
-	// Stochasticity for variable y (condition)
-
-	// Determine the first lower node:
-	std::vector<double>::iterator Y_un1_It  = std::upper_bound(_y_vec.begin(), _y_vec.end(), y_case);
-	// iterator pointing to first element which doesn't compare less than x_case, i.e. to first upper node;
-	// returns last element if all elements in the range compare less than x_case
-
-	int Y_ln1_Ind = Chop((int) std::distance(_y_vec.begin(),Y_un1_It)-1, 0, _y_cnt-1 );
-	// std::distance -> number of elements between first and last (including first and last)
-	// x_vec.size()-1-1 <- -1 to account for transformation from un1 to ln1, and -1 to account for std::distance (or that C starts from 0 respectively)
-
-	double Y_ln1  = _y_vec[Y_ln1_Ind];  // value of 1st lower node, within range of grid
-
-	// Determine the indices of the other 3 surrounding nodes:
-	int Y_ln2_Ind = Chop(Y_ln1_Ind - 1, 0, _y_cnt-1);						   // index of 2nd lower node
-	int Y_un1_Ind = Chop(Y_ln1_Ind + 1, 0, _y_cnt-1);                          // index of 1st upper node
-	int Y_un2_Ind = Chop(Y_ln1_Ind + 2, 0, _y_cnt-1);						   // index of 2nd upper node
-
-	// Set probabilities that the value of these nodes is taken:
-	double p_Yun1_lc = (y_case-Y_ln1)/_dy;									   // probability of 1st upper node, linear case
-	double p_Yln1_lc = 1-p_Yun1_lc;											   // probability of 1st lower node, linear case
-
-	// Control degree of stochasticity through stochfac alpha:
-	double p_Yln2 = _stochfac_x * p_Yln1_lc;								   // probability of 2nd lower node
-	double p_Yln1 = (1-2*_stochfac_x) * p_Yln1_lc + _stochfac_x * p_Yun1_lc;   // cumulative probability of 1st lower node
-	double p_Yun1 = _stochfac_x * p_Yln1_lc + (1-2*_stochfac_x) * p_Yun1_lc;   // cumulative probability of 1st upper node
-	double p_Yun2 = _stochfac_x * p_Yun1_lc;								   // cumulative probability of 2nd upper node - actually not needed, should be 1.0
-
-
-	// return results:
-	cases.x_grid[0] = X_ln2_Ind;
-	cases.x_grid[1] = X_ln1_Ind;
-	cases.x_grid[2] = X_un1_Ind;
-	cases.x_grid[3] = X_un2_Ind;
-
-	cases.y_grid[0] = Y_ln2_Ind;
-	cases.y_grid[1] = Y_ln1_Ind;
-	cases.y_grid[2] = Y_un1_Ind;
-	cases.y_grid[3] = Y_un2_Ind;
-
-	cases.x_prop[0] = p_Xln2;
-	cases.x_prop[1] = p_Xln1;
-	cases.x_prop[2] = p_Xun1;
-	cases.x_prop[3] = p_Xun2;
-
-	cases.y_prop[0] = p_Yln2;
-	cases.y_prop[1] = p_Yln1;
-	cases.y_prop[2] = p_Yun1;
-	cases.y_prop[3] = p_Yun2;
-
+	GridStencilAxis<4>::Nodes(_x_grid, x_case, _stochfac_x, cases.x_grid, cases.x_prop);
+	GridStencilAxis<4>::Nodes(_y_grid, y_case, _stochfac_x, cases.y_grid, cases.y_prop);
 }
 
 //---------------------------------------
 
+// SplitMix64 finalizer, a bijective 64 bit hash with good avalanche behaviour
+static inline unsigned long long SplitMix64(unsigned long long z)
+{
+	z += 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
 // generates pseudo-random number between 0 and 1 (uniform distribution)
-double Forward::Rand01(void)
+// Counter-based: the number is a hash of the seed, the stream (individual), the week and the draw, so a
+// simulation is reproducible independent of the number of threads and of the order of the individuals
+double Forward::Rand01(unsigned int stream, unsigned int year, unsigned int t, unsigned int draw)
 {
-	return((double) rand() / ((double) RAND_MAX + 1));
+	unsigned long long key     = ((unsigned long long)_mc_seed << 32) | stream;
+	unsigned long long counter = (((unsigned long long)year * _t_cnt + t) << 8) | draw;
+	unsigned long long z       = SplitMix64(SplitMix64(key) ^ counter);
+	return (double)(z >> 11) * (1.0 / 9007199254740992.0);
 }
 
 // Test wether double variable contains valid number (trap NaN)
@@ -509,23 +326,39 @@ void Forward::Init(Settings *settings)
 
 	InitStateFuncs(settings, _decision->GetTheta() );
 
-	_conv.fw_convergence = false;
+	_conv.fw_convergence    = false;
+	_conv.lambda_fw_average = 0.0;
 
 	_user_init_start_pop = settings->GetUserInitStartPop();  
 	_save_mortality_pattern_each_cycle = settings->GetSaveMortalityPatternEachCycle();
 	_save_final_mortality_pattern      = settings->GetSaveFinalMortalityPattern();
+	_track_mortality                   = _save_mortality_pattern_each_cycle || _save_final_mortality_pattern;
 	_n_fw                = settings->GetNFW();
 	_n_min_fw            = settings->GetNMinFW();
 	_start_week_fw       = settings->GetStartWeekFW();
 	_start_loc_fw        = settings->GetStartLocationFW();
+	_eigen_solver        = settings->GetForwardEigenSolver();
+	_batch_all_starts    = settings->GetForwardBatchAllStarts();
+	_low_cost_convergence = settings->GetForwardLowCostConvergence();
+	_low_cost_final_check = settings->GetForwardLowCostConvergenceFinalCheck();
+	_save_full_dynamics  = settings->GetForwardSavePopulationDynamics();
+	_save_marginals      = settings->GetForwardSaveMarginals() && !_eigen_solver && !_batch_all_starts;
+	_env_years           = settings->GetEnvYears();
+#ifdef SUPPORT_FW_MONTE_CARLO
+	_monte_carlo         = settings->GetForwardUsingMonteCarlo();
+	_cohortsize_fw       = settings->GetForwardMonteCarloStartCohortSize();
+	_l_fw                = settings->GetForwardMonteCarloAverageLambdaWindow();
+	_mc_seed             = settings->GetForwardMonteCarloSeed();
+	_mc_log              = settings->GetForwardMonteCarloSaveLifeHistory();
+#else
+	_monte_carlo         = false;
+	_mc_log              = false;
+#endif
 
 	_t_cnt             = settings->GetTCnt();
 	_n_brood           = settings->GetNBrood();
 	_gamma_nest        = settings->GetGammaNest();
 
-	_dx               = settings->GetDx();
-	_dy               = settings->GetDy();
-
 	_a_max            = settings->GetAMax();
 	_e_cnt            = settings->GetECnt();
 	_a_cnt            = settings->GetACnt();
@@ -539,17 +372,17 @@ void Forward::Init(Settings *settings)
 
 
 	_x_cnt            = settings->GetXCnt();
-	double x_min      = settings->GetXMin();
+	_x_grid.Init(settings->GetXMin(), settings->GetXMax(), settings->GetGridX(), settings->GetGridXRatio() );
 	_x_vec.resize(_x_cnt);
 	for (unsigned int x=0;x<_x_cnt;x++)
-		_x_vec[x] = x_min+ x*_dx;    
+		_x_vec[x] = _x_grid[x];
 	_x_indep          = settings->GetXindep();
 
 	_y_cnt            = settings->GetYCnt();
-	double y_min      = settings->GetYMin();
+	_y_grid.Init(settings->GetYMin(), settings->GetYMax(), settings->GetGridY(), settings->GetGridYRatio() );
 	_y_vec.resize(_y_cnt);
 	for (unsigned int y=0;y<_y_cnt;y++)
-		_y_vec[y] = y_min+ y*_dy;
+		_y_vec[y] = _y_grid[y];
 	_y_indep          = settings->GetYindep();
 
 
@@ -605,64 +438,494 @@ void Forward::Init(Settings *settings)
 //================================================================================================
 
 
+// Accumulates the growth of each occupied state for CalcLambdaAndConvergence(). The parallel
+// reduction keeps one instance per block and merges them in storage order, so the worst state 
+// is the first one of the largest deviation in storage order.
+struct FwLambdaAcc {
+	double crit;				// Convergence criterion
+	double lambda_worst;		// Lambda value with highest difference to optimal 1.0
+	double lambda_max_delta;	// Highest deviation against optimal lambda of 1
+	double lambda_sum;			// Sum of lambda over all state combinations
+	int    state_count;			// Count of state combinations used for average calcualtion
+	int    notconv_count;
+
+	FwLambdaAcc(double c) : crit(c), lambda_worst(1), lambda_max_delta(0), lambda_sum(0), state_count(0), notconv_count(0) {}
+
+	void operator()(const double &newVal, const double &oldVal, size_t) {
+		if (oldVal > 0) {
+			double lambda       = newVal / oldVal;
+			double lambda_delta = fabs(lambda - 1.0);
+			if (lambda_max_delta < lambda_delta) {
+				lambda_max_delta = lambda_delta;
+				lambda_worst     = lambda;
+			}
+			lambda_sum += lambda;
+			state_count++;
+			if (lambda_delta >= crit)
+				notconv_count++;
+		}
+	}
+
+	void Merge(const FwLambdaAcc &o) {
+		if (lambda_max_delta < o.lambda_max_delta) {
+			lambda_max_delta = o.lambda_max_delta;
+			lambda_worst     = o.lambda_worst;
+		}
+		lambda_sum    += o.lambda_sum;
+		state_count   += o.state_count;
+		notconv_count += o.notconv_count;
+	}
+};
+
 void Forward::CalcLambdaAndConvergence(NArray<double> &FW_props, NArray<double> &FW_old, FwConvResultStruct & result) {
 
-	double lambda_worst = 1;		// Lambda value with highest difference to optimal 1.0
-	double lambda_max_delta = 0;	// Highest deviation against optimal lambda of 1
-	double lambda_average = 0;		// Average lambda over all state combinations
-	int    state_count = 0;			// Count of state combinations used for average calcualtion
-	int    notconv_count = 0;
+	// All states in storage order, reduced in parallel blocks
+	FwLambdaAcc acc(_crit);
+	FW_props.ZipReduce(FW_old, acc);
 
-	for (unsigned int x=0;x<_x_cnt;x++) {
-		for (unsigned int y=0;y<_y_cnt;y++) {
-			for (unsigned int e=0;e<_e_cnt;e++) {
-				for (unsigned int a=0;a<_a_cnt;a++)	{
-					for (unsigned int o=0; o<_o_cnt; o++) {
-						for (unsigned int s=0; s<_s_cnt; s++) {
-							for (unsigned int t=0;t<_t_cnt;t++) 
-							{
-								double oldVal = FW_old(x,y,e,a,o,s,t);
-								double newVal = FW_props(x,y,e,a,o,s,t);
-
-								if (oldVal > 0)
-								{
-									double lambda = newVal / oldVal;
-
-									double lambda_delta = fabs(lambda - 1.0);
-									if (lambda_max_delta < lambda_delta) {
-										lambda_max_delta = lambda_delta;
-										lambda_worst = lambda;
-									}
+	result.lambda_fw_average = acc.lambda_sum / acc.state_count;
+    result.lambda_fw_worst   = acc.lambda_worst;
+	result.fw_notconv_count  = acc.notconv_count;
+	result.fw_state_count    = acc.state_count;
+	result.fw_convergence    = acc.lambda_max_delta < _crit;
+	
+	// For comparison (lambda calculated for particular state)
+	double oldVal     = FW_old(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+	double newVal     = FW_props(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+	result.lambda_fw_state  = (double) newVal/oldVal;;
+}
 
-									// Update average
-									lambda_average += lambda;
-									state_count++;
+// Low-cost variant based on the population totals of each week: lambda is the average growth of the 
+// weekly totals, which needs no division per state. The year is converged when the weekly growths agree 
+// with each other and lambda changed less than _crit against the previous year, which is the lambda 
+// still stored in result. The specific state is kept for comparison with CalcLambdaAndConvergence().
+void Forward::CalcLambdaAndConvergence_Toekoelyi(NArray<double> &FW_props, NArray<double> &FW_old, FwConvResultStruct & result) {
 
-									if (lambda_delta >= _crit) 
-									{
-										notconv_count++;
-									}
+	double lambda_prev    = result.lambda_fw_average;
+	double lambda_average = 0;
+	double lambda_min     = 0;
+	double lambda_max     = 0;
+	double lambda_worst   = 1;
+	int    week_count     = 0;
+
+	for (unsigned int t=0;t<_t_cnt;t++) 
+	{
+		double total_new = FW_props.Slice(6, t).Sum();
+		double total_old = FW_old.Slice(6, t).Sum();
+		if (total_old > 0) {
+			double lambda = total_new / total_old;
+			if (week_count == 0 || lambda < lambda_min)
+				lambda_min = lambda;
+			if (week_count == 0 || lambda > lambda_max)
+				lambda_max = lambda;
+			if (fabs(lambda - 1.0) > fabs(lambda_worst - 1.0))
+				lambda_worst = lambda;
+			lambda_average += lambda;
+			week_count++;
+		}
+	}
+	if (week_count > 0)
+		lambda_average = lambda_average / week_count;
+
+	result.lambda_fw_average = lambda_average;
+	result.lambda_fw_worst   = lambda_worst;
+	result.fw_notconv_count  = (lambda_max - lambda_min < _crit) ? 0 : week_count;
+	result.fw_state_count    = week_count;
+	result.fw_convergence    = week_count == (int)_t_cnt && lambda_max - lambda_min < _crit && fabs(lambda_average - lambda_prev) < _crit;
+
+	// For comparison (lambda calculated for particular state)
+	double oldVal     = FW_old(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+	double newVal     = FW_props(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
+	result.lambda_fw_state  = (double) newVal/oldVal;
+}
+
+// ------------------------------------------------------------------------------------------------
+// Sparse weekly transition operators
+// ------------------------------------------------------------------------------------------------
+
+// The operators of all weeks are built at once unless their estimated memory exceeds FW_OPERATOR_MAX_MB,
+// then only the operator of the week currently projected is held, see WeekOperator()
+void Forward::BuildWeekOperators() {
+
+	_slice_size = _x_cnt*_y_cnt*_e_cnt*_a_cnt*_o_cnt*_s_cnt;
+	Stoch_HMcN(_x_indep, _y_indep, _indep_cases);
+	_marker.assign(_slice_size, 0);
+
+	_week_op.clear();
+	_week_op.resize(_t_cnt);
+	_op_week = -1;
+
+	// Upper bound: each state with reserves reaches at most 2*_xi_max*_yi_max states of week t+1, each
+	// entry is held in both forms (2 x 12 bytes), each state adds 33 bytes of offsets, mortality and action
+	double entries = (double)(_slice_size - _slice_size/_x_cnt) * 2*_xi_max*_yi_max;
+	double mb      = _t_cnt * (entries*24.0 + _slice_size*33.0) / (1024.0*1024.0);
+	_op_on_demand  = mb > FW_OPERATOR_MAX_MB;
+	printf("Forward week operators: at most %.1f MB for %u weeks%s\n", mb, _t_cnt, _op_on_demand ? ", built week by week" : "");
+
+	if (_op_on_demand)
+		return;
+
+	// The weeks are independent, each thread builds complete operators
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int t=0;t<(int)_t_cnt;t++) {
+		BuildWeekOperator(t);
+	}
+}
+
+// Returns the operator of week t, in the on-demand mode it replaces the operator of the previous week
+Forward::FwWeekOperatorStruct & Forward::WeekOperator(unsigned int t) {
+
+	if (_op_on_demand && _op_week != (int)t) {
+		if (_op_week >= 0)
+			_week_op[_op_week] = FwWeekOperatorStruct();
+		BuildWeekOperator(t);
+		_op_week = t;
+	}
+	return _week_op[t];
+}
+
+void Forward::BuildWeekOperator(unsigned int t) {
+
+	FwWeekOperatorStruct &op = _week_op[t];
+
+	FwStochXYPropResultStruct cases;
+	NArrayFixed<double,7> f_u(_decision->GetF_uView());
+	NArrayFixed<char,7>   f_strat(_decision->GetF_stratView());
+	unsigned int e_dst[2];
+	double       p_dst[2] = { _p_exp, 1-_p_exp };
+
+	op.col_start.assign(_slice_size+1, 0);
+	op.die_pred.assign(_slice_size, 0.0);
+	op.die_dis.assign(_slice_size, 0.0);
+	op.starve.assign(_slice_size, 0.0);
+	op.action.assign(_slice_size, FW_ACTION_NONE);
+	op.dst.clear();
+	op.weight.clear();
+
+	// Sources in the NArray order, states with x=0 have no transitions
+	for (unsigned int s=0;s<_s_cnt;s++) {
+		for (unsigned int o=0;o<_o_cnt;o++) {
+			for (unsigned int a=0;a<_a_cnt;a++) {
+				for (unsigned int e=0;e<_e_cnt;e++) {
+					for (unsigned int y=0;y<_y_cnt;y++) {
+						for (unsigned int x=0;x<_x_cnt;x++) {
+
+							size_t       src = StateIndex(x,y,e,a,o,s);
+							op.col_start[src] = op.dst.size();
+							if (x == 0)
+								continue;
+
+							// optimal foraging intensity and optimal strategy
+							double u_opt = f_u(x, y, e, a, o, s, t);
+							char   strat = f_strat(x, y, e, a, o, s, t);
+
+							// predation related mortality - note that this mortality acts only on strategies != migrate
+							double die_pred = (strat!='m') ? M(o,u_opt,_x_vec[x],_x_max) : M_mig(_x_vec[x]);
+							// disease related mortality
+							double die_dis  = D(_y_vec[y]);
+
+							// destination a, o and s of the strategy 
+							// 'p' marks a state skipped by the backward reachable-state pruning, 
+							// it is never reached from the starting cohort but is handled like 'no care'
+							unsigned int a_next = 0, o_next = o, s_next = s;
+							switch (strat) {
+							case 's':
+								Stoch_HMcN(X_s(_x_vec[x], e, a, o, u_opt, t), Y_s(_x_vec[x],_y_vec[y], u_opt, t), cases);
+								a_next = 1;
+								op.action[src] = FW_ACTION_START;
+								break;
+							case 'c':
+								Stoch_HMcN(X_c(_x_vec[x], e, a, o, u_opt, t), Y_ns(_x_vec[x], _y_vec[y], u_opt, t), cases);
+								a_next = a+1;
+								op.action[src] = FW_ACTION_CARE;
+								break;
+							case 'm':
+								op.action[src] = FW_ACTION_MIGRATE;
+								Stoch_HMcN(X_m(_x_vec[x], e, 0, o, s, u_opt, t), Y_m(_x_vec[x], _y_vec[y], e, o, s, u_opt, t), cases);
+								if (s < (_s_cnt-1)) {
+									s_next = s+1;
+								} else {    // last week of migration -> at other location and not migrating anymore in next week
+									o_next = (o+1)%_o_cnt;
+									s_next = 0;
 								}
+								break;
+							default:
+								Stoch_HMcN(X_nc(_x_vec[x], e, a, o, u_opt, t), Y_ns(_x_vec[x],_y_vec[y], u_opt, t), cases);
+								op.action[src] = FW_ACTION_NO_CARE;
+								break;
 							}
-						}
+
+							// note that mortality due to depletion of reserves or condition is modelled implicitly and can be extracted from the x=0 and y=0 columns of FW_props
+							double survive = (1-die_pred) * (1-die_dis);
+							double starve  = 0;
+
+							e_dst[0] = Chop(e+1,0,(_e_cnt-1));
+							e_dst[1] = e;
+
+							unsigned int first = op.dst.size();
+							for (unsigned int xi=0; xi<_xi_max; xi++) {
+								for (unsigned int yi=0; yi<_yi_max; yi++) {
+									for (unsigned int k=0; k<2; k++) {
+										unsigned int dst = (unsigned int)StateIndex(cases.x_grid[xi],cases.y_grid[yi],e_dst[k],a_next,o_next,s_next);
+										double       w   = cases.x_prop[xi] * cases.y_prop[yi] * survive * p_dst[k];
+
+										// clamped grid cases and the last experience class share destinations
+										unsigned int i = first;
+										while (i < op.dst.size() && op.dst[i] != dst)
+											i++;
+										if (i < op.dst.size()) {
+											op.weight[i] += w;
+										} else {
+											op.dst.push_back(dst);
+											op.weight.push_back(w);
+										}
+									}
+									if (cases.x_grid[xi] <= 0) {
+										starve += cases.x_prop[xi] * survive;
+									}
+								}}
+
+							op.die_pred[src] = die_pred;
+							op.die_dis[src]  = die_dis;
+							op.starve[src]   = starve;
+
+						}}}}}} // end loop over states
+	op.col_start[_slice_size] = op.dst.size();
+
+	// Rows by a counting sort over the destinations, which keeps the sources of each row in increasing order
+	unsigned int nnz = op.dst.size();
+	op.row_start.assign(_slice_size+1, 0);
+	for (unsigned int i=0;i<nnz;i++)
+		op.row_start[op.dst[i]+1]++;
+	for (size_t r=0;r<_slice_size;r++)
+		op.row_start[r+1] += op.row_start[r];
+
+	std::vector<unsigned int> next(op.row_start.begin(), op.row_start.end()-1);
+	op.src.resize(nnz);
+	op.row_weight.resize(nnz);
+	for (size_t c=0;c<_slice_size;c++) {
+		for (unsigned int i=op.col_start[c];i<op.col_start[c+1];i++) {
+			unsigned int pos = next[op.dst[i]]++;
+			op.src[pos]        = (unsigned int)c;
+			op.row_weight[pos] = op.weight[i];
+		}
+	}
+}
+
+// Parents in the last week of care release _n_brood independent young each
+void Forward::AddIndependentBrood(NArray<double> &FW_props, unsigned int t) {
+
+	NArrayFixed<double,7> props(FW_props);
+
+	for (unsigned int x=1;x<_x_cnt;x++) {
+		// for (unsigned int y=1;y<_y_cnt;y++) {  // original
+		for (unsigned int y=0;y<_y_cnt;y++) {
+			for (unsigned int e=0;e<_e_cnt;e++) {
+				for (unsigned int o=0;o<_o_cnt;o++) {
+
+					// signed values keep the step linear for the Krylov vectors of the eigen solver
+					double parents = props(x,y,e,_a_cnt-1,o,0,t);
+					if (parents != 0.0) {
+						for (unsigned int xi=0; xi<_xi_max; xi++) {
+							for (unsigned int yi=0; yi<_yi_max; yi++) {
+								props(_indep_cases.x_grid[xi],_indep_cases.y_grid[yi],0,0,o,0,t) += _n_brood * parents * _indep_cases.x_prop[xi] * _indep_cases.y_prop[yi];
+							}}
 					}
+				}}}}
+}
+
+// Propagates week t to week t+1 and stores the mortality components of week t if they are tracked
+void Forward::ApplyWeekOperator(NArray<double> &FW_props, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t) {
+
+	FwWeekOperatorStruct &op = WeekOperator(t);
+	unsigned int t_next = (t+1)%_t_cnt;
+
+	// the weeks are the outermost dimension, so both slices are contiguous
+	NArrayView<double> next_week = FW_props.Slice(6, t_next);
+	const double *curr = FW_props.Slice(6, t).GetData();
+	double       *next = next_week.GetData();
+
+#ifdef _OPENMP
+	unsigned int threads = omp_get_max_threads();
+#else
+	unsigned int threads = 1;
+#endif
+
+	// Occupied states of week t: the list of the scatter that wrote the week, completed by the
+	// independent young added since, otherwise the week is scanned
+	std::map<const double*, std::vector<unsigned int> >::iterator known = _occupied.find(curr);
+	if (known != _occupied.end()) {
+		_active.swap(known->second);
+		unsigned int listed = _active.size();
+		for (unsigned int o=0;o<_o_cnt;o++) {
+			for (unsigned int xi=0; xi<_xi_max; xi++) {
+				for (unsigned int yi=0; yi<_yi_max; yi++) {
+					size_t r = StateIndex(_indep_cases.x_grid[xi],_indep_cases.y_grid[yi],0,0,o,0);
+					if (curr[r] != 0.0 && !std::binary_search(_active.begin(), _active.begin()+listed, r) &&
+						std::find(_active.begin()+listed, _active.end(), r) == _active.end())
+						_active.push_back(r);
+				}}
+		}
+		std::sort(_active.begin()+listed, _active.end());
+		std::inplace_merge(_active.begin(), _active.begin()+listed, _active.end());
+	}
+	else {
+		_active.clear();
+		for (size_t r=0;r<_slice_size;r++) {
+			if (curr[r] != 0.0)
+				_active.push_back(r);
+		}
+	}
+
+	// Both variants add the contributions to a state of week t+1 in increasing source order, 
+	// so the result is bitwise identical for any occupancy and any number of threads
+	if (_active.size() * threads < _slice_size) {
+		// few occupied states: clear the states of week t+1 occupied before (all if unknown), 
+		// then scatter each occupied state and list the states it reaches
+		known = _occupied.find(next);
+		if (known != _occupied.end()) {
+			for (unsigned int k=0;k<known->second.size();k++)
+				next[known->second[k]] = 0.0;
+		} else {
+			next_week.Zero();
+		}
+
+		std::vector<unsigned int> &reached = _occupied[next];
+		reached.clear();
+		for (unsigned int k=0;k<_active.size();k++) {
+			unsigned int c = _active[k];
+			double       p = curr[c];
+			for (unsigned int i=op.col_start[c];i<op.col_start[c+1];i++) {
+				unsigned int d = op.dst[i];
+				if (!_marker[d]) {
+					_marker[d] = 1;
+					reached.push_back(d);
 				}
+				next[d] += p * op.weight[i];
 			}
 		}
+		std::sort(reached.begin(), reached.end());
+		for (unsigned int k=0;k<reached.size();k++)
+			_marker[reached[k]] = 0;
+
+		// keep the list of week t, its slice is cleared when it is written again
+		_occupied[curr] = _active;
+	} else {
+		// each state of week t+1 gathers its sources
+#ifdef _OPENMP
+		#pragma omp parallel for schedule(static)
+#endif
+		for (int r=0;r<(int)_slice_size;r++) {
+			double sum = 0.0;
+			for (unsigned int i=op.row_start[r];i<op.row_start[r+1];i++)
+				sum += curr[op.src[i]] * op.row_weight[i];
+			next[r] = sum;
+		}
+
+		// dense weeks are not listed, they are scanned and cleared as a whole
+		_occupied.erase(curr);
+		_occupied.erase(next);
 	}
 
-	lambda_average = lambda_average / state_count;
+	if (_save_marginals)
+		AccumulateMarginals(curr, t);
 
-	result.lambda_fw_average = lambda_average;
-    result.lambda_fw_worst   = lambda_worst;
-	result.fw_notconv_count  = notconv_count;
-	result.fw_state_count    = state_count;
-	result.fw_convergence    = lambda_max_delta < _crit;
-	
-	// For comparison (lambda calculated for particular state)
-	double oldVal     = FW_old(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
-	double newVal     = FW_props(_x_cnt-1,_y_cnt-1,_e_cnt-1,0,0,0,_t_cnt-1);
-	result.lambda_fw_state  = (double) newVal/oldVal;;
+	// mortality components are only allocated when they are saved
+	if (!_track_mortality)
+		return;
+
+	// reset t+1 mortality values to zero
+	FW_predation.Slice(6, t_next).Zero();
+	FW_disease.Slice(6, t_next).Zero();
+	FW_starvation.Slice(6, t_next).Zero();
+
+	double *pred  = FW_predation.Slice(6, t).GetData();
+	double *dis   = FW_disease.Slice(6, t).GetData();
+	double *starv = FW_starvation.Slice(6, t).GetData();
+	for (unsigned int k=0;k<_active.size();k++) {
+		unsigned int r = _active[k];
+		if (curr[r] > 0.0) {
+			pred[r]  = curr[r] * op.die_pred[r];
+			dis[r]   = curr[r] * op.die_dis[r];
+			starv[r] = curr[r] * op.starve[r];
+		}
+	}
+}
+
+// Adds the occupied states of week t to the marginal summaries, the population of a week is counted 
+// after the independent young were added, states with depleted reserves only count for the reserves and health
+void Forward::AccumulateMarginals(const double *curr, unsigned int t) {
+
+	const std::vector<unsigned char> &action = WeekOperator(t).action;
+	double *occ    = _marg_occupancy.GetData() + t*FW_ACTION_CNT*_o_cnt;
+	double *res    = _marg_reserves.GetData()  + t*_x_cnt;
+	double *health = _marg_health.GetData()    + t*_y_cnt;
+	unsigned int xyea_cnt = _x_cnt*_y_cnt*_e_cnt*_a_cnt;
+
+	for (unsigned int k=0;k<_active.size();k++) {
+		unsigned int r = _active[k];
+		double       p = curr[r];
+
+		res[r % _x_cnt]               += p;
+		health[(r / _x_cnt) % _y_cnt] += p;
+		if (action[r] != FW_ACTION_NONE)
+			occ[action[r] + FW_ACTION_CNT*((r / xyea_cnt) % _o_cnt)] += p;
+	}
+}
+
+// Appends the marginal summaries of a year to the file: year, occupancy, reserves and health
+void Forward::SaveMarginals(FILE *file, unsigned int year) {
+
+	fwrite(&year,1,sizeof(unsigned int), file);
+	_marg_occupancy.SaveBinary(file);
+	_marg_reserves.SaveBinary(file);
+	_marg_health.SaveBinary(file);
+}
+
+// Propagates the weeks t_start.._t_cnt-1 of a year, the last week writes week 0 of the next year
+void Forward::ProjectWeeks(NArray<double> &FW_props, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t_start) {
+
+	for (unsigned int t=t_start;t<_t_cnt;t++) {
+
+		// add newly independent brood
+		AddIndependentBrood(FW_props, t);
+
+		// optimal behaviour
+		ApplyWeekOperator(FW_props, FW_predation, FW_disease, FW_starvation, t);
+
+	} // end loop over weeks
+}
+
+// The policy of each year of the horizon is read back in the order of the forward run, so only 
+// one year of the decision is held in memory
+bool Forward::LoadHorizonYear(Settings *settings, unsigned int year) {
+
+	char filename[FILENAME_MAX];
+	sprintf_s(filename, DC_HORIZON_POLICY_FILE, settings->GetFilePrefix(), year);
+	if (!_decision->LoadPolicyFromFile(filename) )
+		return false;
+
+	SetEnvYear(year);
+	BuildWeekOperators();
+	return true;
+}
+
+// Starts the next year of the double buffer: FW_old takes the finished year without copying and 
+// FW_props only needs week t_start, the following weeks and week 0 are rewritten by ProjectWeeks()
+void Forward::SwapYearBuffers(NArray<double> &FW_props, NArray<double> &FW_old, unsigned int t_start) {
+
+	FW_old.Swap(FW_props);
+	FW_props.Slice(6, t_start).CopyFrom(FW_old.Slice(6, t_start));
+
+	// the copied week has the occupied states of its source
+	const double *src = FW_old.Slice(6, t_start).GetData();
+	const double *dst = FW_props.Slice(6, t_start).GetData();
+	if (_occupied.count(src))
+		_occupied[dst] = _occupied[src];
+	else
+		_occupied.erase(dst);
 }
 
 // ------------------------------------------------------------------------------------------------
@@ -683,17 +946,30 @@ double Forward::ComputePopulationDynamics(Settings *settings) {
 	// prepare parameters
 	Init(settings);
 
+	// the decision is fixed during the forward run, prepare the weekly transitions once
+	BuildWeekOperators();
+
+	if (_monte_carlo) {
+		return ComputeMonteCarlo(settings);
+	}
+
+	if (_batch_all_starts) {
+		return ComputeBatch();
+	}
+
 
 	//---------------------------------------
 	// allocate state array for storing proportions
 
-	NArray<double> FW_props_renorm, FW_props, FW_old, FW_predation, FW_disease, FW_starvation;
-	FW_props.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+	// The results are computed in place in the member arrays, FW_old is the second buffer 
+	// holding the previous year, see SwapYearBuffers()
+	NArray<double> FW_old;
 	FW_old.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
-	FW_props_renorm.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
-	FW_predation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
-	FW_disease.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
-	FW_starvation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+	if (_track_mortality) {
+		_FW_predation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+		_FW_disease.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+		_FW_starvation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+	}
 
 	double lambda=0.0;
 	bool convergence=false;
@@ -709,18 +985,24 @@ double Forward::ComputePopulationDynamics(Settings *settings) {
 			printf("Error loading forward results");
 			exit(-1);
 		}
+		else if (_FW_props.GetSize() != FW_old.GetSize()) {
+			printf("Error: Forward start population in %s does not match the state space\n", _filename_fw_pd);
+			exit(-1);
+		}
 		else {			
 			printf("Forward::ComputePopulationDynamics() loaded initial start population from file\n");
-			FW_props = _FW_props;
 		}
 	}	
 	else {
+		_FW_props.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
 		for (unsigned int xi=0; xi<_xi_max; xi++) {
 			for (unsigned int yi=0; yi<_yi_max; yi++) {
-				FW_props(cases.x_grid[xi],cases.y_grid[yi],0,0,_start_loc_fw-1,0,_start_week_fw) += cases.x_prop[xi]*cases.y_prop[yi];
+				_FW_props(cases.x_grid[xi],cases.y_grid[yi],0,0,_start_loc_fw-1,0,_start_week_fw) += cases.x_prop[xi]*cases.y_prop[yi];
 			}}
 
 	} 
+	// the occupied states of earlier runs belong to released arrays
+	_occupied.clear();
 	//-------------------------------------------
 	printf("\n");
 
@@ -735,226 +1017,1110 @@ double Forward::ComputePopulationDynamics(Settings *settings) {
 
 	bool errorInSimulation = false; // Quick exit of loops due to 'no more living' or 'exponential growth'
 
-	while ((!convergence && year<_n_fw) || year<_n_min_fw)
-	{	
-		FW_old = FW_props;
+	if (_eigen_solver) {
+		return ComputeStableDistribution(settings, _FW_props, FW_old, _FW_predation, _FW_disease, _FW_starvation, t_start_week);
+	}
 
-		for (unsigned int t=t_start_week;t<_t_cnt;t++) {
+	// marginal summaries are appended year by year
+	FILE *marg_file = 0;
+	if (_save_marginals) {
+		sprintf_s(_filename_fw_marg, "%s_marginals_FW.bin", settings->GetFilePrefixFW());
+		marg_file = fopen(_filename_fw_marg,"wb");
+		if (marg_file==0) {
+			printf("Forward::ComputePopulationDynamics() error opening %s for writing\n",_filename_fw_marg);
+		}
+	}
 
-				// reset t+1 values to zero 
-				for (unsigned int x=0;x<_x_cnt;x++) {
-					for (unsigned int y=0;y<_y_cnt;y++) {
-						for (unsigned int e=0;e<_e_cnt;e++) {
-							for (unsigned int a=0;a<_a_cnt;a++) {
-								for (unsigned int o=0;o<_o_cnt;o++) {
-									for (unsigned int s=0;s<_s_cnt;s++) {
-										FW_props(x,y,e,a,o,s,(t+1)%_t_cnt)      = 0.0;
-										FW_predation(x,y,e,a,o,s,(t+1)%_t_cnt)  = 0.0;
-										FW_disease(x,y,e,a,o,s,(t+1)%_t_cnt)    = 0.0;
-										FW_starvation(x,y,e,a,o,s,(t+1)%_t_cnt) = 0.0;
-									}}}}}}
-
-
-				//------------------------------------------------
-				// add newly independent brood
-
-				for (unsigned int x=1;x<_x_cnt;x++) {
-					// for (unsigned int y=1;y<_y_cnt;y++) {  // original
-					for (unsigned int y=0;y<_y_cnt;y++) {
-						for (unsigned int e=0;e<_e_cnt;e++) {
-							for (unsigned int o=0;o<_o_cnt;o++) {
+	// The horizon runs each year of the food supply series once, without checking convergence
+	bool horizon = _env_years > 1;
 
-								if (FW_props(x,y,e,_a_cnt-1,o,0,t) > 0.0) {
+	while (horizon ? year<_env_years : ((!convergence && year<_n_fw) || year<_n_min_fw))
+	{	
+		if (horizon && !LoadHorizonYear(settings, year)) {
+			errorInSimulation = true;
+			break;
+		}
 
-									Stoch_HMcN(_x_indep, _y_indep, cases);
+		SwapYearBuffers(_FW_props, FW_old, t_start_week);
 
-									for (unsigned int xi=0; xi<_xi_max; xi++) {
-										for (unsigned int yi=0; yi<_yi_max; yi++) {
-											FW_props(cases.x_grid[xi],cases.y_grid[yi],0,0,o,0,t) += _n_brood * FW_props(x,y,e,_a_cnt-1,o,0,t) * cases.x_prop[xi] * cases.y_prop[yi];
-										}}
+		if (_save_marginals) {
+			_marg_occupancy.Init(FW_ACTION_CNT, _o_cnt, _t_cnt);
+			_marg_reserves.Init(_x_cnt, _t_cnt);
+			_marg_health.Init(_y_cnt, _t_cnt);
+		}
 
-								}}}}}
+		ProjectWeeks(_FW_props, _FW_predation, _FW_disease, _FW_starvation, t_start_week);
 
+		if (marg_file) {
+			SaveMarginals(marg_file, year);
+		}
 
-				//------------------------------------------------
-				// optimal behaviour
-				for (unsigned int x=1;x<_x_cnt;x++) {
-					// for (unsigned int y=1;y<_y_cnt;y++) {  // original
-					for (unsigned int y=0;y<_y_cnt;y++) {
-						for (unsigned int e=0;e<_e_cnt;e++) {
-							for (unsigned int a=0;a<_a_cnt;a++) {
-								for (unsigned int o=0;o<_o_cnt;o++) {
-									for (unsigned int s=0;s<_s_cnt;s++) {
+		// The years following the first one (which starts at t_start_week) will start at week zero:
+		t_start_week = 0;
 
-										if (FW_props(x,y,e,a,o,s,t) > 0.0) {
+		// calculate lambda & check convergence
 
-											// optimal foraging intensity and optimal strategy
-											double u_opt = _decision->GetF_u(x, y, e, a, o, s, t);
-											char   strat = _decision->GetF_strat(x, y, e, a, o, s, t);
+		if (_low_cost_convergence)
+			CalcLambdaAndConvergence_Toekoelyi(_FW_props, FW_old, _conv);
+		else
+			CalcLambdaAndConvergence(_FW_props, FW_old, _conv);
 
-											double die_pred, die_dis;
-											// predation related mortality - note that this mortality acts only on strategies != migrate
-											if (strat!='m') {
-												die_pred = M(o,u_opt,_x_vec[x],_x_max);
-											}
-											else die_pred = M_mig(_x_vec[x]); //die_pred = _m_migr;
-											// disease related mortality
-											die_dis = D(_y_vec[y]);
-											
-											FW_predation(x,y,e,a,o,s,t) = FW_props(x,y,e,a,o,s,t) * die_pred;
-											FW_disease(x,y,e,a,o,s,t) = FW_props(x,y,e,a,o,s,t) * die_dis;
+		lambda       = _conv.lambda_fw_average;
+		convergence  = _conv.fw_convergence;
+		lambda_state = _conv.lambda_fw_state;
+		if (convergence) {
+			_conv.fw_year_conv = year;
+		}			
 
-											// note that mortality due to depletion of reserves or condition is modelled implicitly and can be extracted from the x=0 and y=0 columns of FW_props
+//		printf("=========== Forward iteration %2d done,  Lambda Fwd = %.4f\n\n", year, lambda_state);		
 
-											//---------------------------------------
-											// no care
+		printf("=========== Forward iteration %2d  done ===========\n",year);	 
+		printf("........... Lambda:  average = %f   specific state = %f\n",_conv.lambda_fw_average,_conv.lambda_fw_state);
+		printf("........... Lambda:  worst   = %f   not converged %d of %d \n", _conv.lambda_fw_worst,_conv.fw_notconv_count,_conv.fw_state_count );
+		printf("\n");
 
-											if (strat == 'n') {
-												Stoch_HMcN(X_nc(_x_vec[x], e, a, o, u_opt, t), Y_ns(_x_vec[x],_y_vec[y], u_opt, t), cases);
+		if (_user_init_start_pop && _save_full_dynamics) {
+			sprintf_s(_filename_fw_pd_year , "%s_populationdynamics_FW_%2d.bin", settings->GetFilePrefixFW(),year);
+			SavePopulationDynamics(_filename_fw_pd_year);
+		}
+		
+		if (_save_mortality_pattern_each_cycle) {
+			sprintf_s(_filename_fw_mp_year , "%s_mortality_FW_%2d.bin", settings->GetFilePrefixFW(),year);
+			SaveMortalityPatterns(_filename_fw_mp_year);
+		}
 
-												for (unsigned int xi=0; xi<_xi_max; xi++) {
-													for (unsigned int yi=0; yi<_yi_max; yi++) {
+		dlambda_fw    = fabs(lambda-lambda_old_fw);
+		lambda_old_fw = lambda;
+		year++;
 
-														FW_props(cases.x_grid[xi],cases.y_grid[yi],Chop(e+1,0,(_e_cnt-1)),0,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * _p_exp;                      
-														FW_props(cases.x_grid[xi],cases.y_grid[yi],e,0,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * (1-_p_exp);
-														
-														if (cases.x_grid[xi] <= 0) {
-															FW_starvation(x,y,e,a,o,s,t) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * (1-die_pred) * (1-die_dis);
-														}
-													}}
+		// } // end loop over years
+	} // end while loop over years and dlambda    
 
-											}  else // end loop over no_care
+	if (marg_file) {
+		fclose(marg_file);
+	}
 
-												//---------------------------------------
-												//  start brood
+	if (errorInSimulation) {
+		printf("Error: Forward horizon stopped in year %d\n", year);
+	}
 
-												if (strat == 's') {
-													Stoch_HMcN(X_s(_x_vec[x], e, a, o, u_opt, t), Y_s(_x_vec[x],_y_vec[y], u_opt, t), cases);
+	// the low-cost check only looked at the weekly totals, check the states once for the final year
+	if (_low_cost_convergence && _low_cost_final_check && year > 0) {
+		FwConvResultStruct full;
+		CalcLambdaAndConvergence(_FW_props, FW_old, full);
+		_conv.lambda_fw_worst  = full.lambda_fw_worst;
+		_conv.fw_notconv_count = full.fw_notconv_count;
+		_conv.fw_state_count   = full.fw_state_count;
+
+		printf("=========== Forward final check of all states ===========\n");
+		printf("........... Lambda:  average = %f   specific state = %f\n",full.lambda_fw_average,full.lambda_fw_state);
+		printf("........... Lambda:  worst   = %f   not converged %d of %d \n", full.lambda_fw_worst,full.fw_notconv_count,full.fw_state_count );
+		printf("\n");
+	}
 
-													for (unsigned int xi=0; xi<_xi_max; xi++) {
-														for (unsigned int yi=0; yi<_yi_max; yi++) {
+	return (lambda);
 
-															FW_props(cases.x_grid[xi],cases.y_grid[yi],Chop(e+1,0,(_e_cnt-1)),1,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * _p_exp;
-															FW_props(cases.x_grid[xi],cases.y_grid[yi],e,1,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * (1-_p_exp);
-															
-															if (cases.x_grid[xi] <= 0) {
-																FW_starvation(x,y,e,a,o,s,t) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * (1-die_pred) * (1-die_dis);
-															}
-															
-														}}
+}
 
-												} else // end loop over start brood
 
-													//---------------------------------------
-													//  care for brood
+// ------------------------------------------------------------------------------------------------
+// Dominant eigenpair of the annual projection
+// ------------------------------------------------------------------------------------------------
 
-													if (strat == 'c') {
+// Householder reflector P = I - beta v v^T with v[0]=1 that maps x[0..len-1] to a multiple of the first unit vector
+static void FwHouseholder(const double *x, int len, double *v, double &beta) {
+	double norm = 0.0;
+	for (int i=0;i<len;i++)
+		norm += x[i]*x[i];
+	norm = sqrt(norm);
+
+	v[0] = 1.0;
+	if (norm == 0.0) {
+		for (int i=1;i<len;i++)
+			v[i] = 0.0;
+		beta = 0.0;
+		return;
+	}
+	// the sign avoids cancellation in x[0]+sigma
+	double sigma = (x[0] >= 0.0) ? norm : -norm;
+	double head  = x[0] + sigma;
+	for (int i=1;i<len;i++)
+		v[i] = x[i] / head;
+	beta = head / sigma;
+}
 
-														Stoch_HMcN(X_c(_x_vec[x], e, a, o, u_opt, t), Y_ns(_x_vec[x], _y_vec[y], u_opt, t), cases);
+// Applies the reflector of FwHouseholder() from the left to the rows row..row+len-1, columns c0..c1 of h
+static void FwReflectRows(NArray<double> &h, const double *v, double beta, int len, int row, int c0, int c1) {
+	for (int c=c0;c<=c1;c++) {
+		double dot = 0.0;
+		for (int i=0;i<len;i++)
+			dot += v[i] * h(row+i,c);
+		dot *= beta;
+		for (int i=0;i<len;i++)
+			h(row+i,c) -= dot * v[i];
+	}
+}
 
-														for (unsigned int xi=0; xi<_xi_max; xi++) {
-															for (unsigned int yi=0; yi<_yi_max; yi++) {
+// Applies the reflector of FwHouseholder() from the right to the columns col..col+len-1, rows r0..r1 of h
+static void FwReflectCols(NArray<double> &h, const double *v, double beta, int len, int col, int r0, int r1) {
+	for (int r=r0;r<=r1;r++) {
+		double dot = 0.0;
+		for (int i=0;i<len;i++)
+			dot += h(r,col+i) * v[i];
+		dot *= beta;
+		for (int i=0;i<len;i++)
+			h(r,col+i) -= dot * v[i];
+	}
+}
 
-																FW_props(cases.x_grid[xi],cases.y_grid[yi],Chop(e+1,0,(_e_cnt-1)),a+1,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * _p_exp;
+// Eigenvalues re1 +- i*im1 and re2 + i*im2 of the 2x2 matrix [a b; c d]
+static void FwEigenvalues2x2(double a, double b, double c, double d, double &re1, double &im1, double &re2, double &im2) {
+	double half = 0.5 * (a-d);
+	double disc = half*half + b*c;
+	if (disc >= 0.0) {
+		// real pair, the larger root first and the smaller one from the product to avoid cancellation
+		double root = half + ((half >= 0.0) ? sqrt(disc) : -sqrt(disc));
+		re1 = d + root;
+		re2 = (root != 0.0) ? d - b*c/root : d;
+		im1 = im2 = 0.0;
+	} else {
+		re1 = re2 = d + half;
+		im1 = sqrt(-disc);
+		im2 = -im1;
+	}
+}
 
-																FW_props(cases.x_grid[xi],cases.y_grid[yi],e,a+1,o,s,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * (1-_p_exp);
+// Eigenvalues wr + i*wi of the upper Hessenberg matrix h(0..n-1,0..n-1), h is destroyed.
+//
+// Implicit double-shift QR iteration after Francis, following the description of the Francis QR
+// step in G.H. Golub, C.F. Van Loan: Matrix Computations, section 7.5. Only the eigenvalues are 
+// needed, so the reflectors are applied to the unreduced diagonal block lo..hi only, the blocks
+// above lo are decoupled by the zero subdiagonal element h(lo,lo-1). 
+// Returns FALSE if a block did not split within FW_QR_MAX_STEPS steps.
+bool Forward::HessenbergEigenvalues(NArray<double> &h, int n, std::vector<double> &wr, std::vector<double> &wi) {
+
+	wr.assign(n, 0.0);
+	wi.assign(n, 0.0);
+
+	// fallback scale of the deflation test for zero diagonal elements
+	double h_norm = 0.0;
+	for (int r=0;r<n;r++)
+		for (int c=(r>0 ? r-1 : 0);c<n;c++)
+			h_norm += fabs(h(r,c));
+
+	int hi    = n-1;
+	int steps = 0;
+	while (hi >= 0) {
+
+		// the unreduced block lo..hi ends at the last negligible subdiagonal element
+		int lo = hi;
+		while (lo > 0) {
+			double scale = fabs(h(lo-1,lo-1)) + fabs(h(lo,lo));
+			if (scale == 0.0)
+				scale = h_norm;
+			if (fabs(h(lo,lo-1)) <= DBL_EPSILON * scale) {
+				h(lo,lo-1) = 0.0;
+				break;
+			}
+			lo--;
+		}
 
-																if (cases.x_grid[xi] <= 0) {
-																	FW_starvation(x,y,e,a,o,s,t) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * (1-die_pred) * (1-die_dis);
-																}
-																
-															}}
+		if (lo == hi) {
+			wr[hi] = h(hi,hi);
+			wi[hi] = 0.0;
+			hi--;
+			steps = 0;
+			continue;
+		}
+		if (lo == hi-1) {
+			FwEigenvalues2x2(h(lo,lo), h(lo,hi), h(hi,lo), h(hi,hi), wr[lo], wi[lo], wr[hi], wi[hi]);
+			hi -= 2;
+			steps = 0;
+			continue;
+		}
+		if (steps == FW_QR_MAX_STEPS)
+			return false;
+		steps++;
+
+		// the two shifts are the eigenvalues of the trailing 2x2 block, given by their sum and product.
+		// If the block does not split after a number of steps, a double shift at the last diagonal element 
+		// moved by the size of the last subdiagonal elements breaks a possible cycle
+		double sum  = h(hi-1,hi-1) + h(hi,hi);
+		double prod = h(hi-1,hi-1)*h(hi,hi) - h(hi-1,hi)*h(hi,hi-1);
+		if (steps % 10 == 0) {
+			double shift = h(hi,hi) + fabs(h(hi,hi-1)) + fabs(h(hi-1,hi-2));
+			sum  = 2.0 * shift;
+			prod = shift * shift;
+		}
 
-													} else // end loop over care for brood
+		// first column of (H - s1 I)(H - s2 I), only its first three entries are non zero
+		double col[3];
+		col[0] = h(lo,lo)*h(lo,lo) + h(lo,lo+1)*h(lo+1,lo) - sum*h(lo,lo) + prod;
+		col[1] = h(lo+1,lo) * (h(lo,lo) + h(lo+1,lo+1) - sum);
+		col[2] = h(lo+1,lo) * h(lo+2,lo+1);
+
+		// chase the bulge down the subdiagonal
+		double v[3], beta;
+		for (int k=lo;k<=hi-2;k++) {
+			FwHouseholder(col, 3, v, beta);
+			FwReflectRows(h, v, beta, 3, k, (k>lo ? k-1 : lo), hi);
+			FwReflectCols(h, v, beta, 3, k, lo, (k+3<hi ? k+3 : hi));
+			if (k > lo) {
+				h(k+1,k-1) = 0.0;
+				h(k+2,k-1) = 0.0;
+			}
 
-														//--------------------------------------
-														// migrate
+			col[0] = h(k+1,k);
+			col[1] = h(k+2,k);
+			col[2] = (k+3 <= hi) ? h(k+3,k) : 0.0;
+		}
+		// the last reflector acts on two rows
+		FwHouseholder(col, 2, v, beta);
+		FwReflectRows(h, v, beta, 2, hi-1, hi-2, hi);
+		FwReflectCols(h, v, beta, 2, hi-1, lo, hi);
+		h(hi,hi-2) = 0.0;
+	}
+	return true;
+}
 
-														if (strat == 'm') {
-															Stoch_HMcN(X_m(_x_vec[x], e, 0, o, s, u_opt, t), Y_m(_x_vec[x], _y_vec[y], e, o, s, u_opt, t), cases);
+// Dominant real eigenvalue and unit eigenvector y of the leading k x k block of the Hessenberg matrix H(0..k-1,0..k-1)
+bool Forward::HessenbergDominantEigenpair(NArray<double> &H, unsigned int k, double &lambda, std::vector<double> &y) {
 
-															if (s < (_s_cnt-1)) {
-																for (unsigned int xi=0; xi<_xi_max; xi++) {
-																	for (unsigned int yi=0; yi<_yi_max; yi++) {
+	// eigenvalues of a copy
+	NArray<double> h;
+	h.Init(k, k);
+	for (unsigned int i=0;i<k;i++)
+		for (unsigned int j=0;j<k;j++)
+			h(i,j) = H(i,j);
 
-																		FW_props(cases.x_grid[xi],cases.y_grid[yi],Chop(e+1,0,(_e_cnt-1)),0,o,s+1,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * _p_exp;
+	std::vector<double> wr, wi;
+	if (!HessenbergEigenvalues(h, k, wr, wi))
+		return false;
 
-																		FW_props(cases.x_grid[xi],cases.y_grid[yi],e,0,o,s+1,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * (1-_p_exp);
-																		
-																		if (cases.x_grid[xi] <= 0) {
-																			FW_starvation(x,y,e,a,o,s,t) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * (1-die_pred) * (1-die_dis);
-																		}
+	// the Perron root of the nonnegative projection is real and of largest modulus
+	bool found = false;
+	for (unsigned int i=0;i<k;i++) {
+		if (fabs(wi[i]) <= 1.0e-10 * fabs(wr[i]) && (!found || fabs(wr[i]) > fabs(lambda))) {
+			lambda = wr[i];
+			found  = true;
+		}
+	}
+	if (!found || lambda == 0.0)
+		return false;
 
-																	}}
-															} else {    // s = (s_cnt-1) -> last week of migration -> at other location and not migrating anymore in next week
-																for (unsigned int xi=0; xi<_xi_max; xi++) {
-																	for (unsigned int yi=0; yi<_yi_max; yi++) {
+	// inverse iteration with a slightly perturbed shift, Gaussian elimination with partial pivoting
+	double shift = lambda * (1.0 + 1.0e-10);
+	y.assign(k, 1.0);
+	std::vector<double> b(k);
+	for (unsigned int iter=0;iter<3;iter++) {
+		for (unsigned int i=0;i<k;i++) {
+			for (unsigned int j=0;j<k;j++)
+				h(i,j) = H(i,j) - (i==j ? shift : 0.0);
+			b[i] = y[i];
+		}
+		for (unsigned int c=0;c<k;c++) {
+			unsigned int piv = c;
+			for (unsigned int i=c+1;i<k;i++)
+				if (fabs(h(i,c)) > fabs(h(piv,c)))
+					piv = i;
+			if (piv != c) {
+				for (unsigned int j=c;j<k;j++)
+					std::swap(h(c,j), h(piv,j));
+				std::swap(b[c], b[piv]);
+			}
+			if (h(c,c) == 0.0)
+				h(c,c) = 1.0e-300;
+			for (unsigned int i=c+1;i<k;i++) {
+				double f = h(i,c) / h(c,c);
+				for (unsigned int j=c;j<k;j++)
+					h(i,j) -= f * h(c,j);
+				b[i] -= f * b[c];
+			}
+		}
+		double norm = 0.0;
+		for (int i=k-1;i>=0;i--) {
+			double sum = b[i];
+			for (unsigned int j=i+1;j<k;j++)
+				sum -= h(i,j) * y[j];
+			y[i]  = sum / h(i,i);
+			norm += y[i]*y[i];
+		}
+		norm = sqrt(norm);
+		for (unsigned int i=0;i<k;i++)
+			y[i] /= norm;
+	}
+	return true;
+}
+
+// Computes lambda and the stable distribution as dominant eigenpair of the annual projection of week 0 
+// by restarted Arnoldi iterations, each basis vector is normalised so densities stay bounded
+double Forward::ComputeStableDistribution(Settings *settings, NArray<double> &FW_props, NArray<double> &FW_old, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t_start_week) {
 
-																		FW_props(cases.x_grid[xi],cases.y_grid[yi],Chop(e+1,0,(_e_cnt-1)),0,(o+1)%_o_cnt,0,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * _p_exp;
+	size_t n = _slice_size;
+	unsigned int m = (FW_KRYLOV_DIM < n) ? FW_KRYLOV_DIM : n;
+	unsigned int sweeps = 0;
+	unsigned int cycle  = 0;
 
-																		FW_props(cases.x_grid[xi],cases.y_grid[yi],e,0,(o+1)%_o_cnt,0,(t+1)%_t_cnt) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * cases.y_prop[yi] * (1-die_pred) * (1-die_dis) * (1-_p_exp);
-																		
-																		if (cases.x_grid[xi] <= 0) {
-																			FW_starvation(x,y,e,a,o,s,t) += FW_props(x,y,e,a,o,s,t) * cases.x_prop[xi] * (1-die_pred) * (1-die_dis);
-																		}
+	// the first year brings the starting cohort to week 0
+	if (t_start_week > 0) {
+		ProjectWeeks(FW_props, FW_predation, FW_disease, FW_starvation, t_start_week);
+		sweeps++;
+	}
 
-																	}}
-															}
+	NArray<double> V, H;
+	V.Init(n, m+1);
+	std::vector<double> x(FW_props.GetData(), FW_props.GetData()+n), y;
+	double lambda   = 0.0;
+	double residual = 1.0;
+
+	while (cycle == 0 || sweeps + m + 2 <= _n_fw) {
+
+		// Arnoldi basis of the annual projection, starting with the current estimate
+		double *v    = V.GetData();
+		double  norm = 0.0;
+		for (unsigned int i=0;i<n;i++)
+			norm += x[i]*x[i];
+		norm = sqrt(norm);
+		if (norm == 0.0) {
+			printf("Error: Forward eigen solver found no more living individuals\n");
+			break;
+		}
+		for (unsigned int i=0;i<n;i++)
+			v[i] = x[i] / norm;
+
+		H.Init(m+1, m);
+		unsigned int k = m;
+		for (unsigned int j=0;j<m;j++) {
+			double *w = v + (j+1)*n;
+			memcpy(FW_props.GetData(), v + j*n, n*sizeof(double));
+			_occupied.erase(FW_props.GetData());
+			ProjectWeeks(FW_props, FW_predation, FW_disease, FW_starvation, 0);
+			memcpy(w, FW_props.GetData(), n*sizeof(double));
+			sweeps++;
+
+			double w_norm = 0.0;
+			for (size_t r=0;r<n;r++)
+				w_norm += w[r]*w[r];
+			w_norm = sqrt(w_norm);
+
+			// modified Gram-Schmidt with a second pass against the loss of orthogonality
+			for (unsigned int pass=0;pass<2;pass++) {
+				for (unsigned int i=0;i<=j;i++) {
+					double *vi  = v + i*n;
+					double  dot = 0.0;
+					for (size_t r=0;r<n;r++)
+						dot += vi[r]*w[r];
+					for (size_t r=0;r<n;r++)
+						w[r] -= dot*vi[r];
+					H(i,j) += dot;
+				}
+			}
+			double h = 0.0;
+			for (size_t r=0;r<n;r++)
+				h += w[r]*w[r];
+			h = sqrt(h);
+			H(j+1,j) = h;
+
+			// invariant subspace found
+			if (h <= 1.0e-12 * w_norm) {
+				k = j+1;
+				break;
+			}
+			for (size_t r=0;r<n;r++)
+				w[r] /= h;
+		}
 
-														} // end loop over migration
+		// dominant Ritz pair
+		if (!HessenbergDominantEigenpair(H, k, lambda, y)) {
+			printf("Error: Forward eigen solver found no dominant eigenvalue of the projected matrix\n");
+			break;
+		}
+		residual = fabs(H(k,k-1) * y[k-1] / lambda);
 
-										}
+		for (size_t r=0;r<n;r++) {
+			double sum = 0.0;
+			for (unsigned int i=0;i<k;i++)
+				sum += v[i*n+r] * y[i];
+			x[r] = sum;
+		}
+		cycle++;
 
-									}}}}}} // end loop over states
+		printf("=========== Forward eigen solver cycle %2d  done ===========\n",cycle);
+		printf("........... Lambda:  %f   residual = %g   years = %d\n",lambda,residual,sweeps);
 
-			} // end loop over weeks
+		if (residual < _crit * FW_EIGEN_RESIDUAL_FAC)
+			break;
+	}
 
-		// The years following the first one (which starts at t_start_week) will start at week zero:
-		t_start_week = 0;
+	// nonnegative stable distribution of week 0 with a total of 1
+	// (rounding leaves tiny values in states of the Krylov basis that are outside the stable distribution)
+	double sum   = 0.0;
+	double x_max = 0.0;
+	for (size_t r=0;r<n;r++) {
+		sum  += x[r];
+		x_max = std::max(x_max, fabs(x[r]));
+	}
+	double sign = (sum < 0) ? -1.0 : 1.0;
+	sum = 0.0;
+	for (size_t r=0;r<n;r++) {
+		x[r] *= sign;
+		if (x[r] < FW_EIGEN_ZERO_REL * x_max)
+			x[r] = 0.0;
+		sum += x[r];
+	}
 
-		// calculate lambda & check convergence
+	// Further normalised years fill all weeks and refine the small values, which are only accurate 
+	// relative to the largest one, until the ratios of consecutive years agree with lambda
+	for (size_t r=0;r<n;r++)
+		FW_props.GetData()[r] = x[r] / sum;
+	_occupied.erase(FW_props.GetData());
+	ProjectWeeks(FW_props, FW_predation, FW_disease, FW_starvation, 0);
+	sweeps++;
+	do {
+		double total = 0.0;
+		for (size_t r=0;r<n;r++)
+			total += FW_props.GetData()[r];
+		double *p = FW_props.GetData();
+		for (size_t r=0;r<FW_props.GetSize();r++)
+			p[r] /= total;
+
+		SwapYearBuffers(FW_props, FW_old, 0);
+		ProjectWeeks(FW_props, FW_predation, FW_disease, FW_starvation, 0);
+		sweeps++;
 
 		CalcLambdaAndConvergence(FW_props, FW_old, _conv);
+	} while (fabs(_conv.lambda_fw_worst-lambda) >= _crit && sweeps < _n_fw);
+	_conv.fw_year_conv = sweeps;
 
-		lambda       = _conv.lambda_fw_average;
-		convergence  = _conv.fw_convergence;
-		lambda_state = _conv.lambda_fw_state;
+	printf("=========== Forward eigen solver done after %d years ===========\n",sweeps);
+	printf("........... Lambda:  average = %f   specific state = %f\n",_conv.lambda_fw_average,_conv.lambda_fw_state);
+	printf("........... Lambda:  worst   = %f   not converged %d of %d \n", _conv.lambda_fw_worst,_conv.fw_notconv_count,_conv.fw_state_count );
+	printf("\n");
+
+	if (_save_mortality_pattern_each_cycle) {
+		sprintf_s(_filename_fw_mp_year , "%s_mortality_FW_%2d.bin", settings->GetFilePrefixFW(),sweeps);
+		SaveMortalityPatterns(_filename_fw_mp_year);
+	}
+
+	return (lambda);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Batched projection of the starting cohorts of all start weeks and locations
+// ------------------------------------------------------------------------------------------------
+
+// AddIndependentBrood() for a block of k_cnt seeds, the seeds of a state are contiguous
+void Forward::AddIndependentBroodBatch(std::vector<double> &block, unsigned int k_cnt) {
+
+	for (unsigned int x=1;x<_x_cnt;x++) {
+		for (unsigned int y=0;y<_y_cnt;y++) {
+			for (unsigned int e=0;e<_e_cnt;e++) {
+				for (unsigned int o=0;o<_o_cnt;o++) {
+
+					const double *parents = &block[StateIndex(x,y,e,_a_cnt-1,o,0)*k_cnt];
+					for (unsigned int xi=0; xi<_xi_max; xi++) {
+						for (unsigned int yi=0; yi<_yi_max; yi++) {
+							double *young = &block[StateIndex(_indep_cases.x_grid[xi],_indep_cases.y_grid[yi],0,0,o,0)*k_cnt];
+							double  fac   = _n_brood * _indep_cases.x_prop[xi] * _indep_cases.y_prop[yi];
+							for (unsigned int k=0;k<k_cnt;k++)
+								young[k] += parents[k] * fac;
+						}}
+				}}}}
+}
+
+// ApplyWeekOperator() for a block of k_cnt seeds: the rows of the week operator times the dense block,
+// each weight is loaded once for all seeds and the seeds of a state are added in increasing source order
+void Forward::ApplyWeekOperatorBatch(const std::vector<double> &curr, std::vector<double> &next, unsigned int t, unsigned int k_cnt) {
+
+	FwWeekOperatorStruct &op = WeekOperator(t);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int r=0;r<(int)_slice_size;r++) {
+		double *sum = &next[r*k_cnt];
+
+		// full blocks of seeds are summed in registers
+		unsigned int k0 = 0;
+		for (;k0+FW_BATCH_BLOCK<=k_cnt;k0+=FW_BATCH_BLOCK) {
+			double acc[FW_BATCH_BLOCK] = { 0.0 };
+			for (unsigned int i=op.row_start[r];i<op.row_start[r+1];i++) {
+				const double *src = &curr[op.src[i]*k_cnt + k0];
+				double        w   = op.row_weight[i];
+				for (unsigned int k=0;k<FW_BATCH_BLOCK;k++)
+					acc[k] += src[k] * w;
+			}
+			for (unsigned int k=0;k<FW_BATCH_BLOCK;k++)
+				sum[k0+k] = acc[k];
+		}
+
+		// remaining seeds
+		for (unsigned int k=k0;k<k_cnt;k++)
+			sum[k] = 0.0;
+		for (unsigned int i=op.row_start[r];i<op.row_start[r+1] && k0<k_cnt;i++) {
+			const double *src = &curr[op.src[i]*k_cnt];
+			double        w   = op.row_weight[i];
+			for (unsigned int k=k0;k<k_cnt;k++)
+				sum[k] += src[k] * w;
+		}
+	}
+}
+
+// Projects one starting cohort for each start week and start location in a single pass over the weeks.
+// The seed k = t_start + _t_cnt*o_start enters the block in week t_start of the first year, the 
+// distributions are normalised to a total of one in week 0 of each year, so the total after a 
+// projected year is the lambda of the seed. Returns the lambda of ForwardStartEpoch and ForwardStartLocation.
+double Forward::ComputeBatch() {
+
+	unsigned int k_cnt = _t_cnt*_o_cnt;
+	size_t       n     = _slice_size;
+
+	std::vector<double> curr(n*k_cnt, 0.0), next(n*k_cnt);
+	std::vector<double> total(k_cnt), lambda_old(k_cnt, 0.0);
+
+	_batch_lambda.Init(_t_cnt, _o_cnt);
+
+	FwStochXYPropResultStruct cases;
+	Stoch_HMcN(_x_indep, _y_indep, cases);
+
+	printf("Forward::ComputeBatch() projecting %u seeds of %u states\n\n", k_cnt, (unsigned int)n);
+
+	bool         convergence   = false;
+	unsigned int notconv_count = k_cnt;
+	unsigned int year          = 0;
+
+	while ((!convergence && year<_n_fw) || year<_n_min_fw)
+	{
+		for (unsigned int t=0;t<_t_cnt;t++) {
+
+			// starting cohorts of week t
+			if (year == 0) {
+				for (unsigned int o=0;o<_o_cnt;o++) {
+					for (unsigned int xi=0; xi<_xi_max; xi++) {
+						for (unsigned int yi=0; yi<_yi_max; yi++) {
+							curr[StateIndex(cases.x_grid[xi],cases.y_grid[yi],0,0,o,0)*k_cnt + t + _t_cnt*o] += cases.x_prop[xi]*cases.y_prop[yi];
+						}}
+				}
+			}
+
+			AddIndependentBroodBatch(curr, k_cnt);
+			ApplyWeekOperatorBatch(curr, next, t, k_cnt);
+			curr.swap(next);
+		}
+
+		// totals of week 0 of the next year
+		total.assign(k_cnt, 0.0);
+		for (size_t r=0;r<n;r++) {
+			const double *p = &curr[r*k_cnt];
+			for (unsigned int k=0;k<k_cnt;k++)
+				total[k] += p[k];
+		}
+
+		// the first year holds only the weeks after the start week, it has no lambda
+		double lambda_min = 0.0, lambda_max = 0.0;
+		notconv_count = 0;
+		for (unsigned int k=0;k<k_cnt;k++) {
+			double lambda = (year > 0) ? total[k] : 0.0;
+			if (year == 0 || fabs(lambda - lambda_old[k]) >= _crit)
+				notconv_count++;
+			if (k == 0 || lambda < lambda_min)
+				lambda_min = lambda;
+			if (k == 0 || lambda > lambda_max)
+				lambda_max = lambda;
+			lambda_old[k] = lambda;
+			_batch_lambda.GetData()[k] = lambda;
+		}
+		convergence = (notconv_count == 0);
 		if (convergence) {
 			_conv.fw_year_conv = year;
-		}			
+		}
 
-//		printf("=========== Forward iteration %2d done,  Lambda Fwd = %.4f\n\n", year, lambda_state);		
+		for (size_t r=0;r<n;r++) {
+			double *p = &curr[r*k_cnt];
+			for (unsigned int k=0;k<k_cnt;k++) {
+				if (total[k] > 0.0)
+					p[k] /= total[k];
+			}
+		}
 
-		printf("=========== Forward iteration %2d  done ===========\n",year);	 
-		printf("........... Lambda:  average = %f   specific state = %f\n",_conv.lambda_fw_average,_conv.lambda_fw_state);
-		printf("........... Lambda:  worst   = %f   not converged %d of %d \n", _conv.lambda_fw_worst,_conv.fw_notconv_count,_conv.fw_state_count );
+		printf("=========== Forward batch iteration %2d  done ===========\n",year);	 
+		printf("........... Lambda:  minimum = %f   maximum = %f   not converged %d of %d \n", lambda_min, lambda_max, notconv_count, k_cnt);
 		printf("\n");
 
-		// store/overwrite results
-		_FW_props = FW_props;		
+		year++;
+	}
 
-		if (_user_init_start_pop) {
-			sprintf_s(_filename_fw_pd_year , "%s_populationdynamics_FW_%2d.bin", settings->GetFilePrefixFW(),year);
-			SavePopulationDynamics(_filename_fw_pd_year);
+	// distributions of week 0, the seeds become the outermost dimensions
+	_batch_props.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt, _o_cnt);
+	double *props = _batch_props.GetData();
+	for (size_t r=0;r<n;r++) {
+		for (unsigned int k=0;k<k_cnt;k++)
+			props[r + n*k] = curr[r*k_cnt + k];
+	}
+
+	double lambda = _batch_lambda(_start_week_fw, _start_loc_fw-1);
+
+	_conv.lambda_fw_average = lambda;
+	_conv.lambda_fw_state   = lambda;
+	_conv.lambda_fw_worst   = lambda;
+	_conv.fw_convergence    = convergence;
+	_conv.fw_notconv_count  = notconv_count;
+	_conv.fw_state_count    = k_cnt;
+
+	return (lambda);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Life-history metrics of the absorbing Markov chain of an individual
+// ------------------------------------------------------------------------------------------------
+
+// The week operators without the brood step are the transient part of the absorbing Markov chain of 
+// a single individual, the three causes of death absorb it. The expected visits of all states, the 
+// fundamental matrix (I-Q)^-1 applied to the independent young of the starting cohort, are summed as
+// Neumann series one week after the other, until the probability to be alive is below FW_LH_REMAINING.
+// The second column of the block follows the same individual only until its first start of reproduction.
+void Forward::ComputeLifeHistory(Settings *settings) {
+
+	if (!_decision) {
+		printf("Forward::ComputeLifeHistory() ERROR: '_decision' not initialized\n");
+		return;
+	}
+
+	// the operators of ComputePopulationDynamics() are reused, a standalone call prepares them
+	if (_week_op.size() != settings->GetTCnt()) {
+		Init(settings);
+		BuildWeekOperators();
+	}
+
+	FwLifeHistoryStruct &lh = _life_history;
+	lh.reproductive_output = 0.0;
+	lh.life_expectancy     = 0.0;
+	lh.p_breeding          = 0.0;
+	lh.age_first_breeding  = 0.0;
+	lh.p_death[0] = lh.p_death[1] = lh.p_death[2] = 0.0;
+	lh.survivorship.clear();
+	lh.first_breeding.clear();
+	lh.departures.Init(_t_cnt, _o_cnt);
+
+	size_t       n        = _slice_size;
+	unsigned int xye_cnt  = _x_cnt*_y_cnt*_e_cnt;
+	unsigned int xyea_cnt = xye_cnt*_a_cnt;
+
+	// column 0: the individual, column 1: the individual before its first start of reproduction
+	std::vector<double> curr(2*n, 0.0), next(2*n);
+	FwStochXYPropResultStruct cases;
+	Stoch_HMcN(_x_indep, _y_indep, cases);
+	for (unsigned int xi=0; xi<_xi_max; xi++) {
+		for (unsigned int yi=0; yi<_yi_max; yi++) {
+			size_t r = StateIndex(cases.x_grid[xi],cases.y_grid[yi],0,0,_start_loc_fw-1,0);
+			curr[2*r]   += cases.x_prop[xi]*cases.y_prop[yi];
+			curr[2*r+1] += cases.x_prop[xi]*cases.y_prop[yi];
+		}}
+
+	double       alive        = 1.0;
+	double       breeding_age = 0.0;
+	unsigned int t            = _start_week_fw;
+	unsigned int age          = 0;
+
+	while (alive >= FW_LH_REMAINING && age < FW_LH_MAX_YEARS*_t_cnt) {
+
+		FwWeekOperatorStruct &op = WeekOperator(t);
+
+		if (age % _t_cnt == 0)
+			lh.first_breeding.push_back(0.0);
+
+		alive = 0.0;
+		for (size_t r=0;r<n;r++) {
+			double p = curr[2*r];
+			if (p == 0.0)
+				continue;
+
+			// depleted reserves, the state has no transitions
+			if (op.action[r] == FW_ACTION_NONE) {
+				lh.p_death[2] += p;
+				continue;
+			}
+
+			alive         += p;
+			lh.p_death[0] += p * op.die_pred[r];
+			lh.p_death[1] += p * (1-op.die_pred[r]) * op.die_dis[r];
+
+			unsigned int a = (r / xye_cnt) % _a_cnt;
+			unsigned int o = (r / xyea_cnt) % _o_cnt;
+			unsigned int s = r / (xyea_cnt*_o_cnt);
+
+			// last week of care releases the young, see AddIndependentBrood()
+			if (a == _a_cnt-1 && s == 0)
+				lh.reproductive_output += _n_brood * p;
+
+			if (op.action[r] == FW_ACTION_MIGRATE && s == 0)
+				lh.departures(t,o) += p;
+
+			if (op.action[r] == FW_ACTION_START) {
+				lh.first_breeding.back() += curr[2*r+1];
+				breeding_age             += curr[2*r+1] * age;
+				curr[2*r+1] = 0.0;
+			}
 		}
-		
-		// store/overwrite mortality results
-		_FW_predation  = FW_predation;
-		_FW_disease    = FW_disease;
-		_FW_starvation = FW_starvation;
-		if (_save_mortality_pattern_each_cycle) {
-			sprintf_s(_filename_fw_mp_year , "%s_mortality_FW_%2d.bin", settings->GetFilePrefixFW(),year);
-			SaveMortalityPatterns(_filename_fw_mp_year);
+		lh.life_expectancy += alive;
+		if (age % _t_cnt == 0)
+			lh.survivorship.push_back(alive);
+
+		ApplyWeekOperatorBatch(curr, next, t, 2);
+		curr.swap(next);
+
+		t = (t+1)%_t_cnt;
+		age++;
+	}
+
+	// survivors and the individuals with depleted reserves of the last week
+	lh.remaining = 0.0;
+	for (size_t r=0;r<n;r++)
+		lh.remaining += curr[2*r];
+
+	for (unsigned int i=0;i<lh.first_breeding.size();i++)
+		lh.p_breeding += lh.first_breeding[i];
+	if (lh.p_breeding > 0.0)
+		lh.age_first_breeding = breeding_age / lh.p_breeding;
+
+	printf("Forward::ComputeLifeHistory() done after %u weeks, remaining probability %g\n", age, lh.remaining);
+}
+
+// ------------------------------------------------------------------------------------------------
+// Monte Carlo simulation of individuals
+// ------------------------------------------------------------------------------------------------
+
+// Places a newly independent individual on the grid nodes of the interpolation cases
+unsigned int Forward::McPlaceIndependent(FwStochXYPropResultStruct &cases, unsigned int o, unsigned int id, unsigned int year, unsigned int t) {
+
+	double       u  = Rand01(id, year, t, FW_MC_DRAW_X);
+	unsigned int xi = 0;
+	while (xi+1 < _xi_max && u >= cases.x_prop[xi]) {
+		u -= cases.x_prop[xi];
+		xi++;
+	}
+	u = Rand01(id, year, t, FW_MC_DRAW_Y);
+	unsigned int yi = 0;
+	while (yi+1 < _yi_max && u >= cases.y_prop[yi]) {
+		u -= cases.y_prop[yi];
+		yi++;
+	}
+	return (unsigned int)StateIndex(cases.x_grid[xi], cases.y_grid[yi], 0, 0, o, 0);
+}
+
+// Parents in the last week of care release _n_brood independent young each, appended behind the population
+void Forward::McAddBrood(unsigned int year, unsigned int t) {
+
+	unsigned int n      = _pop.state.size();
+	unsigned int xye    = _x_cnt*_y_cnt*_e_cnt;
+	unsigned int xyeao  = xye*_a_cnt*_o_cnt;
+
+	_pop.offset.resize(n+1);
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int i=0;i<(int)n;i++) {
+		unsigned int st = _pop.state[i];
+		bool parent = (st%_x_cnt > 0) && ((st/xye)%_a_cnt == _a_cnt-1) && (st/xyeao == 0);
+		_pop.offset[i] = parent ? _n_brood : 0;
+	}
+
+	// first young of each parent
+	unsigned int young = 0;
+	for (unsigned int i=0;i<n;i++) {
+		unsigned int cnt = _pop.offset[i];
+		_pop.offset[i] = young;
+		young += cnt;
+	}
+	_pop.offset[n] = young;
+	if (young == 0)
+		return;
+
+	_pop.state.resize(n+young);
+	_pop.id.resize(n+young);
+	_pop.birth_year.resize(n+young);
+	_pop.birth_week.resize(n+young);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int i=0;i<(int)n;i++) {
+		unsigned int o = (_pop.state[i]/(_x_cnt*_y_cnt*_e_cnt*_a_cnt))%_o_cnt;
+		for (unsigned int k=_pop.offset[i];k<_pop.offset[i+1];k++) {
+			unsigned int j  = n+k;
+			_pop.id[j]         = _pop.next_id + k;
+			_pop.state[j]      = McPlaceIndependent(_indep_cases, o, _pop.id[j], year, t);
+			_pop.birth_year[j] = year;
+			_pop.birth_week[j] = (unsigned char) t;
 		}
+	}
 
-		dlambda_fw    = fabs(lambda-lambda_old_fw);
-		lambda_old_fw = lambda;
-		year++;
+	if (_mc_log) {
+		for (unsigned int i=0;i<n;i++) {
+			if (_pop.offset[i+1] == _pop.offset[i])
+				continue;
+			_events.Add(_pop.id[i], year, t, EVENT_FLEDGING, _pop.offset[i+1]-_pop.offset[i]);
+			for (unsigned int k=_pop.offset[i];k<_pop.offset[i+1];k++)
+				_events.Add(_pop.id[n+k], year, t, EVENT_INDEPENDENCE, _pop.id[i]);
+		}
+	}
+	_pop.next_id += young;
+}
 
-		// } // end loop over years
-	} // end while loop over years and dlambda    
+// Samples survival and the state of week t+1 of each individual from the column of the week operator,
+// which holds the transitions of the optimal decision f_u/f_strat
+void Forward::McTransition(unsigned int year, unsigned int t) {
 
-	return (lambda);
+	FwWeekOperatorStruct &op = WeekOperator(t);
+	unsigned int n = _pop.state.size();
+
+	_pop.next_state.resize(n);
+	_pop.fate.resize(n);
+
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(static)
+#endif
+	for (int i=0;i<(int)n;i++) {
+		unsigned int c = _pop.state[i];
+		double       u = Rand01(_pop.id[i], year, t, FW_MC_DRAW_FATE);
+
+		double die_pred = op.die_pred[c];
+		double die_dis  = (1-die_pred) * op.die_dis[c];
+		if (u < die_pred) {
+			_pop.fate[i] = FW_MC_PREDATION;
+			continue;
+		}
+		u -= die_pred;
+		if (u < die_dis) {
+			_pop.fate[i] = FW_MC_DISEASE;
+			continue;
+		}
+		u -= die_dis;
+
+		// the column weights add up to the survival probability, states with x=0 have no transitions
+		unsigned int k   = op.col_start[c];
+		unsigned int end = op.col_start[c+1];
+		if (k == end) {
+			_pop.fate[i] = FW_MC_STARVATION;
+			continue;
+		}
+		while (k+1 < end && u >= op.weight[k]) {
+			u -= op.weight[k];
+			k++;
+		}
+		_pop.next_state[i] = op.dst[k];
+		_pop.fate[i]       = (op.dst[k]%_x_cnt == 0) ? FW_MC_STARVATION : FW_MC_ALIVE;
+	}
+}
+
+// Moves the survivors to their new state and removes the dead, optionally records the individuals 
+// and deaths of week t weighted by scale
+void Forward::McRemoveDead(unsigned int year, unsigned int t, bool record, double scale, unsigned int deaths[4]) {
+
+	static const EventType death_event[4] = { EVENT_DEATH_PREDATION, EVENT_DEATH_PREDATION, EVENT_DEATH_DISEASE, EVENT_DEATH_STARVATION };
+
+	unsigned int n = _pop.state.size();
+	unsigned int w = 0;
+	unsigned int xye  = _x_cnt*_y_cnt*_e_cnt;
+	unsigned int xyea = xye*_a_cnt;
+	double *props = _FW_props.GetData() + t*_slice_size;
+
+	for (unsigned int i=0;i<n;i++) {
+		unsigned char fate = _pop.fate[i];
+		deaths[fate]++;
+
+		if (_mc_log) {
+			unsigned int c = _pop.state[i];
+			if (fate != FW_MC_ALIVE) {
+				_events.Add(_pop.id[i], year, t, death_event[fate], c);
+			} 
+			else {
+				unsigned int d      = _pop.next_state[i];
+				unsigned int a      = (c/xye)%_a_cnt,  a_next = (d/xye)%_a_cnt;
+				unsigned int o      = (c/xyea)%_o_cnt, o_next = (d/xyea)%_o_cnt;
+				unsigned int s      = c/(xyea*_o_cnt), s_next = d/(xyea*_o_cnt);
+				if (a == 0 && a_next == 1)
+					_events.Add(_pop.id[i], year, t, EVENT_BROOD_START, o);
+				if (a > 0 && a < _a_cnt-1 && a_next == 0)
+					_events.Add(_pop.id[i], year, t, EVENT_BROOD_ABANDON, a);
+				if (s == 0 && (s_next == 1 || o_next != o))
+					_events.Add(_pop.id[i], year, t, EVENT_MIGRATION_START, o);
+			}
+		}
+
+		if (record) {
+			unsigned int c = _pop.state[i];
+			props[c] += scale;
+			if (_track_mortality) {
+				if (fate == FW_MC_PREDATION) _FW_predation.GetData()[t*_slice_size+c]  += scale;
+				if (fate == FW_MC_DISEASE)   _FW_disease.GetData()[t*_slice_size+c]    += scale;
+				if (fate == FW_MC_STARVATION)_FW_starvation.GetData()[t*_slice_size+c] += scale;
+			}
+		}
 
+		if (fate == FW_MC_ALIVE) {
+			_pop.state[w]      = _pop.next_state[i];
+			_pop.id[w]         = _pop.id[i];
+			_pop.birth_year[w] = _pop.birth_year[i];
+			_pop.birth_week[w] = _pop.birth_week[i];
+			w++;
+		}
+	}
+	_pop.state.resize(w);
+	_pop.id.resize(w);
+	_pop.birth_year.resize(w);
+	_pop.birth_week.resize(w);
 }
 
+// Resamples the population to the starting cohort size, each individual is kept in the expected 
+// number of copies and further copies get new identities
+void Forward::McResample(unsigned int year) {
+
+	unsigned int n    = _pop.state.size();
+	double       f    = (double)_cohortsize_fw / n;
+	unsigned int keep = (unsigned int)f;
+
+	_pop.offset.resize(n+1);
+	unsigned int total = 0;
+	for (unsigned int i=0;i<n;i++) {
+		_pop.offset[i] = total;
+		total += keep + ((Rand01(_pop.id[i], year, _t_cnt-1, FW_MC_DRAW_COPY) < f-keep) ? 1 : 0);
+	}
+	_pop.offset[n] = total;
+
+	std::vector<unsigned int>  state(total), id(total), birth_year(total);
+	std::vector<unsigned char> birth_week(total);
+	unsigned int copies = 0;
+	for (unsigned int i=0;i<n;i++) {
+		if (_mc_log && _pop.offset[i+1] == _pop.offset[i])
+			_events.Add(_pop.id[i], year, _t_cnt-1, EVENT_RESAMPLE_REMOVED, -1);
+
+		for (unsigned int k=_pop.offset[i];k<_pop.offset[i+1];k++) {
+			state[k]      = _pop.state[i];
+			birth_year[k] = _pop.birth_year[i];
+			birth_week[k] = _pop.birth_week[i];
+			if (k == _pop.offset[i]) {
+				id[k] = _pop.id[i];
+			}
+			else {
+				id[k] = _pop.next_id + copies++;
+				if (_mc_log)
+					_events.Add(id[k], year, _t_cnt-1, EVENT_RESAMPLE_COPY, _pop.id[i]);
+			}
+		}
+	}
+	_pop.next_id += copies;
+
+	_pop.state.swap(state);
+	_pop.id.swap(id);
+	_pop.birth_year.swap(birth_year);
+	_pop.birth_week.swap(birth_week);
+}
+
+// Simulates the starting cohort and its descendants as individuals. Lambda is the geometric mean 
+// of the annual growth over the final _l_fw years, the state distribution and mortality patterns of
+// the final year are stored relative to the individuals at its start
+double Forward::ComputeMonteCarlo(Settings *settings) {
+
+	printf("Forward::ComputeMonteCarlo() simulating a starting cohort of %d individuals\n", _cohortsize_fw);
+
+	_FW_props.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+	if (_track_mortality) {
+		_FW_predation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+		_FW_disease.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+		_FW_starvation.Init(_x_cnt, _y_cnt, _e_cnt, _a_cnt, _o_cnt, _s_cnt, _t_cnt);
+	}
+
+	// initiate starting cohort
+	FwStochXYPropResultStruct cases;
+	Stoch_HMcN(_x_indep, _y_indep, cases);
+
+	_pop.state.resize(_cohortsize_fw);
+	_pop.id.resize(_cohortsize_fw);
+	_pop.birth_year.assign(_cohortsize_fw, 0);
+	_pop.birth_week.assign(_cohortsize_fw, (unsigned char)_start_week_fw);
+	for (unsigned int i=0;i<_cohortsize_fw;i++) {
+		_pop.id[i]    = i;
+		_pop.state[i] = McPlaceIndependent(cases, _start_loc_fw-1, i, 0, _start_week_fw);
+	}
+	_pop.next_id = _cohortsize_fw;
+
+	char filename[FILENAME_MAX];
+	if (_mc_log) {
+		sprintf_s(filename, "%s_lifehistory_FW.bin", settings->GetFilePrefixFW());
+		_mc_log = _events.Open(filename);
+	}
+	if (_mc_log) {
+		for (unsigned int i=0;i<_cohortsize_fw;i++)
+			_events.Add(i, 0, _start_week_fw, EVENT_INDEPENDENCE, -1);
+	}
+
+	std::vector<double> log_lambda;
+	double lambda = 0.0;
+	unsigned int t_start_week = _start_week_fw;
+
+	for (unsigned int year=0;year<_n_fw;year++) {
+
+		unsigned int n_start = _pop.state.size();
+		unsigned int deaths[4] = { 0, 0, 0, 0 };
+		bool         record    = (year == _n_fw-1);
+
+		for (unsigned int t=t_start_week;t<_t_cnt;t++) {
+			McAddBrood(year, t);
+			McTransition(year, t);
+			McRemoveDead(year, t, record, 1.0/n_start, deaths);
+		}
+
+		unsigned int n_end = _pop.state.size();
+		printf("=========== Forward Monte Carlo year %2d  done ===========\n",year);
+		printf("........... Individuals: %u  died of predation %u, disease %u, starvation %u\n", n_end, deaths[FW_MC_PREDATION], deaths[FW_MC_DISEASE], deaths[FW_MC_STARVATION]);
+
+		if (n_end == 0) {
+			printf("Error: Forward Monte Carlo simulation found no more living individuals\n");
+			break;
+		}
+
+		// the first year starts at the start week and is not a full annual cycle
+		if (t_start_week == 0) {
+			log_lambda.push_back(log((double)n_end/n_start));
+			printf("........... Lambda:  year = %f\n", (double)n_end/n_start);
+		}
+		printf("\n");
+		t_start_week = 0;
+
+		if (n_end > FW_MC_RESAMPLE_FAC*_cohortsize_fw || FW_MC_RESAMPLE_FAC*n_end < _cohortsize_fw)
+			McResample(year);
+	}
+
+	// average over the final years
+	unsigned int window = (_l_fw < log_lambda.size()) ? _l_fw : log_lambda.size();
+	if (window > 0) {
+		double sum = 0.0;
+		for (unsigned int i=log_lambda.size()-window;i<log_lambda.size();i++)
+			sum += log_lambda[i];
+		lambda = exp(sum/window);
+	}
+
+	_conv.lambda_fw_average = lambda;
+	_conv.lambda_fw_state   = log_lambda.empty() ? 0.0 : exp(log_lambda.back());
+	_conv.lambda_fw_worst   = lambda;
+	_conv.fw_notconv_count  = 0;
+	_conv.fw_state_count    = _pop.state.size();
+	_conv.fw_convergence    = false;
+	_conv.fw_year_conv      = log_lambda.size();
+
+	printf("........... Lambda:  average of the final %d years = %f\n\n", window, lambda);
+
+	if (_mc_log) {
+		printf("........... Life history: %u events saved to %s\n\n", _events.GetCount(), filename);
+		_events.Close();
+	}
+
+	if (_save_mortality_pattern_each_cycle) {
+		sprintf_s(_filename_fw_mp_year , "%s_mortality_FW_%2d.bin", settings->GetFilePrefixFW(),_n_fw-1);
+		SaveMortalityPatterns(_filename_fw_mp_year);
+	}
+
+	return (lambda);
+}
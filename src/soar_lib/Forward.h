@@ -27,15 +27,18 @@
 #ifndef __OAR_CPP__Forward__
 #define __OAR_CPP__Forward__
 
-#include <list>
 #include <vector>
+#include <map>
 
 #include "StateFuncs.h"
+#include "EventLog.h"
 #include "..\soar_support_lib\NArray.h"
+#include "..\soar_support_lib\NArrayFixed.h"
+#include "..\soar_support_lib\GridAxis.h"
+#include "..\soar_support_lib\GridStencil.h"
 
 // Forward declarations of external classes
 class Decision;
-class Individual;
 class Settings;
 
 /**
@@ -59,8 +62,8 @@ private:
     unsigned int	_n_brood;
     double			_gamma_nest;
     
-    double			_dx;
-    double			_dy;
+    GridAxis		_x_grid;		///< Reserves grid nodes with lookup of the lower node
+    GridAxis		_y_grid;		///< Health grid nodes with lookup of the lower node
     double			_x_indep;
     double			_y_indep;
     
@@ -95,9 +98,11 @@ private:
 	char            _filename_fw_pd[FILENAME_MAX];  // PopulationDynamics
 	char            _filename_fw_pd_year[FILENAME_MAX];	// Population dynamics in a single year
 	char		_filename_fw_mp_year[FILENAME_MAX]; // Mortality patterns in a single year
+	char		_filename_fw_marg[FILENAME_MAX];    // Marginal summaries of all years
 	bool            _user_init_start_pop;
 	bool		_save_mortality_pattern_each_cycle;
 	bool		_save_final_mortality_pattern;
+	bool		_track_mortality;	///< Compute the mortality components, only if one of them is saved
 	double          _lambda_fw_average;
 	double          _fw_convergence; 
 	bool            _fw_year_conv; 
@@ -108,16 +113,9 @@ private:
 	bool            _fw_initialized; 
 
 
-#ifdef GENERATE_DOXYGEN_DOC
-    Individual * _population;
-#else
-    std::list<Individual> _population;
-#endif	
     NArray<double>	_fw_summary;
-	unsigned int    _l_fw;
-    unsigned int	_cohortsize_fw;
-    void PopInit(int nr_ind, int o, int t, int year);   
-    void   PopToFile(char *filename);   ///< Save population list into a single binary file   
+	unsigned int    _l_fw;				///< Number of final years averaged for the Monte Carlo lambda
+    unsigned int	_cohortsize_fw;		///< Number of individuals of the Monte Carlo starting cohort
 
 	int    _yearFw;												
 	void   SetYearFw(int y)		{	_yearFw = y;	 }	
@@ -157,6 +155,112 @@ private:
 		int    fw_year_conv;	   // Year of convergence, or number of cycle, respectively		
     };
 
+	/**
+	 * \ingroup SoarLib
+	 * \brief Sparse transition operator of a single week, see BuildWeekOperators()
+	 *
+	 * The matrix is stored column-wise (CSC) with one column per state of week t, used to scatter
+	 * sparsely occupied weeks, and row-wise (CSR) with one row per state of week t+1, used to gather
+	 * densely occupied weeks. Both list the entries in increasing state order. Both forms hold every
+	 * entry (state and weight, 12 bytes), so the operator takes twice the memory of a single form. 
+	 * The mortality components are dense vectors over the states of week t and zero for states 
+	 * without transitions (x=0). States and entries are 32-bit indices within the week, only the 
+	 * offsets of the weeks within a year use size_t.
+	 */
+	struct FwWeekOperatorStruct {
+		std::vector<unsigned int> col_start;	///< First entry of each state of week t, one more than states
+		std::vector<unsigned int> dst;			///< State of week t+1 of each column entry
+		std::vector<double>       weight;		///< Proportion of the column state moving to dst
+		std::vector<unsigned int> row_start;	///< First entry of each state of week t+1, one more than states
+		std::vector<unsigned int> src;			///< State of week t of each row entry
+		std::vector<double>       row_weight;	///< Proportion of the src state moving to the row state
+		std::vector<double>       die_pred;		///< Predation mortality of each state of week t
+		std::vector<double>       die_dis;		///< Disease mortality of each state of week t
+		std::vector<double>       starve;		///< Proportion of each state of week t starving
+		std::vector<unsigned char> action;		///< Action of each state of week t for the marginal summaries, see AccumulateMarginals()
+	};
+
+	std::vector<FwWeekOperatorStruct> _week_op;		///< Transition operators of all weeks, only week _op_week in the on-demand mode
+	bool                      _op_on_demand;		///< The operators of all weeks exceed FW_OPERATOR_MAX_MB, each week is built when it is projected
+	int                       _op_week;				///< Week whose operator is held in the on-demand mode, -1 if none
+	size_t                    _slice_size;			///< Number of states of a single week
+	FwStochXYPropResultStruct _indep_cases;			///< Grid interpolation of newly independent young
+	std::vector<unsigned int> _active;				///< Occupied states of the currently projected week
+	std::map<const double*, std::vector<unsigned int> > _occupied;	///< Occupied states of the sparse week slices by slice address, see ApplyWeekOperator()
+	std::vector<unsigned char> _marker;				///< States of week t+1 already listed by the scatter, all zero between two weeks
+
+	/// Returns the offset of state (x,y,e,a,o,s) within a week of the NArray layout
+	size_t StateIndex(unsigned int x, unsigned int y, unsigned int e, unsigned int a, unsigned int o, unsigned int s) {
+		return x + _x_cnt*(y + _y_cnt*(e + _e_cnt*(a + _a_cnt*(o + (size_t)_o_cnt*s))));
+	}
+
+	void BuildWeekOperators();
+	void BuildWeekOperator(unsigned int t);
+	FwWeekOperatorStruct & WeekOperator(unsigned int t);
+	void AddIndependentBrood(NArray<double> &FW_props, unsigned int t);
+	void ApplyWeekOperator(NArray<double> &FW_props, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t);
+	void ProjectWeeks(NArray<double> &FW_props, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t_start);
+	void SwapYearBuffers(NArray<double> &FW_props, NArray<double> &FW_old, unsigned int t_start);
+
+	bool           _save_marginals;		///< Build the marginal summaries of each year during the sweep
+	bool           _save_full_dynamics;	///< Save the full state distribution of each year or the final year
+	NArray<double> _marg_occupancy;		///< Population per action x location x week of the current year
+	NArray<double> _marg_reserves;		///< Population per reserves node x week of the current year
+	NArray<double> _marg_health;		///< Population per health node x week of the current year
+
+	void AccumulateMarginals(const double *curr, unsigned int t);
+	void SaveMarginals(FILE *file, unsigned int year);
+
+	unsigned int   _env_years;			///< Number of years of the non-stationary horizon, 1 for the stationary annual routine
+
+	/// Loads the policy of a year of the horizon, selects its environment and rebuilds the week operators
+	bool LoadHorizonYear(Settings *settings, unsigned int year);
+
+	bool   _eigen_solver;		///< Compute lambda and the stable distribution as dominant eigenpair instead of iterating years
+
+	bool           _batch_all_starts;	///< Project the starting cohorts of all start weeks and locations at once
+	NArray<double> _batch_lambda;		///< Lambda of each seed, dimensions start week x start location
+	NArray<double> _batch_props;		///< Normalised distribution of week 0 of each seed, dimensions x,y,e,a,o,s x start week x start location
+
+	void   AddIndependentBroodBatch(std::vector<double> &block, unsigned int k_cnt);
+	void   ApplyWeekOperatorBatch(const std::vector<double> &curr, std::vector<double> &next, unsigned int t, unsigned int k_cnt);
+	double ComputeBatch();
+
+	/**
+	 * \ingroup SoarLib
+	 * \brief Individuals of the Monte Carlo forward simulation, stored as structure of arrays
+	 *
+	 * The state of an individual is its offset within a week, see StateIndex(), so the weekly 
+	 * transition samples directly from the columns of the week operators.
+	 */
+	struct FwPopulationStruct {
+		std::vector<unsigned int>  state;		///< State (x,y,e,a,o,s) of each individual
+		std::vector<unsigned int>  id;			///< Identity, keys the random stream of each individual
+		std::vector<unsigned int>  birth_year;	///< Year of independence
+		std::vector<unsigned char> birth_week;	///< Week of independence
+		std::vector<unsigned int>  next_state;	///< State after the weekly transition
+		std::vector<unsigned char> fate;		///< Survival or cause of death in the weekly transition
+		std::vector<unsigned int>  offset;		///< First young of each parent or first copy of each individual
+		unsigned int               next_id;		///< Identity of the next new individual
+	};
+
+	bool               _monte_carlo;	///< Simulate individuals instead of the state distribution
+	unsigned int       _mc_seed;		///< Seed of the counter-based random streams
+	FwPopulationStruct _pop;			///< Individuals of the Monte Carlo simulation
+	bool               _mc_log;			///< Record the life-history events of the individuals
+	EventLog           _events;			///< Life-history events, streamed to the FW file prefix + "_lifehistory_FW.bin"
+
+	unsigned int McPlaceIndependent(FwStochXYPropResultStruct &cases, unsigned int o, unsigned int id, unsigned int year, unsigned int t);
+	void   McAddBrood(unsigned int year, unsigned int t);
+	void   McTransition(unsigned int year, unsigned int t);
+	void   McRemoveDead(unsigned int year, unsigned int t, bool record, double scale, unsigned int deaths[4]);
+	void   McResample(unsigned int year);
+	double ComputeMonteCarlo(Settings *settings);
+
+	bool   HessenbergEigenvalues(NArray<double> &h, int n, std::vector<double> &wr, std::vector<double> &wi);
+	bool   HessenbergDominantEigenpair(NArray<double> &H, unsigned int k, double &lambda, std::vector<double> &y);
+	double ComputeStableDistribution(Settings *settings, NArray<double> &FW_props, NArray<double> &FW_old, NArray<double> &FW_predation, NArray<double> &FW_disease, NArray<double> &FW_starvation, unsigned int t_start_week);
+
 	NArray<double>     _FW_props;	
 	NArray<double>     _FW_predation;
 	NArray<double>     _FW_disease;
@@ -182,10 +286,13 @@ private:
 		(this->*_stoch_hmcn_func)(x_case, y_case, result);
 	}
 
+    bool _low_cost_convergence;	///< Check lambda and convergence on the weekly population totals, see CalcLambdaAndConvergence_Toekoelyi()
+    bool _low_cost_final_check;	///< Check all states once after the low-cost check finished the years
+
     void CalcLambdaAndConvergence(NArray<double> &FW_props, NArray<double> &FW_old ,FwConvResultStruct & result);
     void CalcLambdaAndConvergence_Toekoelyi(NArray<double> &FW_props, NArray<double> &FW_old ,FwConvResultStruct & result);
         
-    double Rand01(void);
+    double Rand01(unsigned int stream, unsigned int year, unsigned int t, unsigned int draw);
 	bool IsNumber(double);
 	bool IsFiniteNumber(double);
     double Mean(std::vector<double> vec);
@@ -194,6 +301,26 @@ private:
 
 	void Init(Settings *settings);
 
+public:
+	/**
+	 * \ingroup SoarLib
+	 * \brief Result structure of ComputeLifeHistory(), all values per independent young of the starting cohort
+	 */
+	struct FwLifeHistoryStruct {
+		double         reproductive_output;	///< Expected number of independent young over the lifetime
+		double         life_expectancy;		///< Expected number of weeks alive, starting with the week of independence
+		double         p_breeding;			///< Probability to start reproduction at least once
+		double         age_first_breeding;	///< Expected age in weeks at the first start of reproduction, if it happens
+		double         p_death[3];			///< Probability of death by predation, disease and depleted reserves
+		double         remaining;			///< Probability to be still alive when the computation stopped
+		std::vector<double> survivorship;	///< Probability to be alive at each full year of age
+		std::vector<double> first_breeding;	///< Probability of the first start of reproduction within each year of age
+		NArray<double> departures;			///< Expected number of migration departures per week x location
+	};
+
+private:
+	FwLifeHistoryStruct _life_history;
+
 public:
     Forward();
     ~Forward();
@@ -202,7 +329,16 @@ public:
 
     double ComputePopulationDynamics(Settings *settings);   
     void   SavePopulationDynamics(char *filename); 
+    NArray<double> & GetPopulationDynamics() { return _FW_props; }  ///< State distribution of the final forward year
     void   SaveMortalityPatterns(char *filename);
+    void   SaveBatchResults(char *filename);
+    void   ComputeLifeHistory(Settings *settings);
+    FwLifeHistoryStruct & GetLifeHistory() { return _life_history; }	///< Life-history metrics of the last ComputeLifeHistory()
+    NArray<double> & GetMarginalOccupancy() { return _marg_occupancy; }	///< Population per action (no care, start, care, migrate) x location x week of the final year
+    NArray<double> & GetMarginalReserves()  { return _marg_reserves; }	///< Population per reserves node x week of the final year
+    NArray<double> & GetMarginalHealth()    { return _marg_health; }	///< Population per health node x week of the final year
+    NArray<double> & GetBatchLambda()       { return _batch_lambda; }	///< Lambda of each start week and start location of a batched run
+    NArray<double> & GetBatchDistribution() { return _batch_props; }	///< Distribution of week 0 of each start week and start location of a batched run
 
 	// -------- NEW (start) ----------------------------------
 	/**
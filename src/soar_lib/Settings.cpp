@@ -48,6 +48,13 @@ Settings::Settings() {
 	_pm.Add(_file_prefix,          "BackwardFilePrefix");
 	_pm.Add(_calibrate_theta,      "BackwardCalibrateTheta");      
 	_pm.Add(_calibrate_theta_min,  "BackwardCalibrateThetaMin", true);
+	_pm.Add(_calibrate_theta_newton, "BackwardCalibrateThetaNewton", true);
+	_pm.Add(_warm_start_file,      "BackwardWarmStartFile", true);
+	_pm.Add(_prune_unreachable,    "BackwardPruneUnreachableStates", true);
+	_pm.Add(_prune_halo,           "BackwardPruneHalo", true);
+	_pm.Add(_low_rank_tol,         "BackwardLowRankTolerance", true);
+	_pm.Add(_low_rank_max,         "BackwardLowRankMaxRank", true);
+	_pm.Add(_decision_layout,      "BackwardDecisionLayout", true);
 	
 	//-- Forward general settings
 	_pm.Add(_n_fw,                 "ForwardMaximumNumberOfIterations");
@@ -55,6 +62,21 @@ Settings::Settings() {
 	_pm.Add(_file_prefix_fw,       "ForwardFilePrefix");
 	_pm.Add(_start_week_fw,        "ForwardStartEpoch");      
 	_pm.Add(_start_loc_fw,         "ForwardStartLocation");
+	_pm.Add(_report_lambda_sensitivity, "ForwardReportLambdaSensitivity", true);
+	_pm.Add(_fw_eigen_solver,      "ForwardEigenSolver", true);
+	_pm.Add(_fw_batch_all_starts,  "ForwardBatchAllStarts", true);
+	_pm.Add(_fw_low_cost_conv,     "ForwardLowCostConvergence", true);
+	_pm.Add(_fw_low_cost_conv_final_check, "ForwardLowCostConvergenceFinalCheck", true);
+	_pm.Add(_fw_save_marginals,    "ForwardSaveMarginals", true);
+	_pm.Add(_fw_save_pop_dynamics, "ForwardSavePopulationDynamics", true);
+	_pm.Add(_fw_report_life_history, "ForwardReportLifeHistory", true);
+#ifdef SUPPORT_FW_MONTE_CARLO
+	_pm.Add(_fw_monte_carlo,       "ForwardUsingMonteCarlo", true);
+	_pm.Add(_fw_mc_cohort_size,    "ForwardMonteCarloStartCohortSize", true);
+	_pm.Add(_fw_mc_lambda_window,  "ForwardMonteCarloAverageLambdaWindow", true);
+	_pm.Add(_fw_mc_seed,           "ForwardMonteCarloSeed", true);
+	_pm.Add(_fw_mc_save_life_history, "ForwardMonteCarloSaveLifeHistory", true);
+#endif
 
 	//-- Grid for time and state variables
 	_pm.Add(_t_cnt,      "DecisionEpochsPerPeriod");
@@ -64,6 +86,8 @@ Settings::Settings() {
 	_pm.Add(_y_min,      "HealthLevelMin",     true); 
 	_pm.Add(_y_max,      "HealthLevelMax",     true); 
 	_pm.Add(_grid_y,     "HealthSubdivisions", true); 
+	_pm.Add(_grid_x_ratio, "ReservesGridSpacingRatio", true);
+	_pm.Add(_grid_y_ratio, "HealthGridSpacingRatio",   true);
 	_pm.Add(_e_max,      "ExperienceMax");
 	_pm.Add(_a_max,      "AgeOfIndependence");
 	_pm.Add(_o_cnt,      "NumberOfLocations");
@@ -81,6 +105,7 @@ Settings::Settings() {
 	_pm.Add(_a_bar,           "AverageFoodSupply",true);
 	_pm.Add(_eps,             "FoodSeasonality",  true);
 	_pm.Add(_env_food_supply, "FoodSupplyCSV",    true); 
+	_pm.Add(_env_years,       "FoodSupplyYears",  true);
 
 	// Alternatives: Either ProbabilityOfActiveFlight or ProbabilityOfActiveFlightCSV
 	_pm.Add(_p_active_flight_const, "ProbabilityOfActiveFlight",    true);	
@@ -150,12 +175,15 @@ Settings::Settings() {
 	_y_min                 = -1;
 	_y_max                 = -1;
 	_grid_y                = 0;
+	_grid_x_ratio          = 1.0;
+	_grid_y_ratio          = 1.0;
 
 	_stoch_add_reserves    = true;
 	_stoch_add_health      = false;
 	_stochfac_x            = -1;
 
 	_p_active_flight_const = -1;
+	_env_years             = 1;
 	_migr_dur              = 0; 
 	_m_migr                = -1;
 
@@ -164,6 +192,41 @@ Settings::Settings() {
 
 	_theta                 = -1;
 	_calibrate_theta_min   = -1;
+	_calibrate_theta_newton    = false;
+	_warm_start_file[0]        = 0;
+	_prune_unreachable         = false;
+	_prune_halo                = 1;
+	_low_rank_tol              = 0;
+	_low_rank_max              = 8;
+	_decision_layout           = 0;
+	_report_lambda_sensitivity = false;
+	_fw_eigen_solver           = false;
+	_fw_batch_all_starts       = false;
+	_fw_low_cost_conv          = false;
+	_fw_low_cost_conv_final_check = false;
+	_fw_save_marginals         = false;
+	_fw_save_pop_dynamics      = true;
+	_fw_report_life_history    = false;
+#ifdef SUPPORT_FW_MONTE_CARLO
+	_fw_monte_carlo            = false;
+	_fw_mc_cohort_size         = 1000;
+	_fw_mc_lambda_window       = 20;
+	_fw_mc_seed                = 1;
+	_fw_mc_save_life_history   = false;
+#endif
+
+	// Scalar parameters whose influence on lambda can be reported by the sensitivity analysis
+	_sens_param[ 0] = &_p_exp;                  _sens_param_name[ 0] = "ProbabilityOfExperienceGrowth";
+	_sens_param[ 1] = &_delta_res_start;        _sens_param_name[ 1] = "ReserveCostsOfStartReproduction";
+	_sens_param[ 2] = &_gamma_incub;            _sens_param_name[ 2] = "ReserveCostsOfIncubation";
+	_sens_param[ 3] = &_gamma_nest;             _sens_param_name[ 3] = "ReserveCostsOfCareForYoung";
+	_sens_param[ 4] = &_delta_cond_start;       _sens_param_name[ 4] = "HealthCostsOfStartReproduction";
+	_sens_param[ 5] = &_fit_indep;              _sens_param_name[ 5] = "FitnessAtIndependence";
+	_sens_param[ 6] = &_c_bmr;                  _sens_param_name[ 6] = "BasalMetabolicRate";
+	_sens_param[ 7] = &_bg_disease;             _sens_param_name[ 7] = "BackgroundMortalityByDisease";
+	_sens_param[ 8] = &_m_migr;                 _sens_param_name[ 8] = "PredationRiskDuringMigration";
+	_sens_param[ 9] = &_p_active_flight_const;  _sens_param_name[ 9] = "ProbabilityOfActiveFlight";
+	_sens_param[10] = &_stochfac_x;             _sens_param_name[10] = "StochasticityFactor";
 }
 
 bool Settings::ValidateSettings()
@@ -288,6 +351,63 @@ bool Settings::ValidateSettings()
 	}
 
 
+	if ( _env_years > 1 ) {
+		// The non-stationary horizon runs each year of the series once, the options
+		// relying on a stationary annual routine are switched off
+		const int checks = 8;
+		bool *flagList[checks] = {
+			&_calibrate_theta,
+			&_calibrate_theta_newton,
+			&_prune_unreachable,
+			&_report_lambda_sensitivity,
+			&_fw_eigen_solver,
+			&_fw_batch_all_starts,
+			&_fw_report_life_history,
+#ifdef SUPPORT_FW_MONTE_CARLO
+			&_fw_monte_carlo
+#else
+			0
+#endif
+		};
+		char *checkList[checks] = {
+			"BackwardCalibrateTheta",
+			"BackwardCalibrateThetaNewton",
+			"BackwardPruneUnreachableStates",
+			"ForwardReportLambdaSensitivity",
+			"ForwardEigenSolver",
+			"ForwardBatchAllStarts",
+			"ForwardReportLifeHistory",
+			"ForwardUsingMonteCarlo"
+		};
+
+		// Allocate and clear outputString
+		char outputString[1024];
+		outputString[0]=0;
+
+		// For each option set in config append '- nameOfParameter\n" to outputString
+		for(int c=0; c<checks;c++)
+		{
+			if (flagList[c] && *flagList[c])
+			{
+				*flagList[c] = false;
+				strcat_s(outputString,"  - ");
+				strcat_s(outputString,checkList[c]);
+				strcat_s(outputString,"\n");
+			}
+		}
+
+		// If something was added to outputString
+		if (outputString[0])
+		{
+			printf("Note: FoodSupplyYears > 1 selects the non-stationary horizon! \n");
+			printf("  The following options are set in config,\n");
+			printf("  but will not come into effect: \n");
+			printf("%s\n",outputString);
+			warn = true;
+		}
+	}
+
+
 	// Check validity of parameters
 	if (_grid_x==0) {
 		printf("Error:  Reserves subdivisions is zero!\n");  
@@ -297,6 +417,10 @@ bool Settings::ValidateSettings()
 		printf("Error:  ReservesMax (%f) needs to be larger than ReservesMin (%f) !\n", _x_max, _x_min);  
 		okay = false;
 	}
+	if (_grid_x_ratio <= 0 || _grid_y_ratio <= 0) {
+		printf("Error:  ReservesGridSpacingRatio (%f) and HealthGridSpacingRatio (%f) need to be larger than zero!\n", _grid_x_ratio, _grid_y_ratio);  
+		okay = false;
+	}
 
 	if (!_stoch_add_reserves && !_stoch_add_health)
 	{
@@ -435,18 +559,149 @@ bool Settings::ValidateSettings()
 		printf("Error:  Set BackwardCalibrateThetaMin >= 0 if BackwardCalibrateTheta = true. \n");  
 		okay = false;
 	}
+	if (_calibrate_theta == false && _calibrate_theta_newton == true) {
+		printf("Note: BackwardCalibrateThetaNewton specified in config, but ineffective since\n");
+		printf("  BackwardCalibrateTheta is FALSE\n");
+		warn = true;
+	}
+	if (_run_backward == false && _warm_start_file[0] != 0) {
+		printf("Note: BackwardWarmStartFile specified in config, but ineffective since\n");
+		printf("  RunBackward is FALSE\n");
+		warn = true;
+	}
+	if (_prune_unreachable == true && _user_init_start_pop == true) {
+		printf("Note: BackwardPruneUnreachableStates specified in config, but ineffective since\n");
+		printf("  UserdefinedInitializationOfStartPopulation is TRUE\n");
+		warn = true;
+	}
+	if (_env_years == 0) {
+		printf("Error:  FoodSupplyYears needs to be >= 1!\n");
+		okay = false;
+	}
+	if (_low_rank_tol < 0 || _low_rank_max < 1 || _low_rank_max > 255) {
+		printf("Error:  BackwardLowRankTolerance (%f) needs to be >=0 and BackwardLowRankMaxRank (%u) within 1..255!\n", _low_rank_tol, _low_rank_max);
+		okay = false;
+	}
+	if (_decision_layout < -1 || _decision_layout > 3) {
+		printf("Error:  BackwardDecisionLayout (%d) needs to be within -1..3 (-1 benchmark, 0 separate, 1 record, 2 experience pair, 3 health first)!\n", _decision_layout);
+		okay = false;
+	}
+	if (_run_forward == false && _report_lambda_sensitivity == true) {
+		printf("Note: ForwardReportLambdaSensitivity specified in config, but ineffective since\n");
+		printf("  RunForward is FALSE\n");
+		warn = true;
+	}
+	if (_run_forward == false && _fw_report_life_history == true) {
+		printf("Note: ForwardReportLifeHistory specified in config, but ineffective since\n");
+		printf("  RunForward is FALSE\n");
+		warn = true;
+	}
+	if (_run_forward == false && _fw_eigen_solver == true) {
+		printf("Note: ForwardEigenSolver specified in config, but ineffective since\n");
+		printf("  RunForward is FALSE\n");
+		warn = true;
+	}
+	if (_fw_low_cost_conv == false && _fw_low_cost_conv_final_check == true) {
+		printf("Note: ForwardLowCostConvergenceFinalCheck specified in config, but ineffective since\n");
+		printf("  ForwardLowCostConvergence is FALSE\n");
+		warn = true;
+	}
+	if (_fw_low_cost_conv == true && (_fw_eigen_solver == true || _fw_batch_all_starts == true)) {
+		printf("Note: ForwardLowCostConvergence specified in config, but ineffective since\n");
+		printf("  ForwardEigenSolver or ForwardBatchAllStarts is TRUE\n");
+		warn = true;
+	}
+	if (_fw_save_marginals == true && (_fw_eigen_solver == true || _fw_batch_all_starts == true)) {
+		printf("Note: ForwardSaveMarginals specified in config, but ineffective since\n");
+		printf("  ForwardEigenSolver or ForwardBatchAllStarts is TRUE\n");
+		warn = true;
+	}
+	if (_fw_batch_all_starts == true) {
+		if (_run_forward == false) {
+			printf("Note: ForwardBatchAllStarts specified in config, but ineffective since\n");
+			printf("  RunForward is FALSE\n");
+			warn = true;
+		}
+		if (_fw_eigen_solver == true) {
+			printf("Note: ForwardEigenSolver specified in config, but ineffective since\n");
+			printf("  ForwardBatchAllStarts is TRUE\n");
+			warn = true;
+		}
+		if (_user_init_start_pop == true) {
+			printf("Note: UserdefinedInitializationOfStartPopulation specified in config, but ineffective since\n");
+			printf("  ForwardBatchAllStarts is TRUE\n");
+			warn = true;
+		}
+		if (_save_mortality_pattern_each_cycle == true || _save_final_mortality_pattern == true) {
+			printf("Note: SaveMortalityPatternEachCycle or SaveFinalMortalityPattern specified in config, but ineffective since\n");
+			printf("  ForwardBatchAllStarts is TRUE\n");
+			warn = true;
+		}
+		if (_report_lambda_sensitivity == true) {
+			printf("Note: ForwardReportLambdaSensitivity specified in config, but ineffective since\n");
+			printf("  ForwardBatchAllStarts is TRUE\n");
+			warn = true;
+		}
+		if (_prune_unreachable == true) {
+			printf("Note: BackwardPruneUnreachableStates specified in config, but ineffective since\n");
+			printf("  ForwardBatchAllStarts is TRUE\n");
+			warn = true;
+		}
+	}
+#ifdef SUPPORT_FW_MONTE_CARLO
+	if (_fw_monte_carlo == false && _fw_mc_save_life_history == true) {
+		printf("Note: ForwardMonteCarloSaveLifeHistory specified in config, but ineffective since\n");
+		printf("  ForwardUsingMonteCarlo is FALSE\n");
+		warn = true;
+	}
+	if (_fw_monte_carlo == true) {
+		if (_fw_mc_cohort_size == 0 || _fw_mc_lambda_window == 0) {
+			printf("Error:  ForwardMonteCarloStartCohortSize (%u) and ForwardMonteCarloAverageLambdaWindow (%u) need to be > 0!\n", _fw_mc_cohort_size, _fw_mc_lambda_window);
+			okay = false;
+		}
+		if (_run_forward == false) {
+			printf("Note: ForwardUsingMonteCarlo specified in config, but ineffective since\n");
+			printf("  RunForward is FALSE\n");
+			warn = true;
+		}
+		if (_fw_eigen_solver == true) {
+			printf("Note: ForwardEigenSolver specified in config, but ineffective since\n");
+			printf("  ForwardUsingMonteCarlo is TRUE\n");
+			warn = true;
+		}
+		if (_user_init_start_pop == true) {
+			printf("Note: UserdefinedInitializationOfStartPopulation specified in config, but ineffective since\n");
+			printf("  ForwardUsingMonteCarlo is TRUE\n");
+			warn = true;
+		}
+		if (_fw_batch_all_starts == true) {
+			printf("Note: ForwardBatchAllStarts specified in config, but ineffective since\n");
+			printf("  ForwardUsingMonteCarlo is TRUE\n");
+			warn = true;
+		}
+		if (_fw_save_marginals == true) {
+			printf("Note: ForwardSaveMarginals specified in config, but ineffective since\n");
+			printf("  ForwardUsingMonteCarlo is TRUE\n");
+			warn = true;
+		}
+	}
+#endif
 
 	if (_env_food_supply.GetSize() != 0) {
 		if (_env_food_supply.GetDims()!=2) {
 			printf("Error:  env_food_supply  dimensionality != 2\n");  
 			okay = false;
 		}
-		else if (_env_food_supply.GetDim(0)!=_t_cnt || _env_food_supply.GetDim(1)!=_o_cnt) {
-			printf("Error:  env_food_supply is %d x %d instead of   %d (timesteps) x %d (location count)\n",_env_food_supply.GetDim(0),_env_food_supply.GetDim(1),_t_cnt,_o_cnt);  	
+		else if (_env_food_supply.GetDim(0)!=_t_cnt*_env_years || _env_food_supply.GetDim(1)!=_o_cnt) {
+			printf("Error:  env_food_supply is %d x %d instead of   %d (timesteps) x %d (location count)\n",_env_food_supply.GetDim(0),_env_food_supply.GetDim(1),_t_cnt*_env_years,_o_cnt);
 			okay = false;
 		}
 	}
 	else {
+		if (_env_years > 1) {
+			printf("Error:  FoodSupplyYears (%u) > 1 needs the series of all years in FoodSupplyCSV\n",_env_years);
+			okay = false;
+		}
 		if (_eps.GetDims()!= 1 || _a_bar.GetDims()!=1) {
 			printf("Error:  FoodSeasonality[%d], AverageFoodSupply[%d] need to be one dimensional\n",_eps.GetDims(),_a_bar.GetDims() );  
 			okay = false;
@@ -492,6 +747,23 @@ void Settings::ComputeDependentParameters()
 	_d_func.SetDy( _bg_disease, 1.0/ _y_max); 
 }
 
+bool Settings::IsSensitivityParamActive(unsigned int idx)
+{
+	double *param = _sens_param[idx];
+
+	// Migration parameters only act on the migration strategy, the constant probability of 
+	// active flight only without the table
+	if (param == &_m_migr)
+		return _enable_migration;
+	if (param == &_p_active_flight_const)
+		return _enable_migration && _p_active_flight.GetSize() == 0 && _p_active_flight_const >= 0;
+	// The stochasticity factor is -1 unless additional stochasticity is enabled
+	if (param == &_stochfac_x)
+		return (_stoch_add_reserves || _stoch_add_health) && _stochfac_x >= 0;
+
+	return true;
+}
+
 bool Settings::FinalizeFileIO(bool ioResult, char *funcName, char *fileName)
 {
 	if (ioResult) {		
@@ -28,11 +28,15 @@
 #ifndef SETTINGS_H
 #define SETTINGS_H
 
+#include <string.h>
+
 #include "..\soar_support_lib\FuncType.h"
 #include "..\soar_support_lib\NArray.h"
 #include "..\soar_support_lib\ParamManager.h"
 
-//#define SUPPORT_FW_MONTE_CARLO
+#define SUPPORT_FW_MONTE_CARLO   ///< Enables the individual-based Monte Carlo forward simulation
+
+#define SENSITIVITY_PARAM_CNT 11   ///< Number of scalar parameters available for the lambda sensitivity analysis
 
 /**
 * \defgroup SoarLib sOAR_Lib
@@ -66,11 +70,29 @@ private:
 	bool     _enable_health_dim;   ///< Enable health dimension
 	bool     _calibrate_theta;     ///< Backward calibrate theta
 	double   _calibrate_theta_min; ///< Minimum theta for calibration
+	bool     _calibrate_theta_newton;    ///< Backward calibrate theta with Newton steps instead of Brent optimization
+	bool     _report_lambda_sensitivity; ///< Report the sensitivity of lambda to the scalar parameters after the forward run
+	bool     _fw_eigen_solver;     ///< Forward computes lambda and the stable distribution by an eigen solver instead of iterating years
+	bool     _fw_batch_all_starts; ///< Forward projects the starting cohorts of all start epochs and locations in a single run
+	bool     _fw_low_cost_conv;    ///< Forward checks lambda and convergence on the weekly population totals instead of all states
+	bool     _fw_low_cost_conv_final_check; ///< Forward checks all states once after the low-cost convergence check
+	bool     _fw_save_marginals;   ///< Forward saves the occupancy, reserves and health marginals of each week and year
+	bool     _fw_save_pop_dynamics; ///< Forward saves the full state distribution
+	bool     _fw_report_life_history; ///< Forward reports the life-history metrics of an independent young
+#ifdef SUPPORT_FW_MONTE_CARLO
+	bool         _fw_monte_carlo;        ///< Forward simulates individuals instead of the state distribution
+	unsigned int _fw_mc_cohort_size;     ///< Number of individuals of the Monte Carlo starting cohort
+	unsigned int _fw_mc_lambda_window;   ///< Number of final years averaged for the Monte Carlo lambda
+	unsigned int _fw_mc_seed;            ///< Seed of the Monte Carlo random numbers
+	bool         _fw_mc_save_life_history; ///< Save the life-history events of the Monte Carlo individuals
+#endif
 
 	unsigned int _n;      ///< Maximum number of periods in backward iteration (eg years)
     unsigned int _t_cnt;  ///< Decision epochs per period (eg number of timesteps per year)
 	unsigned int _grid_x; ///< Reserves subdivisions
 	unsigned int _grid_y; ///< Health   subdivisions
+	double _grid_x_ratio; ///< Width ratio of consecutive reserves intervals, 1.0 for a uniform grid
+	double _grid_y_ratio; ///< Width ratio of consecutive health intervals, 1.0 for a uniform grid
 
 	double _x_min;		  ///< Reserves min 
 	double _x_max;		  ///< Reserves max
@@ -101,6 +123,7 @@ private:
 	NArray<double> _eps;             ///< Average food supply
 	NArray<double> _a_bar;           ///< Food seasonality
 	NArray<double> _env_food_supply; ///< Food supply per decision epoch and location
+	unsigned int   _env_years;       ///< Number of consecutive years in the food supply series, > 1 selects the non-stationary horizon
 
 	unsigned int    _migr_dur;    ///< Duration of migration
 	double _m_migr;               ///< Predation risk during migration per decision epoch
@@ -135,6 +158,12 @@ private:
 	FuncType _migr_pas_x_func;        ///< Reserve dependency of passive flight
 
 	char _file_prefix[512];           ///< File prefix for output of backward iteration
+	char _warm_start_file[512];       ///< Decision file of an earlier backward run used to initialize f (optional)
+	bool         _prune_unreachable;  ///< Backward optimizes only states reachable from the forward starting cohort
+	unsigned int _prune_halo;         ///< Grid points added around the reachable reserves and health
+	double       _low_rank_tol;       ///< Relative error of the low-rank reserves-health slices of f, 0 stores f densely
+	unsigned int _low_rank_max;       ///< Maximum rank of the low-rank reserves-health slices of f
+	int          _decision_layout;    ///< Storage layout of the decision state arrays (DC_LAYOUT_...), -1 selects it by a benchmark
 
 
     unsigned int _n_fw;               ///< Maximum number of iteration years in forward computation
@@ -161,6 +190,12 @@ private:
 
 	///@} End of group started by \name
 
+	/// \name Scalar parameters available for the lambda sensitivity analysis
+	/// @{ 
+	double * _sens_param[SENSITIVITY_PARAM_CNT];      ///< References the scalar parameters
+	const char * _sens_param_name[SENSITIVITY_PARAM_CNT]; ///< Names of the scalar parameters in the config
+	///@} End of group started by \name
+
 
 	void ComputeDependentParameters();
 
@@ -195,9 +230,9 @@ public:
 	
 	/// \name Setters
 	/// @{ 
-	void SetUserInitStartPop(bool userinitstartpop)  { _user_init_start_pop; } 
-	void SetSaveMortalityPatternEachCycle(bool savemortalitypatterneachcycle) { _save_mortality_pattern_each_cycle; }
-	void SetSaveFinalMortalityPattern(bool savefinalmortalitypattern) { _save_final_mortality_pattern; }
+	void SetUserInitStartPop(bool userinitstartpop)  { _user_init_start_pop = userinitstartpop; } 
+	void SetSaveMortalityPatternEachCycle(bool savemortalitypatterneachcycle) { _save_mortality_pattern_each_cycle = savemortalitypatterneachcycle; }
+	void SetSaveFinalMortalityPattern(bool savefinalmortalitypattern) { _save_final_mortality_pattern = savefinalmortalitypattern; }
 	void SetN(unsigned int n)			{ _n = n; }                 ///< Set number of years for backward computation
 	void SetNMin(unsigned int nmin)     { _n_min = nmin; }
     void SetNFW(unsigned int n)		    { _n_fw = n; }              ///< Set number of years for forward computation
@@ -206,6 +241,8 @@ public:
 
 	void SetGridX(unsigned int x)		{ _grid_x = x; ComputeDependentParameters(); }
 	void SetGridY(unsigned int y)		{ _grid_y = y; ComputeDependentParameters(); }
+	void SetGridXRatio(double r)		{ _grid_x_ratio = r; }
+	void SetGridYRatio(double r)		{ _grid_y_ratio = r; }
 	void SetXMin(double v)				{ _x_min = v; ComputeDependentParameters(); }
 	void SetXMax(double v)				{ _x_max = v; ComputeDependentParameters(); }
 	void SetYMin(double v)				{ _y_min = v; ComputeDependentParameters(); }
@@ -217,6 +254,11 @@ public:
 
 
     void SetTheta(double t)				{ _theta = t; }
+	void SetWarmStartFile(char *filename) { strcpy_s(_warm_start_file, filename); }
+	void SetPruneUnreachableStates(bool p) { _prune_unreachable = p; }
+	void SetPruneHalo(unsigned int h)   { _prune_halo = h; }
+	void SetLowRank(double tol, unsigned int max_rank) { _low_rank_tol = tol; _low_rank_max = max_rank; }
+	void SetDecisionLayout(int layout)  { _decision_layout = layout; }
     void SetPexp(double p)				{ _p_exp = p; }
 	void SetNBrood(unsigned int n)		{ _n_brood = n; }
 	void SetGammaIncub(double gi)		{ _gamma_incub = gi; }
@@ -232,8 +274,9 @@ public:
 	void SetMMigr(double mMigr)               { _m_migr = mMigr; }
 	
 	void SetPActiveFlightConst(double pActiveFlightConst) { _p_active_flight_const = pActiveFlightConst; }
-	void SetPActiveFlight(NArray<double> pActiveFlight) { _p_active_flight = pActiveFlight;}
-	void SetEnvFoodSupply(NArray<double> envFoodSupply) { _env_food_supply = envFoodSupply;}
+	void SetPActiveFlight(const NArray<double> &pActiveFlight) { _p_active_flight = pActiveFlight;}
+	void SetEnvFoodSupply(const NArray<double> &envFoodSupply) { _env_food_supply = envFoodSupply;}
+	void SetEnvYears(unsigned int years)                { _env_years = years; }
 
 	void SetEnvironment(NArray<double> &eps,NArray<double> &abar) {
 		_eps   = eps; 
@@ -248,6 +291,22 @@ public:
     
 	void SetIncubation(unsigned int inc)	{ _incubation = inc; ComputeDependentParameters(); }
 
+	void SetStartWeekFW(unsigned int week)    { _start_week_fw = week; }
+	void SetStartLocationFW(unsigned int loc) { _start_loc_fw = loc; }
+	void SetForwardEigenSolver(bool e)        { _fw_eigen_solver = e; }
+	void SetForwardBatchAllStarts(bool b)     { _fw_batch_all_starts = b; }
+	void SetForwardLowCostConvergence(bool c) { _fw_low_cost_conv = c; }
+	void SetForwardLowCostConvergenceFinalCheck(bool c) { _fw_low_cost_conv_final_check = c; }
+	void SetForwardSaveMarginals(bool m)      { _fw_save_marginals = m; }
+	void SetForwardSavePopulationDynamics(bool p) { _fw_save_pop_dynamics = p; }
+	void SetForwardReportLifeHistory(bool r)  { _fw_report_life_history = r; }
+#ifdef SUPPORT_FW_MONTE_CARLO
+	void SetForwardUsingMonteCarlo(bool mc)                    { _fw_monte_carlo = mc; }
+	void SetForwardMonteCarloStartCohortSize(unsigned int n)   { _fw_mc_cohort_size = n; }
+	void SetForwardMonteCarloSeed(unsigned int seed)           { _fw_mc_seed = seed; }
+	void SetForwardMonteCarloSaveLifeHistory(bool save)        { _fw_mc_save_life_history = save; }
+#endif
+
 	void SetCFuncBmr(double bmr)	{ _c_bmr = bmr; }
 
 	///@} End of group started by \name
@@ -269,6 +328,28 @@ public:
 	char  *GetFilePrefix()		  { return _file_prefix; }
 	bool   GetCalibrateTheta()        { return _calibrate_theta; }
 	double GetCalibrationThetaMin()   { return _calibrate_theta_min; }
+	bool   GetCalibrateThetaNewton()  { return _calibrate_theta_newton; }
+	char  *GetWarmStartFile()         { return _warm_start_file; }
+	bool   GetPruneUnreachableStates(){ return _prune_unreachable; }
+	unsigned int GetPruneHalo()       { return _prune_halo; }
+	double GetLowRankTolerance()      { return _low_rank_tol; }
+	unsigned int GetLowRankMaxRank()  { return _low_rank_max; }
+	int    GetDecisionLayout()        { return _decision_layout; }
+	bool   GetReportLambdaSensitivity() { return _report_lambda_sensitivity; }
+	bool   GetForwardEigenSolver()    { return _fw_eigen_solver; }
+	bool   GetForwardBatchAllStarts() { return _fw_batch_all_starts; }
+	bool   GetForwardLowCostConvergence() { return _fw_low_cost_conv; }
+	bool   GetForwardLowCostConvergenceFinalCheck() { return _fw_low_cost_conv_final_check; }
+	bool   GetForwardSaveMarginals()  { return _fw_save_marginals; }
+	bool   GetForwardSavePopulationDynamics() { return _fw_save_pop_dynamics; }
+	bool   GetForwardReportLifeHistory() { return _fw_report_life_history; }
+#ifdef SUPPORT_FW_MONTE_CARLO
+	bool         GetForwardUsingMonteCarlo()               { return _fw_monte_carlo; }
+	unsigned int GetForwardMonteCarloStartCohortSize()     { return _fw_mc_cohort_size; }
+	unsigned int GetForwardMonteCarloAverageLambdaWindow() { return _fw_mc_lambda_window; }
+	unsigned int GetForwardMonteCarloSeed()                { return _fw_mc_seed; }
+	bool         GetForwardMonteCarloSaveLifeHistory()     { return _fw_mc_save_life_history; }
+#endif
 
         unsigned int GetNFW()			   { return _n_fw; }
 	unsigned int GetNMinFW()		   { return _n_min_fw; }	
@@ -279,6 +360,8 @@ public:
         unsigned int GetTCnt()		{ return _t_cnt; }
 	unsigned int GetGridX()		{ return _grid_x; }
 	unsigned int GetGridY()		{ return _grid_y; }
+	double	GetGridXRatio()		{ return _grid_x_ratio; }
+	double	GetGridYRatio()		{ return _grid_y_ratio; }
 
 	double	GetXMin()			{ return _x_min; }
 	double	GetXMax()			{ return _x_max; }
@@ -317,8 +400,8 @@ public:
 	unsigned int GetMigrDur()   { return _migr_dur; }
 	double  GetMMigr()          { return _m_migr; }
 
-	NArray<double> GetEps()   { return _eps; }
-	NArray<double> GetABar()  { return _a_bar; }
+	NArray<double> & GetEps()  { return _eps; }
+	NArray<double> & GetABar() { return _a_bar; }
 	
 	double	GetCrit()			{ return _crit; }
 	bool    GetStochAddReserves()  { return _stoch_add_reserves; }
@@ -330,6 +413,7 @@ public:
 	double GetPActiveFlightConst() { return _p_active_flight_const; }
 	NArray<double> & GetPActiveFlight() { return _p_active_flight; }
 	NArray<double> & GetEnvFoodSupply() { return _env_food_supply; }
+	unsigned int GetEnvYears()          { return _env_years; }
 	///@} End of group started by \name
 
 	/// \name Getters for FuncType references
@@ -350,6 +434,16 @@ public:
 	FuncType & DCondMigrPas()   { return _dcond_migr_pas; }	
 
 	///@} End of group started by \name
+
+	/// \name Access to the scalar parameters of the lambda sensitivity analysis
+	/// @{ 
+	unsigned int GetSensitivityParamCount()            { return SENSITIVITY_PARAM_CNT; }
+	const char * GetSensitivityParamName(unsigned int idx) { return _sens_param_name[idx]; }
+	double GetSensitivityParam(unsigned int idx)       { return *_sens_param[idx]; }
+	/// \brief Returns FALSE if the parameter is unset or has no effect in the current configuration
+	bool   IsSensitivityParamActive(unsigned int idx);
+	void   SetSensitivityParam(unsigned int idx, double v) { *_sens_param[idx] = v; ComputeDependentParameters(); }
+	///@} End of group started by \name
 };
 
 #endif // SETTINGS_H
@@ -63,7 +63,7 @@ double StateFuncs::Env(int o, int t) {
 	    return(_eps[o] * sin( (t - (_t_max / 4.0)) * 2.0 * M_PI / _t_max ) + _a_bar[o]) * (_x_max - _x_min);
 	}
 	else {
-		return _env_food_supply(t,o);
+		return _env_food_supply(_env_year*_t_max + t,o);
 	}
 }
 
@@ -187,6 +187,9 @@ void StateFuncs::InitStateFuncs(Settings *settings, double theta) {
 	
 	int incub = settings->GetIncubation();    
 	int a_cnt = settings->GetACnt();
+	if (_gamma_brood_ind) {
+		delete [] _gamma_brood_ind;
+	}
 	_gamma_brood_ind = new double[ a_cnt ];
     _gamma_brood_ind[0] = 0;
 	for (int a=1;a<a_cnt;a++) {
@@ -225,6 +228,9 @@ void StateFuncs::InitStateFuncs(Settings *settings, double theta) {
 	_p_active_flight_const = settings->GetPActiveFlightConst();
 	_p_active_flight       = settings->GetPActiveFlight();
 	_env_food_supply       = settings->GetEnvFoodSupply();
+
+	// Beyond the horizon the environment of the final year continues
+	_env_year              = settings->GetEnvYears() - 1;
 }
    
 void StateFuncs::PrintFuncs() {
@@ -286,6 +292,7 @@ void StateFuncs::PrintFuncs() {
 
 StateFuncs::StateFuncs() {
 	_gamma_brood_ind = 0;
+	_env_year        = 0;
 }
 
 StateFuncs::~StateFuncs() {	
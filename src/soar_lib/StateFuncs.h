@@ -89,6 +89,7 @@ private:
 	double _p_active_flight_const;	  ///< Probability of active flight (if no CSV array is given)
 	NArray<double> _p_active_flight;  ///< Probability of active flight array (time, location)
 	NArray<double> _env_food_supply;  ///< Food supply per decision epoch and location
+	unsigned int   _env_year;         ///< Year of the food supply series used by Env()
 
 	FuncType _c_bmr_x_func;		///< Reserve dependency of BMR
 	FuncType _c_u_func;			///< Activity dependency of metabolism
@@ -137,6 +138,9 @@ protected:
 	double Y_m (double x, double y, int e, int o, int s, double u, int t);        
 
 	void InitStateFuncs(Settings *settings, double theta);
+
+	/// \brief Selects the year of a multi-year food supply series, InitStateFuncs() selects the final one
+	void SetEnvYear(unsigned int year)	{	_env_year = year;	}
 public:
 	StateFuncs();
 	~StateFuncs();
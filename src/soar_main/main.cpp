@@ -58,6 +58,10 @@ private:
 
 	char _filename_fw_dec[FILENAME_MAX];
 	char _filename_fw_pd[FILENAME_MAX];  // PopulationDynamics
+	char _filename_fw_sens[FILENAME_MAX];  // Sensitivity of lambda
+	char _filename_fw_mp[FILENAME_MAX];    // Final mortality pattern
+	char _filename_fw_batch[FILENAME_MAX]; // Lambdas and distributions of all start epochs and locations
+	char _filename_fw_lh[FILENAME_MAX];    // Life-history metrics
 
 #ifdef GENERATE_DOXYGEN_DOC
 	Forward         * doxygen;  ///< DOXYGEN: Main() does a forward simulation
@@ -123,6 +127,10 @@ private:
 
 		sprintf_s(_filename_fw_dec, "%s_decision_FW.bin", _settings->GetFilePrefixFW());  
 		sprintf_s(_filename_fw_pd , "%s_populationdynamics_FW.bin", _settings->GetFilePrefixFW());  
+		sprintf_s(_filename_fw_sens, "%s_sensitivity_FW.txt", _settings->GetFilePrefixFW());  
+		sprintf_s(_filename_fw_mp  , "%s_mortality_FW.bin", _settings->GetFilePrefixFW());
+		sprintf_s(_filename_fw_batch, "%s_batch_FW.bin", _settings->GetFilePrefixFW());
+		sprintf_s(_filename_fw_lh  , "%s_lifehistorymetrics_FW.txt", _settings->GetFilePrefixFW());
 
 		_decision = new Decision();
 
@@ -234,6 +242,161 @@ private:
 		printf("    Corresponding lambda_state: %f\n",lambda_state);
 	}
 
+
+	void RunNewtonIterationToCalibrateTheta() {
+		Backward bwOpt;
+
+		bwOpt.SetDecision( _decision);
+
+		// Newton steps on lambda(theta) - 1 = 0, the derivative d lambda / d theta is obtained from
+		// one forward run via eigenvalue perturbation instead of additional backward runs
+		const int maxIter  = 20;
+		double    thetaMin = _settings->GetCalibrationThetaMin();
+		double    theta    = _settings->GetTheta();
+		if (theta < thetaMin || theta > 1.0) {
+			theta = 0.5 * (thetaMin + 1.0);
+		}
+
+		int    bwIter = 0;
+		int    iter   = 1;
+		double lambda = 0;
+		while (true) {
+			printf("\nCalibrateThetaNewton %d: Solving for Theta=%f \n",iter, theta);
+			printf("-------------------------------------------\n");
+
+			_decision->Reset(); // Start Backward iterations with a fresh, un-initialized decision state
+
+			lambda  = bwOpt.Compute(_settings, theta);
+			bwIter += _decision->GetYear();
+
+			if (fabs(lambda - 1.0) < _settings->GetCrit() || iter >= maxIter)
+				break;
+
+			Forward fwOpt;
+			fwOpt.SetDecision( _decision );
+			fwOpt.ComputePopulationDynamics( _settings);
+
+			double dlambda = bwOpt.ComputeThetaSensitivity(_settings, fwOpt.GetPopulationDynamics() );
+			printf("........... dLambda/dTheta = %f\n",dlambda);
+
+			if (!(fabs(dlambda) > 0.0) ) {
+				printf("Warning:  Lambda does not depend on theta, Newton iteration stopped!\n");
+				break;
+			}
+
+			double thetaNew = theta - (lambda - 1.0) / dlambda;
+			if (thetaNew < thetaMin)
+				thetaNew = thetaMin;
+			if (thetaNew > 1.0)
+				thetaNew = 1.0;
+
+			if (fabs(thetaNew - theta) < 1.0e-10)
+				break;
+
+			theta = thetaNew;
+			iter++;
+		}
+
+		double lambda_state = _decision->GetLambdaState();
+		printf("\n\n");
+		printf("============================================================\n");
+		printf("    Using %d Newton and %d Backward iterations:\n\n", iter, bwIter);
+		printf("        Best theta found: %f  ()\n\n", theta );
+		printf("    Corresponding lambda:       %f\n",lambda);
+		printf("    Corresponding lambda_state: %f\n",lambda_state);
+	}
+
+
+	void ReportLambdaSensitivity(Forward &fwOpt) {
+		Backward bwOpt;
+
+		bwOpt.SetDecision( _decision);
+
+		FILE *file = 0;
+		fopen_s(&file,_filename_fw_sens,"w");
+		if (file==0) {
+			printf("ReportLambdaSensitivity(%s) error opening the file for writing\n",_filename_fw_sens);
+			return;
+		}
+
+		double lambda = _decision->GetLambda();
+		double theta  = _decision->GetTheta();
+		double dTheta = bwOpt.ComputeThetaSensitivity(_settings, fwOpt.GetPopulationDynamics() );
+
+		printf("\n");
+		printf("%-36s %12s %16s %12s\n","Parameter","Value","dLambda/dParam","Elasticity");
+		fprintf(file,"%s;%s;%s;%s\n","Parameter","Value","dLambda/dParam","Elasticity");
+
+		printf("%-36s %12g %16g %12g\n","Theta",theta,dTheta,dTheta*theta/lambda);
+		fprintf(file,"%s;%g;%g;%g\n","Theta",theta,dTheta,dTheta*theta/lambda);
+
+		for(unsigned int i=0; i<_settings->GetSensitivityParamCount(); i++) {
+			const char *name = _settings->GetSensitivityParamName(i);
+
+			// Unset parameters and parameters without effect in this configuration have no derivative
+			if (!_settings->IsSensitivityParamActive(i)) {
+				printf("%-36s %12s   (skipped, unset or inactive in this configuration)\n",name,"-");
+				continue;
+			}
+
+			double value = _settings->GetSensitivityParam(i);
+			double dVal  = bwOpt.ComputeParamSensitivity(_settings, fwOpt.GetPopulationDynamics(), i);
+
+			printf("%-36s %12g %16g %12g\n",name,value,dVal,dVal*value/lambda);
+			fprintf(file,"%s;%g;%g;%g\n",name,value,dVal,dVal*value/lambda);
+		}
+
+		fclose(file);
+	}
+
+	void ReportLifeHistory(Forward &fwOpt) {
+
+		fwOpt.ComputeLifeHistory(_settings);
+		Forward::FwLifeHistoryStruct &lh = fwOpt.GetLifeHistory();
+
+		FILE *file = 0;
+		fopen_s(&file,_filename_fw_lh,"w");
+		if (file==0) {
+			printf("ReportLifeHistory(%s) error opening the file for writing\n",_filename_fw_lh);
+			return;
+		}
+
+		printf("\n");
+		printf("%-36s %12g\n","Lifetime reproductive output",lh.reproductive_output);
+		printf("%-36s %12g\n","Life expectancy [weeks]",lh.life_expectancy);
+		printf("%-36s %12g\n","Probability of breeding",lh.p_breeding);
+		printf("%-36s %12g\n","Age at first breeding [weeks]",lh.age_first_breeding);
+		printf("%-36s %12g\n","Probability of death by predation",lh.p_death[0]);
+		printf("%-36s %12g\n","Probability of death by disease",lh.p_death[1]);
+		printf("%-36s %12g\n","Probability of death by starvation",lh.p_death[2]);
+
+		fprintf(file,"%s;%g\n","LifetimeReproductiveOutput",lh.reproductive_output);
+		fprintf(file,"%s;%g\n","LifeExpectancy",lh.life_expectancy);
+		fprintf(file,"%s;%g\n","ProbabilityOfBreeding",lh.p_breeding);
+		fprintf(file,"%s;%g\n","AgeAtFirstBreeding",lh.age_first_breeding);
+		fprintf(file,"%s;%g\n","ProbabilityOfDeathByPredation",lh.p_death[0]);
+		fprintf(file,"%s;%g\n","ProbabilityOfDeathByDisease",lh.p_death[1]);
+		fprintf(file,"%s;%g\n","ProbabilityOfDeathByStarvation",lh.p_death[2]);
+		fprintf(file,"%s;%g\n","ProbabilityRemaining",lh.remaining);
+
+		fprintf(file,"\n%s;%s;%s\n","AgeInYears","Survivorship","FirstBreeding");
+		for (unsigned int i=0;i<lh.survivorship.size();i++)
+			fprintf(file,"%d;%g;%g\n",i,lh.survivorship[i],lh.first_breeding[i]);
+
+		fprintf(file,"\n%s","Week");
+		for (unsigned int o=0;o<lh.departures.GetDim(1);o++)
+			fprintf(file,";DeparturesLocation%d",o+1);
+		fprintf(file,"\n");
+		for (unsigned int t=0;t<lh.departures.GetDim(0);t++) {
+			fprintf(file,"%d",t);
+			for (unsigned int o=0;o<lh.departures.GetDim(1);o++)
+				fprintf(file,";%g",lh.departures(t,o));
+			fprintf(file,"\n");
+		}
+
+		fclose(file);
+	}
+
 public:
 
 	~Main() {
@@ -253,7 +416,10 @@ public:
 			NanoTimer timerTotal;
 			timerTotal.Start();       
 
-			if ( _settings->GetCalibrateTheta() ) {
+			if ( _settings->GetCalibrateTheta() && _settings->GetCalibrateThetaNewton() ) {
+				RunNewtonIterationToCalibrateTheta();
+			}
+			else if ( _settings->GetCalibrateTheta() ) {
 				RunBackwardSimulationToOptimizeForTheta();
 			}
 			else {
@@ -262,7 +428,13 @@ public:
 				bwOpt.SetDecision(_decision);
 
 				double theta = _settings->GetTheta();				
-				double lambda = bwOpt.Compute(_settings, theta);
+				double lambda;
+				if (_settings->GetEnvYears() > 1) {
+					lambda = bwOpt.ComputeHorizon(_settings, theta);  // Policies of all years are saved year by year
+				}
+				else {
+					lambda = bwOpt.Compute(_settings, theta);
+				}
 				printf("\n");
 				printf("      Backward lambda found: %.4f\n\n",lambda);
 			}
@@ -313,13 +485,19 @@ public:
 		
 			{
 				lambda = fwOpt.ComputePopulationDynamics( _settings);  // cf. Toekoelyi
-				if (_settings->GetUserInitStartPop()) {
-					sprintf_s(_filename_fw_pd, "%s_populationdynamics_FW_finalYear.bin", _settings->GetFilePrefixFW());
-					fwOpt.SavePopulationDynamics(_filename_fw_pd);
+				bool batch = fwOpt.GetBatchLambda().GetSize() > 0;
+				if (batch) {
+					fwOpt.SaveBatchResults(_filename_fw_batch);
 				}
-				else {
+				else if (_settings->GetForwardSavePopulationDynamics()) {
+					if (_settings->GetUserInitStartPop()) {
+						sprintf_s(_filename_fw_pd, "%s_populationdynamics_FW_finalYear.bin", _settings->GetFilePrefixFW());
+					}
 					fwOpt.SavePopulationDynamics(_filename_fw_pd);
 				}
+				if (_settings->GetSaveFinalMortalityPattern() && !batch) {
+					fwOpt.SaveMortalityPatterns(_filename_fw_mp);
+				}
 			}
 
 
@@ -332,8 +510,22 @@ public:
 			float time = timerTotal.GetNanoSeconds()/1000;
 			printf("Forward computation time:  %10.3f mSec\n",time );
 
-			printf("\n ... saving forward results to file ...\n");
-			_decision->SaveToFile(_filename_fw_dec); 
+			if (_settings->GetReportLambdaSensitivity() && fwOpt.GetPopulationDynamics().GetSize() > 0) {
+				printf("\n ... computing sensitivity of lambda ...\n");
+				ReportLambdaSensitivity(fwOpt);
+			}
+
+			if (_settings->GetForwardReportLifeHistory() ) {
+				printf("\n ... computing life-history metrics ...\n");
+				ReportLifeHistory(fwOpt);
+			}
+
+			// In the horizon the decision holds the policy of the last forward year next to the f of year 0,
+			// the policies of all years stay in their own files
+			if (_settings->GetEnvYears() == 1) {
+				printf("\n ... saving forward results to file ...\n");
+				_decision->SaveToFile(_filename_fw_dec); 
+			}
 
 			printf("\n ...done... \n");
 		}
@@ -0,0 +1,180 @@
+/**
+* \file GridAxis.h
+* \brief Declaration and inline implementation of class GridAxis
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef GRIDAXIS_H
+#define GRIDAXIS_H
+
+#include <Math.h>
+
+#include "NArray.h"
+
+#define GRIDAXIS_LOOKUP_PER_NODE 16		///< Maximum number of lookup bins per grid interval of a non-uniform axis
+
+/**
+* \ingroup SoarSupport
+*
+* \brief One dimensional grid of nodes with O(1) lookup of the lower node for a value.
+*
+* The grid spans [min,max] with the given number of intervals. With a spacing ratio of 1 the
+* nodes are uniform, otherwise each interval is ratio times as wide as the previous one.
+* A ratio above 1 therefore refines the grid near min, for instance near starvation at x=0.
+*
+* The lower node of a uniform grid is found arithmetically. For a non-uniform grid a lookup
+* table over equally wide bins stores the lower node of each bin start, so at most a few
+* nodes follow inside a bin.
+*
+* \code
+*   GridAxis grid;
+*   grid.Init( 0.0, 10.0, 20, 1.2);    // 21 nodes, refined near 0
+*
+*   int    i = grid.LowerIndex(x);    // last node <= x, within 0..20
+*   double p = (x - grid[i]) * grid.InverseSpacing(i);
+* \endcode
+*
+* <H2 class="groupheader">Include</H2>
+*/
+class GridAxis {
+private:
+	double          _min;			///< Value of the first node
+	double          _max;			///< Value of the last node
+	unsigned int    _cnt;			///< Number of nodes
+	double          _ratio;			///< Width ratio of consecutive intervals
+	bool            _uniform;		///< All intervals are of the same width
+	double          _inv_d;			///< Inverse interval width of a uniform grid
+
+	NArray<double>  _nodes;			///< Node values
+	NArray<double>  _inv_spacing;	///< Inverse width of the interval starting at each node (last node: previous interval)
+
+	NArray<int>     _lookup;		///< Lower node of each lookup bin start (non-uniform grid only)
+	double          _inv_bin;		///< Inverse width of a lookup bin
+
+public:
+	/// \brief Constructor
+	GridAxis() : _min(0), _max(0), _cnt(0), _ratio(1.0), _uniform(true), _inv_d(0), _inv_bin(0) {
+	}
+
+	/**
+	 * \brief Initializes the nodes and the lookup table
+	 * \param min        Value of the first node
+	 * \param max        Value of the last node
+	 * \param intervals  Number of intervals, the grid has intervals+1 nodes
+	 * \param ratio      Width ratio of consecutive intervals, 1.0 for a uniform grid
+	 */
+	void Init(double min, double max, unsigned int intervals, double ratio=1.0) {
+		_min     = min;
+		_max     = max;
+		_cnt     = intervals + 1;
+		_ratio   = ratio;
+		_uniform = (intervals < 2) || fabs(ratio - 1.0) < 1.0e-12;
+
+		_nodes.Init(_cnt);
+		_inv_spacing.Init(_cnt);
+
+		if (_uniform) {
+			double d = (intervals>0) ? (max-min) / (double)intervals : 0.000000001;
+			_inv_d   = 1.0 / d;
+			for (unsigned int i=0;i<_cnt;i++) {
+				_nodes[i]       = min + i*d;
+				_inv_spacing[i] = _inv_d;
+			}
+			_lookup.Init(1);
+			_inv_bin = 0;
+			return;
+		}
+
+		// Geometric widths d0 * ratio^i summing up to max-min
+		double d = (max-min) * (ratio-1.0) / (pow(ratio,(double)intervals) - 1.0);
+		double d_min = d;
+		_nodes[0] = min;
+		for (unsigned int i=1;i<_cnt;i++) {
+			_nodes[i] = _nodes[i-1] + d;
+			if (d < d_min)
+				d_min = d;
+			d *= ratio;
+		}
+		_nodes[_cnt-1] = max;	// Avoid rounding errors at the last node
+
+		for (unsigned int i=0;i<_cnt-1;i++)
+			_inv_spacing[i] = 1.0 / (_nodes[i+1]-_nodes[i]);
+		_inv_spacing[_cnt-1] = _inv_spacing[_cnt-2];
+
+		// Bins as wide as the finest interval, limited in number for strongly refined grids
+		unsigned int bins = (unsigned int)ceil( (max-min) / d_min );
+		if (bins > GRIDAXIS_LOOKUP_PER_NODE * intervals)
+			bins = GRIDAXIS_LOOKUP_PER_NODE * intervals;
+		_inv_bin = bins / (max-min);
+
+		_lookup.Init(bins+1);
+		unsigned int node = 0;
+		for (unsigned int b=0;b<=bins;b++) {
+			double v = min + b / _inv_bin;
+			while (node+1 < _cnt && _nodes[node+1] <= v)
+				node++;
+			_lookup[b] = node;
+		}
+	}
+
+	/// \brief Returns the number of nodes
+	unsigned int GetCount()        { return _cnt; }
+
+	/// \brief Returns the width ratio of consecutive intervals
+	double GetRatio()              { return _ratio; }
+
+	/// \brief Returns TRUE for a grid of equally wide intervals
+	bool IsUniform()               { return _uniform; }
+
+	/// \brief Returns the value of node i
+	double operator[](unsigned int i)     { return _nodes[i]; }
+
+	/// \brief Returns the inverse width of the interval starting at node i (the last node returns the previous interval)
+	double InverseSpacing(unsigned int i) { return _inv_spacing[i]; }
+
+	/**
+	 * \brief Returns the index of the last node <= v, limited to 0.._cnt-1
+	 *
+	 * The uniform case uses the same arithmetic as the original fixed dx grids.
+	 */
+	int LowerIndex(double v) {
+		if (_uniform) {
+			int i = (int)((v-_min) * _inv_d);
+			if (i >= (int)_cnt)
+				i = _cnt-1;
+			if (i < 0)
+				i = 0;
+			return i;
+		}
+
+		if (v <= _min)
+			return 0;
+		if (v >= _max)
+			return _cnt-1;
+
+		int i = _lookup[ (unsigned int)((v-_min) * _inv_bin) ];
+		while (i+1 < (int)_cnt && _nodes[i+1] <= v)
+			i++;
+		return i;
+	}
+};
+
+#endif // GRIDAXIS_H
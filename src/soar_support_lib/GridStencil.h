@@ -0,0 +1,170 @@
+/**
+* \file GridStencil.h
+* \brief Declaration and inline implementation of the GridStencil templates
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef GRIDSTENCIL_H
+#define GRIDSTENCIL_H
+
+#include "GridAxis.h"
+
+/**
+* \ingroup SoarSupport
+*
+* \brief Nodes and weights of the interpolation of a value onto one GridAxis.
+*
+* A stencil of width 2 interpolates linearly between the lower and the upper node. A stencil
+* of width 4 adds the stochasticity of Houston and McNamara (1999): the factor stochfac of the
+* weight of each of the two nodes is moved to its outer neighbour. Nodes outside of the grid
+* are replaced by the first or last node. Only the widths 2 and 4 are implemented.
+*
+* \code
+*   int    idx[4];
+*   double p[4];
+*   GridStencilAxis<4>::Nodes(grid, x, 0.25, idx, p);    // sum of p[i] is 1
+* \endcode
+*/
+template <int W> struct GridStencilAxis;
+
+/// \brief Linear interpolation between the lower and the upper node
+template <> struct GridStencilAxis<2> {
+	static void Nodes(GridAxis &grid, double v, double /*stochfac*/, int *idx, double *p) {
+		int    ln1 = grid.LowerIndex(v);
+		int    max = (int)grid.GetCount()-1;
+		double un1 = (v - grid[ln1]) * grid.InverseSpacing(ln1);
+
+		idx[0] = ln1;							p[0] = 1-un1;
+		idx[1] = (ln1+1 < max) ? ln1+1 : max;	p[1] = un1;
+	}
+};
+
+/// \brief Linear interpolation with additional stochasticity on the 2nd lower and upper node
+template <> struct GridStencilAxis<4> {
+	static void Nodes(GridAxis &grid, double v, double stochfac, int *idx, double *p) {
+		int    ln1 = grid.LowerIndex(v);
+		int    max = (int)grid.GetCount()-1;
+		double un1 = (v - grid[ln1]) * grid.InverseSpacing(ln1);
+		double ln  = 1-un1;
+
+		idx[0] = (ln1 > 0) ? ln1-1 : 0;			p[0] = stochfac * ln;
+		idx[1] = ln1;							p[1] = (1-2*stochfac) * ln + stochfac * un1;
+		idx[2] = (ln1+1 < max) ? ln1+1 : max;	p[2] = stochfac * ln + (1-2*stochfac) * un1;
+		idx[3] = (ln1+2 < max) ? ln1+2 : max;	p[3] = stochfac * un1;
+	}
+};
+
+
+/**
+* \ingroup SoarSupport
+*
+* \brief Summation order of the WX*WY terms of GridStencil::Apply() as pairs (x node, y node).
+*
+* The nodes of each axis are numbered as in GridStencilAxis: 0 = 1st lower, 1 = 1st upper node for
+* width 2 and 0 = 2nd lower, 1 = 1st lower, 2 = 1st upper, 3 = 2nd upper node for width 4. The order
+* starts with the linear terms and is kept from the former Backward::Stoch_HMcN_AddStoch* functions,
+* since a different rounding flips exact ties between the decisions and changes the reference results.
+*/
+template <int WX, int WY> struct GridStencilOrder;
+
+/// \brief Order of the AddStochNone terms
+template <> struct GridStencilOrder<2,2> {
+	static const int *Terms() {
+		static const int terms[] = { 0,0, 1,1, 0,1, 1,0 };
+		return terms;
+	}
+};
+
+/// \brief Order of the AddStochRes terms
+template <> struct GridStencilOrder<4,2> {
+	static const int *Terms() {
+		static const int terms[] = { 1,0, 2,1, 0,0, 0,1, 1,1, 2,0, 3,0, 3,1 };
+		return terms;
+	}
+};
+
+/// \brief Order of the AddStochHealth terms
+template <> struct GridStencilOrder<2,4> {
+	static const int *Terms() {
+		static const int terms[] = { 0,1, 1,2, 0,2, 1,1, 0,0, 1,3, 0,3, 1,0 };
+		return terms;
+	}
+};
+
+/// \brief Order of the AddStochResHealth terms
+template <> struct GridStencilOrder<4,4> {
+	static const int *Terms() {
+		static const int terms[] = { 1,1, 2,2, 0,1, 0,2, 1,2, 2,1, 3,1, 3,2,
+									 1,0, 2,3, 0,0, 0,3, 1,3, 2,0, 3,0, 3,3 };
+		return terms;
+	}
+};
+
+/**
+* \ingroup SoarSupport
+*
+* \brief Interpolation stencil on a reserves-health grid, WX x WY nodes.
+*
+* The weights of the two axes are computed once per case. Apply() sums the WX*WY products
+* in the fixed order of GridStencilOrder, the order of the former explicit sums of the
+* backward iteration, so the optimal decisions stay bitwise reproducible.
+*
+* \code
+*   GridStencil<4,2> st(x_grid, y_grid, x, y, stochfac);
+*   double f = st.Apply(slice.GetData(), x_cnt);     // slice[x + y*x_cnt]
+*   double g = st.Apply(view.GetData(), view.GetStride(0), view.GetStride(1));
+* \endcode
+*
+* <H2 class="groupheader">Include</H2>
+*/
+template <int WX, int WY>
+class GridStencil {
+public:
+	int    x_idx[WX];		///< Reserves nodes
+	double x_p[WX];			///< Weights of the reserves nodes
+	int    y_idx[WY];		///< Health nodes
+	double y_p[WY];			///< Weights of the health nodes
+
+	/// \brief Computes the nodes and weights of (x,y), stochfac is only used by the axes of width 4
+	GridStencil(GridAxis &x_grid, GridAxis &y_grid, double x, double y, double stochfac) {
+		GridStencilAxis<WX>::Nodes(x_grid, x, stochfac, x_idx, x_p);
+		GridStencilAxis<WY>::Nodes(y_grid, y, stochfac, y_idx, y_p);
+	}
+
+	/// \brief Returns the interpolation of the column-major slice f[x + y*stride]
+	double Apply(const double *f, unsigned int stride) const {
+		return Apply(f, 1, stride);
+	}
+
+	/// \brief Returns the interpolation of the strided slice f[x*x_stride + y*y_stride], for instance of a permuted state array
+	double Apply(const double *f, size_t x_stride, size_t y_stride) const {
+		const int *term = GridStencilOrder<WX,WY>::Terms();
+		double     sum  = 0;
+		for (int k=0;k<WX*WY;k++) {
+			int i = term[2*k];
+			int j = term[2*k+1];
+			sum += x_p[i]*y_p[j] * f[x_idx[i]*x_stride + y_idx[j]*y_stride];
+		}
+		return sum;
+	}
+};
+
+#endif // GRIDSTENCIL_H
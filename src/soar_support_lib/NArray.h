@@ -11,6 +11,19 @@
 #include <memory.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <stddef.h>
+#include <new>
+
+#if defined(_MSC_VER)
+#  ifndef NOMINMAX
+#  define NOMINMAX      // workaround a bug in windows.h
+#  endif
+#  include <windows.h>
+#  include <malloc.h>
+#else
+#  include <stdlib.h>
+#  include <sys/mman.h>
+#endif
 
 #ifdef  UNIT_TEST
 #define assert(expression)	{ if ( !(expression) ) throw 42; }
@@ -18,6 +31,15 @@
 #include <assert.h>
 #endif
 
+#include "NArrayView.h"
+
+#define NARRAY_ALIGNMENT	64					///< Alignment of the data storage in bytes, one cache line
+#define NARRAY_LARGE_BYTES	(2*1024*1024)		///< Data storage of this size or more is mapped directly from the OS
+
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define NARRAY_HAS_MOVE							///< Compiler supports rvalue references, NArray can be moved
+#endif
+
 /**
  * \ingroup SoarSupport
  * \ingroup SoarLib
@@ -30,7 +52,13 @@
  *  - Support for [] operator with 1D arrays
  *  - Serialization and deserialization
  *  - Support for up to 10-dimensional arrays, easy to extend
- *  - Copy and assignment operators
+ *  - Copy and assignment operators, assignment reuses the storage of same shaped arrays
+ *  - Move construction and assignment where the compiler supports it, Swap() otherwise
+ *  - 64-bit sizes and offsets, 64 byte aligned data storage
+ *  - Large arrays are mapped from the OS, zeroed lazily on first touch and
+ *    backed by transparent huge pages where available
+ *  - Non-owning strided views and slices, see NArrayView
+ *  - Blocked, vectorisable and OpenMP parallel bulk operations with reproducible reductions
  *  - Unit tested with 100% coverage with various test cases
  *  - Commented with doxygen 
  *
@@ -80,6 +108,9 @@
  *
  * <DIV class="groupHeader">Versions</DIV>
  * \code
+ *   19.10.2026 Parallel bulk operations
+ *   19.10.2026 Assignment without reallocation, move operations
+ *   19.10.2026 64-bit sizes and offsets, aligned and lazily zeroed storage
  *   13.03.2016 Added new constructor with array initialization
  *   03.03.2016 Updated doxygen documentation
  *   20.01.2016 Added more checks for _DEBUG
@@ -124,17 +155,109 @@ private:
 		unsigned int arr[10];
 	} ;
 
+	/**
+	 * Offset array definition, 64-bit so that arrays with more than 4G elements work.
+	 */
+	union NArrayOffs {
+		struct  {
+			size_t dim0;
+			size_t dim1;
+			size_t dim2;
+			size_t dim3;
+			size_t dim4;
+			size_t dim5;
+			size_t dim6;
+			size_t dim7;
+			size_t dim8;
+			size_t dim9;
+		} sizes;
+		size_t arr[10];
+	} ;
+
 	/// \endcond
 
 	///
 
 	NArrayDims   _dims;		///< Storage for the dimensions. 
-	NArrayDims   _offs;		///< Storage for the offsets per dimension
+	NArrayOffs   _offs;		///< Storage for the offsets per dimension
 	unsigned int _n;		///< Number of dimensions
-	unsigned int _size;		///< Storage size for the data
+	size_t       _size;		///< Storage size for the data
 	T *          _data;		///< The data of this array
 
 	unsigned int _maxDims;	///< Maxxium dimensionality supported (calculated)
+
+	/**
+	 * \brief Allocates NARRAY_ALIGNMENT aligned storage for size elements.
+	 *
+	 * Storage of NARRAY_LARGE_BYTES or more is mapped from the OS. The OS hands out
+	 * zeroed pages on first touch, so zeroing costs nothing until the page is used. On
+	 * Linux the mapping is advised to use transparent huge pages, which reduces TLB misses
+	 * when walking the state arrays. Define NARRAY_NO_HUGE_PAGES to disable this.
+	 * Smaller storage comes from the aligned heap and is cleared with memset if requested.
+	 *
+	 * T must be a plain data type, the elements are neither constructed nor destructed.
+	 *
+	 * \param size  Number of elements
+	 * \param zero  Clear the storage
+	 * \return The storage, throws std::bad_alloc like new if no memory is available
+	 */
+	static T *AllocData(size_t size, bool zero) {
+		size_t bytes = (size>0) ? size*sizeof(T) : NARRAY_ALIGNMENT;
+		void * mem   = 0;
+
+		if (bytes >= NARRAY_LARGE_BYTES) {
+#if defined(_MSC_VER)
+			mem = VirtualAlloc(0, bytes, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+#else
+			mem = mmap(0, bytes, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+			if (mem==MAP_FAILED)
+				mem = 0;
+#if defined(MADV_HUGEPAGE) && !defined(NARRAY_NO_HUGE_PAGES)
+			if (mem!=0)
+				madvise(mem, bytes, MADV_HUGEPAGE);
+#endif
+#endif
+			if (mem==0)
+				throw std::bad_alloc();
+			return (T*) mem;
+		}
+
+#if defined(_MSC_VER)
+		mem = _aligned_malloc(bytes, NARRAY_ALIGNMENT);
+#else
+		if (posix_memalign(&mem, NARRAY_ALIGNMENT, bytes)!=0)
+			mem = 0;
+#endif
+		if (mem==0)
+			throw std::bad_alloc();
+		if (zero)
+			memset(mem, 0, bytes);
+		return (T*) mem;
+	}
+
+	/**
+	 * \brief Frees storage of AllocData(), the size selects how it was allocated.
+	 *
+	 * \param data  The storage
+	 * \param size  Number of elements passed to AllocData()
+	 */
+	static void FreeData(T *data, size_t size) {
+		size_t bytes = (size>0) ? size*sizeof(T) : NARRAY_ALIGNMENT;
+
+		if (bytes >= NARRAY_LARGE_BYTES) {
+#if defined(_MSC_VER)
+			VirtualFree(data, 0, MEM_RELEASE);
+#else
+			munmap(data, bytes);
+#endif
+			return;
+		}
+#if defined(_MSC_VER)
+		_aligned_free(data);
+#else
+		free(data);
+#endif
+	}
 	
 	/**
 	 * \brief Re-Initializes the NArray to be empty. 
@@ -143,14 +266,14 @@ private:
 	void Reset() 
 	{		
 		if (_data!=0)
-			delete [] _data;
+			FreeData(_data, _size);
 
 		_maxDims = sizeof(NArrayDims) / sizeof(unsigned int);
 		_data  = 0;
 		_size  = 0;
 		_n     = 0;
 		memset(_dims.arr,0, sizeof(NArrayDims) );
-		memset(_offs.arr,0, sizeof(NArrayDims) );
+		memset(_offs.arr,0, sizeof(NArrayOffs) );
 	}
 
 	/**
@@ -172,16 +295,14 @@ private:
 		}
 		
 		// Compute offsets
-		int off = 1;
+		size_t off = 1;
 		for(unsigned int i=0;i<_n;i++) {
 			_offs.arr[i] = off;
 			off *= _dims.arr[i];
 		}
 
-		_data = new T[_size];
-
-		// Initialize the memory
-		memset(_data,0, sizeof(T)*_size);
+		// Allocate zero initialized memory
+		_data = AllocData(_size, true);
 	}
 
 	/**
@@ -200,9 +321,9 @@ private:
 		_maxDims = src._maxDims;
 		_size    = src._size;
 		memcpy(_dims.arr, src._dims.arr, sizeof(NArrayDims) );
-		memcpy(_offs.arr, src._offs.arr, sizeof(NArrayDims) );
+		memcpy(_offs.arr, src._offs.arr, sizeof(NArrayOffs) );
 
-		_data = new T[_size];
+		_data = AllocData(_size, false);
 
 		memcpy(_data, src._data, _size*sizeof(T) );
 	}
@@ -222,7 +343,7 @@ public:
 	//! The destructor. Frees all data memory
 	~NArray() {
 		if (_data!=0)
-			delete [] _data;
+			FreeData(_data, _size);
 	}
 
 	/**
@@ -260,6 +381,19 @@ public:
 		CopyFrom(src);
 	}
 
+#ifdef NARRAY_HAS_MOVE
+	/**
+	 * \brief Move constructor. 
+	 * Takes over the data memory of src, which is left empty.
+	 *
+	 * \param src The source NArray
+	 */
+	NArray (NArray &&src) : _data(0) {	
+		Reset();
+		Swap(src);
+	}
+#endif
+
 	/**
 	 * \brief Constructor with initialization.
 	 * See Init() for a description of the parameters
@@ -280,12 +414,15 @@ public:
 
 	/**
 	 * \brief Assignment operator. 
-	 * The assignment operator allocates own data memory and copies everything over.
+	 * An empty instance allocates own data memory and copies everything over. 
+	 * An initialized instance keeps its data memory and only copies the data.
 	 *
  	 * \param src The source NArray
 	 * \return This instance (For  a=b=c; instructions)
 	 */	
 	NArray & operator=(const NArray &src) {
+		if (this == &src)
+			return *this;
 
 		// If This instance is already initialized, only allow copy of same dimensionality
 		if (_n!=0) {
@@ -294,12 +431,44 @@ public:
 			for(unsigned int i=0; i<_n; i++) {
 				assert(_dims.arr[i] == src._dims.arr[i]);
 			}
+
+			// Same shape, copy into the existing data memory
+			if (_n == src._n && memcmp(_dims.arr, src._dims.arr, sizeof(NArrayDims))==0) {
+				memcpy(_data, src._data, _size*sizeof(T) );
+				return *this;
+			}
 		}
 
 		CopyFrom(src);
 		return *this;
 	}
 
+#ifdef NARRAY_HAS_MOVE
+	/**
+	 * \brief Move assignment operator. 
+	 * Frees the own data memory and takes over the one of src, which is left empty. 
+	 * Like the assignment operator, an initialized instance only accepts the same dimensions.
+	 *
+ 	 * \param src The source NArray
+	 * \return This instance
+	 */	
+	NArray & operator=(NArray &&src) {
+		if (this == &src)
+			return *this;
+
+		if (_n!=0) {
+			assert(_n == src._n);
+			for(unsigned int i=0; i<_n; i++) {
+				assert(_dims.arr[i] == src._dims.arr[i]);
+			}
+		}
+
+		Reset();
+		Swap(src);
+		return *this;
+	}
+#endif
+
 	/**
 	 * \brief Comparison operator. 
 	 *
@@ -321,11 +490,25 @@ public:
 //		if (_n == 0)
 //			return true;
 
-		// Compare the data
-		bool same = (memcmp(other._data,_data,_size*sizeof(T))==0);
+		// Compare the data, block by block in parallel
+		bool same = View().Equals(other.View());
 		return same;
 	}
 
+	/**
+	 * \brief Exchanges dimensions and data with another NArray without copying the data.
+	 *
+ 	 * \param other The NArray to exchange with
+	 */
+	void Swap(NArray &other) {
+		NArrayDims   dims = _dims;    _dims    = other._dims;    other._dims    = dims;
+		NArrayOffs   offs = _offs;    _offs    = other._offs;    other._offs    = offs;
+		unsigned int n    = _n;       _n       = other._n;       other._n       = n;
+		size_t       size = _size;    _size    = other._size;    other._size    = size;
+		unsigned int maxd = _maxDims; _maxDims = other._maxDims; other._maxDims = maxd;
+		T *          data = _data;    _data    = other._data;    other._data    = data;
+	}
+
 	///@} End of group started by \name
 
 	/**
@@ -334,7 +517,7 @@ public:
 	 */
 
 	//! Retrieve the size of the data storage
-    unsigned int     GetSize()	{ return _size; }
+    size_t           GetSize()	{ return _size; }
 
 	//! Retrieve the dimensionality
 	unsigned int     GetDims()	{ return _n; }
@@ -352,6 +535,50 @@ public:
 	//! Retrieve the data storage
     T *GetData()	{ return _data; }
 
+	/**
+	 * \name Views and slices
+	 * @{ 
+	 */
+
+	//! Retrieve a view on the whole array
+	NArrayView<T> View() const {
+		return NArrayView<T>(_data, _n, _dims.arr, _offs.arr);
+	}
+
+	/**
+	 * \brief Retrieve the contiguous sub-array of the first keep dimensions at fixed outer indices.
+	 *
+	 * The indices i0.. are given for the dimensions keep.._n-1, all further parameters are 
+	 * ignored. For instance f.Slice(2, e,a,o,s,t) of a 7D array is the 2D view f(:,:,e,a,o,s,t) 
+	 * and f.Slice(6, t) is the 6D view of week t. Since the array is stored in column-major 
+	 * order, the elements of the slice are GetData()[0..GetSize()-1] of the view.
+	 *
+	 * \param keep  Number of leading dimensions kept in the view, 1.._n-1
+	 * \param i0    Index of dimension keep
+	 * \param i1    Index of dimension keep+1 (optional)
+	 * \param i2    Index of dimension keep+2 (optional)
+	 * \param i3    Index of dimension keep+3 (optional)
+	 * \param i4    Index of dimension keep+4 (optional)
+	 * \param i5    Index of dimension keep+5 (optional)
+	 * \param i6    Index of dimension keep+6 (optional)
+	 * \param i7    Index of dimension keep+7 (optional)
+	 * \param i8    Index of dimension keep+8 (optional)
+	 * \return The view of the slice
+	 */
+	NArrayView<T> Slice(unsigned int keep, unsigned int i0, unsigned int i1=0, 
+		unsigned int i2=0, unsigned int i3=0, unsigned int i4=0, unsigned int i5=0, 
+		unsigned int i6=0, unsigned int i7=0, unsigned int i8=0) {
+		assert(keep>0 && keep<_n);
+
+		unsigned int idx[9] = { i0, i1, i2, i3, i4, i5, i6, i7, i8 };
+		size_t       off    = 0;
+		for (unsigned int i=keep;i<_n;i++) {
+			assert(idx[i-keep]<_dims.arr[i]);
+			off += idx[i-keep] * _offs.arr[i];
+		}
+		return NArrayView<T>(_data + off, keep, _dims.arr, _offs.arr);
+	}
+
 	///@} End of group started by \name
 
 	
@@ -428,12 +655,37 @@ public:
 	 * \param value  The value
 	 */
 	void Fill(T value) {
-		for(unsigned int d=0; d<_size; d++)
-			_data[d] = value;
+		View().Fill(value);
 	}
 
 	///@} End of group started by \name
 
+
+	/**
+	 * \name Bulk operations on all elements, see NArrayView for the function objects
+	 * @{ 
+	 */
+
+	//! Replaces each element v by op(v)
+	template<class Op> void Transform(Op op)	{ View().Transform(op); }
+
+	//! Calls acc(v, i) for each element v with index i in storage order, acc must be in its initial state
+	template<class Acc> void Reduce(Acc &acc) const	{ View().Reduce(acc); }
+
+	//! Calls acc(v, w, i) for the elements of this and a same shaped array, acc must be in its initial state
+	template<class Acc> void ZipReduce(const NArray &other, Acc &acc) const	{ View().ZipReduce(other.View(), acc); }
+
+	//! Sum of all elements
+	T Sum() const	{ return View().Sum(); }
+
+	//! Smallest element, arg receives its index in storage order if given
+	T Min(size_t *arg=0) const	{ return View().Min(arg); }
+
+	//! Largest element, arg receives its index in storage order if given
+	T Max(size_t *arg=0) const	{ return View().Max(arg); }
+
+	///@} End of group started by \name
+
 	
 	/**
 	 * \name Binary IO functions, can be called by ParamManager
@@ -532,7 +784,7 @@ public:
 	 */
 
 	//! Special array access operator for 1 dimensional array
-	T & operator[](unsigned int d0) {
+	T & operator[](size_t d0) {
 		assert(_n==1);			// Check dimensionality
 		assert(d0<_dims.sizes.dim0);
 
@@ -544,7 +796,7 @@ public:
 		assert(_n==1);			// Check dimensionality
 		assert(d0<_dims.sizes.dim0);
 
-		unsigned int  off =  d0;
+		size_t        off =  d0;
 		return _data[off];	
 	}
 
@@ -554,7 +806,7 @@ public:
 		assert(d0<_dims.sizes.dim0);
 		assert(d1<_dims.sizes.dim1);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1;
 		return _data[off];	
 	}
@@ -566,7 +818,7 @@ public:
 		assert(d1<_dims.sizes.dim1);
 		assert(d2<_dims.sizes.dim2);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2;
 		return _data[off];	
@@ -581,7 +833,7 @@ public:
 		assert(d2<_dims.sizes.dim2);
 		assert(d3<_dims.sizes.dim3);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3;
@@ -599,7 +851,7 @@ public:
 		assert(d3<_dims.sizes.dim3);
 		assert(d4<_dims.sizes.dim4);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -619,7 +871,7 @@ public:
 		assert(d4<_dims.sizes.dim4);
 		assert(d5<_dims.sizes.dim5);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -641,7 +893,7 @@ public:
 		assert(d5<_dims.sizes.dim5);
 		assert(d6<_dims.sizes.dim6);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -666,7 +918,7 @@ public:
 		assert(d6<_dims.sizes.dim6);
 		assert(d7<_dims.sizes.dim7);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -693,7 +945,7 @@ public:
 		assert(d7<_dims.sizes.dim7);
 		assert(d8<_dims.sizes.dim8);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -722,7 +974,7 @@ public:
 		assert(d8<_dims.sizes.dim8);
 		assert(d9<_dims.sizes.dim9);
 
-		unsigned int  off =  d0 
+		size_t        off =  d0 
 				  + d1 * _offs.sizes.dim1 
 				  + d2 * _offs.sizes.dim2 
 				  + d3 * _offs.sizes.dim3 
@@ -740,4 +992,12 @@ public:
 };
 
 
+/**
+ * \brief Exchanges two NArrays without copying the data, found by argument dependent lookup
+ * like std::swap(), see NArray::Swap()
+ */
+template<class T> inline void swap(NArray<T> &a, NArray<T> &b) {
+	a.Swap(b);
+}
+
 #endif // NARRAY_H
\ No newline at end of file
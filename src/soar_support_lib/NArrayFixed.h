@@ -0,0 +1,231 @@
+/**
+* \file NArrayFixed.h
+* \brief Declaration and inline implementation of class NArrayFixed
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef NARRAYFIXED_H
+#define NARRAYFIXED_H
+
+#include "NArray.h"
+
+/// Rank check of the access operators, only the matching rank (true) is a complete type
+template<bool> struct NArrayFixedRankCheck;
+template<> struct NArrayFixedRankCheck<true> { };
+
+/// Compile time check of the rank of an access operator, sizeof() of the incomplete type fails on a mismatch
+#define NARRAYFIXED_RANK(n)	(void)sizeof(NArrayFixedRankCheck<N==(n)>)
+
+/**
+ * \ingroup SoarSupport
+ * \brief Non-owning access to an NArray whose dimensionality N is a template parameter.
+ *
+ * NArray supports any dimensionality up to 10, so each access checks the rank and reads the
+ * offsets from its 10 entry offset table. NArrayFixed copies the N offsets of an NArray or of an
+ * NArrayView once. The rank is checked when compiling, the access operators reduce to N multiply-adds and a
+ * local copy in a loop keeps its offsets in registers. The bounds are checked with assert()
+ * like in NArray.
+ *
+ * The NArray keeps the data. An NArrayFixed must be attached again after the NArray was
+ * initialized, loaded or swapped. The extents remain run time values, since the grid sizes
+ * come from the configuration.
+ *
+ * \code
+ *  NArray<double> f(x_cnt,y_cnt,e_cnt,a_cnt,o_cnt,s_cnt,t_cnt);
+ *
+ *  NArrayFixed<double,7> f7(f);          // attach
+ *  f7(x,y,e,a,o,s,t) = 1.0;              // same element as f(x,y,e,a,o,s,t)
+ *  f7(x,y,e,a,o,s);                      // does not compile
+ * \endcode
+ *
+ * <H2 class="groupheader">Include and Inheritance</H2>
+ */
+template<class T, unsigned int N> class NArrayFixed {
+
+private:
+	T *          _data;		///< The data of the attached NArray, not owned
+	unsigned int _dims[N];	///< Size of each dimension
+	size_t       _offs[N];	///< Offset of each dimension
+
+public:
+
+	/**
+	 * \name Constructors and attachment
+	 * @{
+	 */
+
+	//! The constructor. Initializes an unattached instance.
+	NArrayFixed() : _data(0) {
+		memset(_dims, 0, sizeof(_dims));
+		memset(_offs, 0, sizeof(_offs));
+	}
+
+	//! Constructor attaching to an NArray, see Attach()
+	NArrayFixed(NArray<T> &arr) : _data(0) {
+		Attach(arr);
+	}
+
+	//! Constructor attaching to an NArrayView, see Attach()
+	NArrayFixed(const NArrayView<T> &view) : _data(0) {
+		Attach(view);
+	}
+
+	/**
+	 * \brief Copies data pointer, dimensions and offsets of an NArray with N dimensions.
+	 * An empty NArray detaches this instance.
+	 *
+	 * \param arr  The NArray
+	 */
+	void Attach(NArray<T> &arr) {
+		Attach(arr.View());
+	}
+
+	/**
+	 * \brief Copies data pointer, dimensions and strides of an NArrayView with N dimensions,
+	 * for instance a view with permuted strides. An empty view detaches this instance.
+	 *
+	 * \param view  The view
+	 */
+	void Attach(const NArrayView<T> &view) {
+		memset(_dims, 0, sizeof(_dims));
+		memset(_offs, 0, sizeof(_offs));
+		_data = 0;
+
+		if (view.GetDims()==0)
+			return;
+
+		assert(view.GetDims()==N);
+		for (unsigned int i=0;i<N;i++) {
+			_dims[i] = view.GetDim(i);
+			_offs[i] = view.GetStride(i);
+		}
+		_data = view.GetData();
+	}
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Configuration retrieval
+	 * @{
+	 */
+
+	//! Retrieve the size of dimension i
+	unsigned int GetDim(unsigned int i) const {
+		assert(i<N);
+		return _dims[i];
+	}
+
+	//! Retrieve the data storage, 0 if not attached
+	T *GetData() const	{ return _data; }
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Array access operators, only the one matching N compiles
+	 * @{
+	 */
+
+	//! Array access operator for 1 dimensional array
+	T & operator()(unsigned int d0) const {
+		NARRAYFIXED_RANK(1);
+		assert(d0<_dims[0]);
+
+		return _data[d0*_offs[0]];
+	}
+
+	//! Array access operator for 2 dimensional array
+	T & operator()(unsigned int d0, unsigned int d1) const {
+		NARRAYFIXED_RANK(2);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+
+		return _data[d0*_offs[0] + d1*_offs[1]];
+	}
+
+	//! Array access operator for 3 dimensional array
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2) const {
+		NARRAYFIXED_RANK(3);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+
+		return _data[d0*_offs[0] + d1*_offs[1] + d2*_offs[2]];
+	}
+
+	//! Array access operator for 4 dimensional array
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2, unsigned int d3) const {
+		NARRAYFIXED_RANK(4);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+		assert(d3<_dims[3]);
+
+		return _data[d0*_offs[0] + d1*_offs[1] + d2*_offs[2] + d3*_offs[3]];
+	}
+
+	//! Array access operator for 5 dimensional array
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2, unsigned int d3,
+			unsigned int d4) const {
+		NARRAYFIXED_RANK(5);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+		assert(d3<_dims[3]);
+		assert(d4<_dims[4]);
+
+		return _data[d0*_offs[0] + d1*_offs[1] + d2*_offs[2] + d3*_offs[3] + d4*_offs[4]];
+	}
+
+	//! Array access operator for 6 dimensional array
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2, unsigned int d3,
+			unsigned int d4, unsigned int d5) const {
+		NARRAYFIXED_RANK(6);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+		assert(d3<_dims[3]);
+		assert(d4<_dims[4]);
+		assert(d5<_dims[5]);
+
+		return _data[d0*_offs[0] + d1*_offs[1] + d2*_offs[2] + d3*_offs[3] + d4*_offs[4] + d5*_offs[5]];
+	}
+
+	//! Array access operator for 7 dimensional array, the states of Decision and Forward
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2, unsigned int d3,
+			unsigned int d4, unsigned int d5, unsigned int d6) const {
+		NARRAYFIXED_RANK(7);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+		assert(d3<_dims[3]);
+		assert(d4<_dims[4]);
+		assert(d5<_dims[5]);
+		assert(d6<_dims[6]);
+
+		return _data[d0*_offs[0] + d1*_offs[1] + d2*_offs[2] + d3*_offs[3] + d4*_offs[4] + d5*_offs[5] + d6*_offs[6]];
+	}
+
+	///@} End of group started by \name
+};
+
+#endif // NARRAYFIXED_H
@@ -0,0 +1,563 @@
+/**
+* \file NArrayView.h
+* \brief Declaration and inline implementation of class NArrayView
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+
+#ifndef NARRAYVIEW_H
+#define NARRAYVIEW_H
+
+#include <memory.h>
+#include <stddef.h>
+#include <vector>
+
+#ifdef  UNIT_TEST
+#ifndef assert
+#define assert(expression)	{ if ( !(expression) ) throw 42; }
+#endif
+#else
+#include <assert.h>
+#endif
+
+#define NARRAYVIEW_MAX_DIMS 10		///< Maximal dimensionality of a view, same as NArray
+#define NARRAYVIEW_BLOCK    16384	///< Elements per block of the parallel bulk operations
+
+/**
+ * \ingroup SoarSupport
+ * \brief Non-owning, strided view on the data of an NArray.
+ *
+ * A view stores a data pointer and the size and stride of each of its dimensions.
+ * It never allocates or frees memory, so it must not outlive the NArray it was taken from.
+ * Views are created with NArray::View() and NArray::Slice() and can be narrowed further
+ * with Fix(), which removes one dimension by fixing its index.
+ *
+ * Slices over the outermost dimensions of a column-major NArray are contiguous.
+ * Fill(), Zero() and CopyFrom() use memset/memcpy for them and walk the strides otherwise.
+ *
+ * The bulk operations Transform(), Reduce(), ZipReduce(), Equals(), Sum(), Min() and Max()
+ * split contiguous views into blocks of NARRAYVIEW_BLOCK elements. The inner loops run over 
+ * plain pointers, so the compiler can vectorise them, and with OpenMP the blocks are processed 
+ * in parallel. Reductions keep one accumulator per block and merge them in block order, so the 
+ * result is bitwise the same for any number of threads.
+ *
+ * \code
+ *  NArray<double> f(x_cnt,y_cnt,e_cnt,a_cnt,o_cnt,s_cnt,t_cnt);
+ *
+ *  NArrayView<double> xy = f.Slice(2, e,a,o,s,t);   // f(:,:,e,a,o,s,t), contiguous
+ *  double *p = xy.GetData();                        // p[x + y*x_cnt]
+ *
+ *  NArrayView<double> week = f.Slice(6, t);         // f(:,:,:,:,:,:,t)
+ *  week.Zero();                                     // single memset
+ *
+ *  NArrayView<double> col = f.Slice(2, e,a,o,s,t).Fix(0, x);   // f(x,:,e,a,o,s,t), stride x_cnt
+ * \endcode
+ *
+ * <H2 class="groupheader">Include and Inheritance</H2>
+ */
+template<class T> class NArrayView {
+
+private:
+	T *          _data;							///< First element of the view, not owned
+	unsigned int _n;							///< Number of dimensions
+	unsigned int _dims[NARRAYVIEW_MAX_DIMS];	///< Size of each dimension
+	size_t       _strides[NARRAYVIEW_MAX_DIMS];	///< Distance in elements between neighbours of each dimension
+
+	/// \brief Offset of the run of dimension 0 at the indices idx[1].._n-1
+	size_t RunOffset(const unsigned int *idx) const {
+		size_t off = 0;
+		for (unsigned int d=1;d<_n;d++)
+			off += idx[d] * _strides[d];
+		return off;
+	}
+
+	/// \brief Sets all elements run by run, used for views that are not contiguous
+	void FillStrided(T value) {
+		if (_n==0)
+			return;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		do {
+			T *p = _data + RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++)
+				p[i*_strides[0]] = value;
+		} while (NextRun(idx));
+	}
+
+	/// \brief Number of blocks of the parallel bulk operations and the range of block b
+	static int Blocks(size_t size) {
+		return (int) ((size + NARRAYVIEW_BLOCK - 1) / NARRAYVIEW_BLOCK);
+	}
+	static void BlockRange(int b, size_t size, size_t &first, size_t &last) {
+		first = (size_t) b * NARRAYVIEW_BLOCK;
+		last  = (first + NARRAYVIEW_BLOCK < size) ? first + NARRAYVIEW_BLOCK : size;
+	}
+
+	/// \brief Accumulators of Sum(), Min() and Max()
+	struct SumAcc {
+		T sum;
+		SumAcc() : sum(0) {}
+		void operator()(const T &v, size_t)	{ sum += v; }
+		void Merge(const SumAcc &o)			{ sum += o.sum; }
+	};
+	struct MinAcc {
+		T min; size_t arg; bool any;
+		MinAcc() : min(0), arg(0), any(false) {}
+		void operator()(const T &v, size_t i)	{ if (!any || v < min) { min = v; arg = i; any = true; } }
+		void Merge(const MinAcc &o)				{ if (o.any && (!any || o.min < min)) *this = o; }
+	};
+	struct MaxAcc {
+		T max; size_t arg; bool any;
+		MaxAcc() : max(0), arg(0), any(false) {}
+		void operator()(const T &v, size_t i)	{ if (!any || v > max) { max = v; arg = i; any = true; } }
+		void Merge(const MaxAcc &o)				{ if (o.any && (!any || o.max > max)) *this = o; }
+	};
+
+	/// \brief Advances idx[1].._n-1 to the next run in column-major order, false after the last run
+	bool NextRun(unsigned int *idx) const {
+		for (unsigned int d=1;d<_n;d++) {
+			if (++idx[d] < _dims[d])
+				return true;
+			idx[d] = 0;
+		}
+		return false;
+	}
+
+public:
+
+	/**
+	 * \name Constructors
+	 * @{
+	 */
+
+	//! The constructor. Initializes an empty view.
+	NArrayView() : _data(0), _n(0) {
+		memset(_dims,    0, sizeof(_dims));
+		memset(_strides, 0, sizeof(_strides));
+	}
+
+	/**
+	 * \brief Constructs a view on external memory.
+	 *
+	 * \param data    First element of the view
+	 * \param n       Number of dimensions
+	 * \param dims    Size of each of the n dimensions
+	 * \param strides Stride of each of the n dimensions in elements
+	 */
+	NArrayView(T *data, unsigned int n, const unsigned int *dims, const size_t *strides) : _data(data), _n(n) {
+		assert(n<=NARRAYVIEW_MAX_DIMS);
+		memset(_dims,    0, sizeof(_dims));
+		memset(_strides, 0, sizeof(_strides));
+		for (unsigned int i=0;i<n;i++) {
+			_dims[i]    = dims[i];
+			_strides[i] = strides[i];
+		}
+	}
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Configuration retrieval
+	 * @{
+	 */
+
+	//! Retrieve the number of elements of the view
+	size_t GetSize() const {
+		size_t size = (_n==0) ? 0 : 1;
+		for (unsigned int i=0;i<_n;i++)
+			size *= _dims[i];
+		return size;
+	}
+
+	//! Retrieve the dimensionality
+	unsigned int GetDims() const	{ return _n; }
+
+	//! Retrieve the size of dimension i
+	unsigned int GetDim(unsigned int i) const {
+		assert(i<_n);
+		return _dims[i];
+	}
+
+	//! Retrieve the stride of dimension i in elements
+	size_t GetStride(unsigned int i) const {
+		assert(i<_n);
+		return _strides[i];
+	}
+
+	//! Retrieve the first element, for contiguous views the whole data is GetData()[0..GetSize()-1]
+	T *GetData() const	{ return _data; }
+
+	//! True if the elements of the view are stored densely in column-major order
+	bool IsContiguous() const {
+		size_t off = 1;
+		for (unsigned int i=0;i<_n;i++) {
+			if (_dims[i]>1 && _strides[i]!=off)
+				return false;
+			off *= _dims[i];
+		}
+		return true;
+	}
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Slicing
+	 * @{
+	 */
+
+	/**
+	 * \brief Returns the view with dimension dim fixed to idx, the dimensionality is reduced by one.
+	 * Use the element access operators to read a single element of a 1 dimensional view.
+	 *
+	 * \param dim  The dimension to remove
+	 * \param idx  The index within this dimension
+	 */
+	NArrayView Fix(unsigned int dim, unsigned int idx) const {
+		assert(_n>1);
+		assert(dim<_n);
+		assert(idx<_dims[dim]);
+
+		NArrayView view;
+		view._data = _data + idx * _strides[dim];
+		view._n    = _n - 1;
+		for (unsigned int i=0, j=0;i<_n;i++) {
+			if (i==dim)
+				continue;
+			view._dims[j]    = _dims[i];
+			view._strides[j] = _strides[i];
+			j++;
+		}
+		return view;
+	}
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Bulk operations
+	 * @{
+	 */
+
+	/**
+	 * \brief Sets all elements of the view to value
+	 * \param value  The value
+	 */
+	void Fill(T value) {
+		if (IsContiguous()) {
+			size_t size   = GetSize();
+			int    blocks = Blocks(size);
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) if(blocks > 1)
+#endif
+			for (int b=0;b<blocks;b++) {
+				size_t first, last;
+				BlockRange(b, size, first, last);
+				T *p = _data;
+				for (size_t i=first;i<last;i++)
+					p[i] = value;
+			}
+			return;
+		}
+		FillStrided(value);
+	}
+
+	//! Sets all elements of the view to zero bytes
+	void Zero() {
+		if (IsContiguous()) {
+			memset(_data, 0, GetSize()*sizeof(T));
+			return;
+		}
+		FillStrided(T());
+	}
+
+	/**
+	 * \brief Copies the elements of a view with the same dimensions into this view
+	 * \param src  The source view, must not overlap with this view
+	 */
+	void CopyFrom(const NArrayView &src) {
+		assert(src._n==_n);
+		for (unsigned int i=0;i<_n;i++)
+			assert(src._dims[i]==_dims[i]);
+
+		if (IsContiguous() && src.IsContiguous()) {
+			memcpy(_data, src._data, GetSize()*sizeof(T));
+			return;
+		}
+		if (_n==0)
+			return;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		do {
+			T       *p = _data     + RunOffset(idx);
+			const T *q = src._data + src.RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++)
+				p[i*_strides[0]] = q[i*src._strides[0]];
+		} while (NextRun(idx));
+	}
+
+	/**
+	 * \brief Replaces each element v by op(v)
+	 * \param op  Function object with T operator()(T v)
+	 */
+	template<class Op> void Transform(Op op) {
+		if (IsContiguous()) {
+			size_t size   = GetSize();
+			int    blocks = Blocks(size);
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) if(blocks > 1)
+#endif
+			for (int b=0;b<blocks;b++) {
+				size_t first, last;
+				BlockRange(b, size, first, last);
+				T *p = _data;
+				for (size_t i=first;i<last;i++)
+					p[i] = op(p[i]);
+			}
+			return;
+		}
+		if (_n==0)
+			return;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		do {
+			T *p = _data + RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++)
+				p[i*_strides[0]] = op(p[i*_strides[0]]);
+		} while (NextRun(idx));
+	}
+
+	/**
+	 * \brief Calls acc(v, i) for each element v, i is its index in column-major order within the view.
+	 *
+	 * The blocks of a contiguous view are reduced into copies of acc and merged back into acc 
+	 * in block order with acc.Merge(). acc must therefore be in its initial state, for instance
+	 * zero for a sum.
+	 *
+	 * \param acc  Function object with void operator()(const T &v, size_t i) and void Merge(const Acc &other)
+	 */
+	template<class Acc> void Reduce(Acc &acc) const {
+		size_t size = GetSize();
+		if (IsContiguous()) {
+			int blocks = Blocks(size);
+			if (blocks<=1) {
+				for (size_t i=0;i<size;i++)
+					acc(_data[i], i);
+				return;
+			}
+
+			std::vector<Acc> part(blocks, acc);
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static)
+#endif
+			for (int b=0;b<blocks;b++) {
+				size_t first, last;
+				BlockRange(b, size, first, last);
+				Acc &     a = part[b];
+				const T * p = _data;
+				for (size_t i=first;i<last;i++)
+					a(p[i], i);
+			}
+			for (int b=0;b<blocks;b++)
+				acc.Merge(part[b]);
+			return;
+		}
+		if (_n==0)
+			return;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		size_t k = 0;
+		do {
+			const T *p = _data + RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++)
+				acc(p[i*_strides[0]], k++);
+		} while (NextRun(idx));
+	}
+
+	/**
+	 * \brief Calls acc(v, w, i) for the elements v of this view and w of a view with the same 
+	 * dimensions, i is their index in column-major order. Blocks are merged like in Reduce().
+	 *
+	 * \param other  The second view
+	 * \param acc    Function object with void operator()(const T &v, const T &w, size_t i) and void Merge(const Acc &other)
+	 */
+	template<class Acc> void ZipReduce(const NArrayView &other, Acc &acc) const {
+		assert(other._n==_n);
+		for (unsigned int i=0;i<_n;i++)
+			assert(other._dims[i]==_dims[i]);
+
+		size_t size = GetSize();
+		if (IsContiguous() && other.IsContiguous()) {
+			int blocks = Blocks(size);
+			if (blocks<=1) {
+				for (size_t i=0;i<size;i++)
+					acc(_data[i], other._data[i], i);
+				return;
+			}
+
+			std::vector<Acc> part(blocks, acc);
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static)
+#endif
+			for (int b=0;b<blocks;b++) {
+				size_t first, last;
+				BlockRange(b, size, first, last);
+				Acc &     a = part[b];
+				const T * p = _data;
+				const T * q = other._data;
+				for (size_t i=first;i<last;i++)
+					a(p[i], q[i], i);
+			}
+			for (int b=0;b<blocks;b++)
+				acc.Merge(part[b]);
+			return;
+		}
+		if (_n==0)
+			return;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		size_t k = 0;
+		do {
+			const T *p = _data       + RunOffset(idx);
+			const T *q = other._data + other.RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++)
+				acc(p[i*_strides[0]], q[i*other._strides[0]], k++);
+		} while (NextRun(idx));
+	}
+
+	/**
+	 * \brief Compares the elements bytewise with a view, like memcmp()
+	 * \param other  The second view
+	 * \return True if both have the same dimensions and elements
+	 */
+	bool Equals(const NArrayView &other) const {
+		if (other._n!=_n)
+			return false;
+		for (unsigned int i=0;i<_n;i++) {
+			if (other._dims[i]!=_dims[i])
+				return false;
+		}
+
+		size_t size = GetSize();
+		if (IsContiguous() && other.IsContiguous()) {
+			int blocks = Blocks(size);
+			int differ = 0;
+#ifdef _OPENMP
+			#pragma omp parallel for schedule(static) reduction(|:differ) if(blocks > 1)
+#endif
+			for (int b=0;b<blocks;b++) {
+				size_t first, last;
+				BlockRange(b, size, first, last);
+				if (memcmp(_data+first, other._data+first, (last-first)*sizeof(T))!=0)
+					differ |= 1;
+			}
+			return differ==0;
+		}
+		if (_n==0)
+			return true;
+
+		unsigned int idx[NARRAYVIEW_MAX_DIMS];
+		memset(idx, 0, sizeof(idx));
+		do {
+			const T *p = _data       + RunOffset(idx);
+			const T *q = other._data + other.RunOffset(idx);
+			for (unsigned int i=0;i<_dims[0];i++) {
+				if (memcmp(&p[i*_strides[0]], &q[i*other._strides[0]], sizeof(T))!=0)
+					return false;
+			}
+		} while (NextRun(idx));
+		return true;
+	}
+
+	//! Sum of all elements, added block by block
+	T Sum() const {
+		SumAcc acc;
+		Reduce(acc);
+		return acc.sum;
+	}
+
+	/**
+	 * \brief Smallest element of a non-empty view
+	 * \param arg  If given, receives the column-major index of the first smallest element
+	 */
+	T Min(size_t *arg=0) const {
+		assert(GetSize()>0);
+		MinAcc acc;
+		Reduce(acc);
+		if (arg!=0)
+			*arg = acc.arg;
+		return acc.min;
+	}
+
+	/**
+	 * \brief Largest element of a non-empty view
+	 * \param arg  If given, receives the column-major index of the first largest element
+	 */
+	T Max(size_t *arg=0) const {
+		assert(GetSize()>0);
+		MaxAcc acc;
+		Reduce(acc);
+		if (arg!=0)
+			*arg = acc.arg;
+		return acc.max;
+	}
+
+	///@} End of group started by \name
+
+
+	/**
+	 * \name Access operators
+	 * @{
+	 */
+
+	//! Element access for 1 dimensional views
+	T & operator()(unsigned int d0) const {
+		assert(_n==1);
+		assert(d0<_dims[0]);
+		return _data[d0*_strides[0]];
+	}
+
+	//! Element access for 2 dimensional views
+	T & operator()(unsigned int d0, unsigned int d1) const {
+		assert(_n==2);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		return _data[d0*_strides[0] + d1*_strides[1]];
+	}
+
+	//! Element access for 3 dimensional views
+	T & operator()(unsigned int d0, unsigned int d1, unsigned int d2) const {
+		assert(_n==3);
+		assert(d0<_dims[0]);
+		assert(d1<_dims[1]);
+		assert(d2<_dims[2]);
+		return _data[d0*_strides[0] + d1*_strides[1] + d2*_strides[2]];
+	}
+
+	///@} End of group started by \name
+};
+
+#endif // NARRAYVIEW_H
@@ -77,7 +77,7 @@ public:
 		timeval       stop;
 		gettimeofday(&stop, 0);
 
-		float nSec = stop.tv_sec - _start.tv_sec + (stop.tv_usec - _start.tv_usec);		
+		float nSec = (stop.tv_sec - _start.tv_sec)*1000000.0f + (stop.tv_usec - _start.tv_usec);
 #endif
 		_nano_secs  += nSec;
 		_call_count++;
@@ -454,8 +454,8 @@ template<typename T> bool ParamManager::CompareAsciiNArray(LibconfigWrapper *lcw
 		}
 
 		if (curr->_type==T_FLOAT || curr->_type==T_DOUBLE) {
-			int size = arrMem.GetSize();
-			for(int i=0; i<size; i++) {
+			size_t size = arrMem.GetSize();
+			for(size_t i=0; i<size; i++) {
 				T valMem  = arrMem.GetData() [ i ];
 				T valFile = arrFile.GetData() [ i ];
 				if ( fabs((double) valMem- (double)valFile) > 0.00000001) {
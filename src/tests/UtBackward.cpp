@@ -12,6 +12,7 @@
 
 #include "../soar_lib/Decision.h"
 #include "../soar_lib/Backward.h"
+#include "../soar_lib/Forward.h"
 #include "../soar_lib/Settings.h"
 
 
@@ -301,13 +302,13 @@ public:
 
 	void InitDeltaF(Decision &decision)
 	{
-		unsigned int xDim = decision.GetF().GetDim(0);
-		unsigned int yDim = decision.GetF().GetDim(1);
-		unsigned int eDim = decision.GetF().GetDim(2);
-		unsigned int aDim = decision.GetF().GetDim(3);
-		unsigned int oDim = decision.GetF().GetDim(4);
-		unsigned int sDim = decision.GetF().GetDim(5);
-		unsigned int tDim = decision.GetF().GetDim(6);
+		unsigned int xDim = decision.GetDim(0);
+		unsigned int yDim = decision.GetDim(1);
+		unsigned int eDim = decision.GetDim(2);
+		unsigned int aDim = decision.GetDim(3);
+		unsigned int oDim = decision.GetDim(4);
+		unsigned int sDim = decision.GetDim(5);
+		unsigned int tDim = decision.GetDim(6);
 
 		unsigned int x = xDim / 2;
 		unsigned int y = yDim / 2;
@@ -329,13 +330,13 @@ public:
 
 	void UpdateAndSaveDeltaF(char *newName, Decision &decision)
 	{
-		unsigned int xDim = decision.GetF().GetDim(0);
-		unsigned int yDim = decision.GetF().GetDim(1);
-		unsigned int eDim = decision.GetF().GetDim(2);
-		unsigned int aDim = decision.GetF().GetDim(3);
-		unsigned int oDim = decision.GetF().GetDim(4);
-		unsigned int sDim = decision.GetF().GetDim(5);
-		unsigned int tDim = decision.GetF().GetDim(6);
+		unsigned int xDim = decision.GetDim(0);
+		unsigned int yDim = decision.GetDim(1);
+		unsigned int eDim = decision.GetDim(2);
+		unsigned int aDim = decision.GetDim(3);
+		unsigned int oDim = decision.GetDim(4);
+		unsigned int sDim = decision.GetDim(5);
+		unsigned int tDim = decision.GetDim(6);
 
 		unsigned int x = xDim / 2;
 		unsigned int y = yDim / 2;
@@ -400,13 +401,13 @@ public:
 			return false;
 		}
 		
-		unsigned int xDim = decision.GetF().GetDim(0);
-		unsigned int yDim = decision.GetF().GetDim(1);
-		unsigned int eDim = decision.GetF().GetDim(2);
-		unsigned int aDim = decision.GetF().GetDim(3);
-		unsigned int oDim = decision.GetF().GetDim(4);
-		unsigned int sDim = decision.GetF().GetDim(5);
-		unsigned int tDim = decision.GetF().GetDim(6);
+		unsigned int xDim = decision.GetDim(0);
+		unsigned int yDim = decision.GetDim(1);
+		unsigned int eDim = decision.GetDim(2);
+		unsigned int aDim = decision.GetDim(3);
+		unsigned int oDim = decision.GetDim(4);
+		unsigned int sDim = decision.GetDim(5);
+		unsigned int tDim = decision.GetDim(6);
 
 		for (unsigned int x=0;x<xDim;x++) {
 			for (unsigned int y=0;y<yDim;y++) {
@@ -552,6 +553,317 @@ public:
 		TestGroup();
 	}
 
+	/// \brief Compare the lambda sensitivities from eigenvalue perturbation with finite differences
+	void TestSensitivityWithSetting(char *test, int years) {
+		char group[128], setName[512];
+
+		sprintf_s(group,"%s Sensitivity",test);
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+
+		TestGroup(group);
+
+		Settings settings;
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return;
+
+		settings.SetN(years);
+		settings.SetNFW(years);
+		settings.SetStartLocationFW(1);
+
+		double theta = settings.GetTheta();
+		double h     = 0.001;
+
+		Decision decision;
+		Backward backward;
+		Forward  forward;
+
+		backward.SetDecision(&decision);
+		forward.SetDecision(&decision);
+		backward.Compute(&settings, theta);
+		forward.ComputePopulationDynamics(&settings);
+
+		double dTheta = backward.ComputeThetaSensitivity(&settings, forward.GetPopulationDynamics());
+		double dIndep = backward.ComputeParamSensitivity(&settings, forward.GetPopulationDynamics(), 5);
+
+		// Finite differences by full backward runs
+		Decision decP, decM;
+		backward.SetDecision(&decP);
+		double lp = backward.Compute(&settings, theta+h);
+		backward.SetDecision(&decM);
+		double lm = backward.Compute(&settings, theta-h);
+		double fdTheta = (lp-lm)/(2*h);
+
+		double indep = settings.GetSensitivityParam(5);
+		settings.SetSensitivityParam(5, indep+h);
+		backward.SetDecision(&decP);
+		decP.Reset();
+		lp = backward.Compute(&settings, theta);
+		settings.SetSensitivityParam(5, indep-h);
+		backward.SetDecision(&decM);
+		decM.Reset();
+		lm = backward.Compute(&settings, theta);
+		settings.SetSensitivityParam(5, indep);
+		double fdIndep = (lp-lm)/(2*h);
+
+		ExpectOkay(fabs(dTheta-fdTheta) <= 0.02*fabs(fdTheta),"dLambda/dTheta %f differs from finite difference %f",dTheta,fdTheta);
+		ExpectOkay(fabs(dIndep-fdIndep) <= 0.02*fabs(fdIndep),"dLambda/d%s %f differs from finite difference %f",
+			settings.GetSensitivityParamName(5),dIndep,fdIndep);
+
+		TestGroup();
+	}
+
+	/// \brief Warm start from the decision of a converged run, on the same and on a finer grid
+	void TestWarmStartWithSetting(char *test, int years) {
+		char group[128], setName[512], decName[512];
+
+		sprintf_s(group,"%s Warm start",test);
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+		sprintf_s(decName,"Ut_%s_BW_WarmStart.bin",test );
+
+		TestGroup(group);
+
+		Settings settings;
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return;
+
+		double theta = settings.GetTheta();
+
+		Decision decision;
+		Backward backward;
+		backward.SetDecision(&decision);
+		settings.SetN(years);
+		double lambda = backward.Compute(&settings, theta);
+
+		if (!ExpectOkay( decision.SaveToFile(decName), "Saving '%s' failed",decName) )
+			return;
+
+		// Same grid: already the first year reproduces the converged lambda
+		settings.SetWarmStartFile(decName);
+		settings.SetN(1);
+		settings.SetNMin(1);
+		Decision decisionB;
+		backward.SetDecision(&decisionB);
+		double lambdaB = backward.Compute(&settings, theta);
+
+		ExpectOkay(fabs(lambdaB - lambda) < 0.0001, "Warm start lambda %f differs from %f",lambdaB,lambda);
+
+		// Finer grid: after a few years the remapped start is closer to the converged lambda than the terminal condition
+		settings.SetGridX(2*settings.GetGridX());
+		settings.SetN(3);
+		settings.SetNMin(3);
+		Decision decisionC;
+		backward.SetDecision(&decisionC);
+		double lambdaWarm = backward.Compute(&settings, theta);
+
+		settings.SetWarmStartFile("");
+		Decision decisionD;
+		backward.SetDecision(&decisionD);
+		double lambdaCold = backward.Compute(&settings, theta);
+
+		settings.SetN(years);
+		Decision decisionE;
+		backward.SetDecision(&decisionE);
+		double lambdaConv = backward.Compute(&settings, theta);
+
+		ExpectOkay(fabs(lambdaWarm - lambdaConv) < fabs(lambdaCold - lambdaConv), 
+			"Warm start on finer grid: lambda %f, terminal condition %f, converged %f",lambdaWarm,lambdaCold,lambdaConv);
+
+		TestGroup();
+	}
+
+	/// \brief Reachable-state pruning must not change the reproductive values of the optimized states
+	void TestPruningWithSetting(char *test, int years) {
+		char group[128], setName[512];
+
+		sprintf_s(group,"%s Pruning",test);
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+
+		TestGroup(group);
+
+		Settings settings;
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return;
+
+		double theta = settings.GetTheta();
+		settings.SetN(years);
+
+		Decision decision, decisionP;
+		Backward backward;
+		backward.SetDecision(&decision);
+		double lambda = backward.Compute(&settings, theta);
+
+		settings.SetPruneUnreachableStates(true);
+		backward.SetDecision(&decisionP);
+		double lambdaP = backward.Compute(&settings, theta);
+
+		ExpectOkay(fabs(lambda - lambdaP) < 1.0e-10, "Lambda with pruning %f differs from %f",lambdaP,lambda);
+
+		NArrayFixed<double,7> f(decision.GetFView());
+		NArrayFixed<double,7> fP(decisionP.GetFView());
+		int pruned = 0, differ = 0;
+		for (unsigned int x=1;x<decision.GetDim(0);x++) {
+			for (unsigned int y=0;y<decision.GetDim(1);y++) {
+				for (unsigned int e=0;e<decision.GetDim(2);e++) {
+					for (unsigned int a=0;a<decision.GetDim(3);a++) {
+						for (unsigned int o=0;o<decision.GetDim(4);o++) {
+							for (unsigned int s=0;s<decision.GetDim(5);s++) {
+								for (unsigned int t=0;t<decision.GetDim(6);t++) {
+									if (decisionP.GetF_strat(x,y,e,a,o,s,t) == 'p')
+										pruned++;
+									else if (fabs(f(x,y,e,a,o,s,t) - fP(x,y,e,a,o,s,t)) > 1.0e-10 * fabs(f(x,y,e,a,o,s,t)) )
+										differ++;
+								} } } } } } }
+
+		ExpectOkay(pruned > 0, "No state pruned");
+		ExpectOkay(differ == 0, "%d reachable states differ",differ);
+
+		TestGroup();
+	}
+
+	/// \brief The low-rank f must reproduce the dense one, closely with full rank and roughly with a truncated rank
+	void TestLowRankWithSetting(char *test, int years) {
+		char group[128], setName[512];
+
+		sprintf_s(group,"%s Low-rank",test);
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+
+		TestGroup(group);
+
+		Settings settings;
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return;
+
+		double theta = settings.GetTheta();
+		settings.SetN(years);
+
+		Decision decision, decisionL, decisionT;
+		Backward backward;
+		backward.SetDecision(&decision);
+		double lambda = backward.Compute(&settings, theta);
+
+		// Full rank: only the order of the summation differs
+		settings.SetLowRank(1.0e-12, 255);
+		backward.SetDecision(&decisionL);
+		double lambdaL = backward.Compute(&settings, theta);
+
+		// Truncated rank
+		settings.SetLowRank(1.0e-4, 4);
+		backward.SetDecision(&decisionT);
+		double lambdaT = backward.Compute(&settings, theta);
+
+		ExpectOkay(decisionL.IsLowRank() && decisionT.IsLowRank(), "Decision not in low-rank mode");
+		ExpectOkay(fabs(lambda - lambdaL) < 1.0e-9 * fabs(lambda), "Lambda with full rank %.12f differs from %.12f",lambdaL,lambda);
+		ExpectOkay(fabs(lambda - lambdaT) < 1.0e-2, "Lambda with truncated rank %f differs from %f",lambdaT,lambda);
+
+		// The factors replace f only, f_u and f_strat (9 bytes per state) stay dense next to the dense f (8 bytes)
+		unsigned int dims[7];
+		for (unsigned int i=0;i<7;i++)
+			dims[i] = decision.GetDim(i);
+		double dense_mb, dense_mbT;
+		double mb  = decision.EstimateMemoryMB(dims[0],dims[1],dims[2],dims[3],dims[4],dims[5],dims[6], dense_mb);
+		double mbT = decisionT.EstimateMemoryMB(dims[0],dims[1],dims[2],dims[3],dims[4],dims[5],dims[6], dense_mbT);
+		ExpectOkay(fabs(mb - dense_mb*17.0/9.0) < 1.0e-9 * mb && dense_mbT == dense_mb && mbT > dense_mbT, "Memory estimate %f MB (dense %f MB) of the truncated rank against %f MB (dense %f MB)",mbT,dense_mbT,mb,dense_mb);
+
+		// Expanded f of the last decision epoch
+		NArrayFixed<double,7> f(decision.GetFView());
+		unsigned int t = decision.GetDim(6)-1;
+		double err = 0, errT = 0, f_max = 0;
+		for (unsigned int x=0;x<decision.GetDim(0);x++) {
+			for (unsigned int y=0;y<decision.GetDim(1);y++) {
+				for (unsigned int e=0;e<decision.GetDim(2);e++) {
+					for (unsigned int a=0;a<decision.GetDim(3);a++) {
+						for (unsigned int o=0;o<decision.GetDim(4);o++) {
+							for (unsigned int s=0;s<decision.GetDim(5);s++) {
+								double d = fabs(f(x,y,e,a,o,s,t) - decisionL.GetF(x,y,e,a,o,s,t));
+								if (d > err)
+									err = d;
+								d = fabs(f(x,y,e,a,o,s,t) - decisionT.GetF(x,y,e,a,o,s,t));
+								if (d > errT)
+									errT = d;
+								if (f(x,y,e,a,o,s,t) > f_max)
+									f_max = f(x,y,e,a,o,s,t);
+							} } } } } }
+		ExpectOkay(err  < 1.0e-9 * f_max, "Low-rank f with full rank differs by %g of %g",err,f_max);
+		ExpectOkay(errT < 0.05 * f_max, "Low-rank f with truncated rank differs by %g of %g",errT,f_max);
+
+		TestGroup();
+	}
+
+	/// \brief Compares f, f_u and f_strat of two decisions through the accessors
+	bool SameStates(Decision &dcA, Decision &dcB) {
+		for (unsigned int d=0;d<7;d++) {
+			if (dcA.GetDim(d) != dcB.GetDim(d))
+				return false;
+		}
+		int differ = 0;
+		for (unsigned int t=0;t<dcA.GetDim(6);t++) {
+			for (unsigned int s=0;s<dcA.GetDim(5);s++) {
+				for (unsigned int o=0;o<dcA.GetDim(4);o++) {
+					for (unsigned int a=0;a<dcA.GetDim(3);a++) {
+						for (unsigned int e=0;e<dcA.GetDim(2);e++) {
+							for (unsigned int y=0;y<dcA.GetDim(1);y++) {
+								for (unsigned int x=0;x<dcA.GetDim(0);x++) {
+									if (dcA.GetF(x,y,e,a,o,s,t)       != dcB.GetF(x,y,e,a,o,s,t) ||
+										dcA.GetF_u(x,y,e,a,o,s,t)     != dcB.GetF_u(x,y,e,a,o,s,t) ||
+										dcA.GetF_strat(x,y,e,a,o,s,t) != dcB.GetF_strat(x,y,e,a,o,s,t) )
+										differ++;
+								} } } } } } }
+		return differ == 0;
+	}
+
+	/// \brief The storage layouts of the decision must give the same results as the separate arrays
+	void TestLayoutsWithSetting(char *test, int years) {
+		char group[128], setName[512], decName[512];
+
+		sprintf_s(group,"%s Layouts",test);
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+		sprintf_s(decName,"Ut_%s_BW_Layout.bin",test );
+
+		TestGroup(group);
+
+		Settings settings;
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return;
+
+		double theta = settings.GetTheta();
+		settings.SetN(years);
+
+		Decision decision;
+		Backward backward;
+		backward.SetDecision(&decision);
+		double lambda = backward.Compute(&settings, theta);
+
+		for (int layout=DC_LAYOUT_RECORD;layout<DC_LAYOUT_CNT;layout++) {
+			const char *name = Decision::GetLayoutName(layout);
+
+			settings.SetDecisionLayout(layout);
+			Decision decisionL;
+			backward.SetDecision(&decisionL);
+			double lambdaL = backward.Compute(&settings, theta);
+
+			ExpectOkay(decisionL.GetLayout() == layout, "Decision has layout %d instead of %d",decisionL.GetLayout(),layout);
+			ExpectOkay(lambdaL == lambda, "Lambda with layout '%s' %f differs from %f",name,lambdaL,lambda);
+			ExpectOkay(SameStates(decision, decisionL), "States with layout '%s' differ",name);
+
+			// The file holds [x][y][e][a][o][s][t] in any layout
+			Decision decisionF;
+			bool saved = decisionL.SaveToFile(decName) && decisionF.LoadFromFile(decName);
+			ExpectOkay(saved && SameStates(decision, decisionF), "Saving and loading with layout '%s'",name);
+		}
+
+		// The benchmark selects one of the layouts
+		settings.SetDecisionLayout(DC_LAYOUT_AUTO);
+		Decision decisionA;
+		backward.SetDecision(&decisionA);
+		double lambdaA = backward.Compute(&settings, theta);
+
+		int layout = decisionA.GetLayout();
+		ExpectOkay(layout >= 0 && layout < DC_LAYOUT_CNT, "Benchmark selected layout %d",layout);
+		ExpectOkay(lambdaA == lambda, "Lambda with benchmarked layout '%s' %f differs from %f",Decision::GetLayoutName(layout),lambdaA,lambda);
+
+		TestGroup();
+	}
+
 	void RunTests() {
 		TestBackwardWithSetting("Migration_10x10");
 		TestBackwardWithSetting("Reproduction_4x4");
@@ -561,6 +873,12 @@ public:
 		TestBackwardWithSetting("AddStochResHealth");
 		TestBackwardWithSetting("NoHealth");
 		TestBackwardWithSetting("NoMigr");
+
+		TestSensitivityWithSetting("Reproduction_4x4", 30);
+		TestWarmStartWithSetting("Reproduction_4x4", 60);
+		TestPruningWithSetting("Migration_10x10", 5);
+		TestLowRankWithSetting("Reproduction_4x4", 10);
+		TestLayoutsWithSetting("Migration_10x10", 3);
 	}
 };
 
@@ -0,0 +1,125 @@
+/**
+* \file UtEventLog.cpp
+* \brief Implementation of UtEventLog to test the EventLog class
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <stdlib.h>
+
+#include "UnitTest.h"
+
+#include "../soar_lib/EventLog.h"
+
+
+/**
+ * \ingroup Tests
+ * \brief UnitTest for EventLog class
+ */
+class UtEventLog : public UnitTest {
+private:
+
+public:
+
+	/// \brief The constructor registers at the UnitTestManager
+	UtEventLog() : UnitTest("EventLog")
+	{
+	}
+
+	/// \brief Appends cnt events generated from the test values
+	void AddEvents(EventLog &log, int idx, unsigned int cnt) {
+		for (unsigned int i=0; i<cnt; i++) {
+			unsigned int id    = GetNextIntTestValue(idx, 0, 1000000);
+			unsigned int year  = GetNextIntTestValue(idx, 0, 500);
+			unsigned int week  = GetNextIntTestValue(idx, 0, 51);
+			EventType    type  = (EventType)GetNextIntTestValue(idx, EVENT_INDEPENDENCE, EVENT_RESAMPLE_COPY);
+			int          value = GetNextIntTestValue(idx, -1, 100000);
+			log.Add(id, year, week, type, value);
+		}
+	}
+
+	/// \brief Compares the events in memory with the generated ones
+	bool SameEvents(EventLog &log, int idx, unsigned int cnt) {
+		if (log.GetSize() != cnt)
+			return false;
+		for (unsigned int i=0; i<cnt; i++) {
+			bool same = log.GetId(i)   == (unsigned int)GetNextIntTestValue(idx, 0, 1000000);
+			same &= log.GetYear(i)     == (unsigned int)GetNextIntTestValue(idx, 0, 500);
+			same &= log.GetWeek(i)     == (unsigned int)GetNextIntTestValue(idx, 0, 51);
+			same &= log.GetType(i)     == (EventType)GetNextIntTestValue(idx, EVENT_INDEPENDENCE, EVENT_RESAMPLE_COPY);
+			same &= log.GetValue(i)    == GetNextIntTestValue(idx, -1, 100000);
+			if (!same)
+				return false;
+		}
+		return true;
+	}
+
+	void TestMemoryLog() {
+		TestGroup("Events in memory");
+		//=============================== Without a file all events stay in memory
+
+		int idx0 = 11;
+		for (int tests=0; tests<10; tests++) {
+			unsigned int cnt   = GetNextIntTestValue(idx0, 0, 3000);
+			unsigned int chunk = GetNextIntTestValue(idx0, 1, 1000);
+
+			EventLog log(chunk);
+			AddEvents(log, 7*tests, cnt);
+			ExpectOkay(log.GetCount() == cnt, "Count %d instead of %d", log.GetCount(), cnt);
+			ExpectOkay(SameEvents(log, 7*tests, cnt), "Events of %d differ", cnt);
+
+			log.Clear();
+			ExpectOkay(log.GetSize() == 0 && log.GetCount() == 0, "Clear left events");
+		}
+
+		TestGroup();
+	}
+
+	void TestChunkedFile() {
+		TestGroup("Events streamed in chunks");
+		//=============================== Chunks written to the file load back in order
+
+		int idx0 = 31;
+		for (int tests=0; tests<10; tests++) {
+			unsigned int cnt   = GetNextIntTestValue(idx0, 0, 3000);
+			unsigned int chunk = GetNextIntTestValue(idx0, 1, 1000);
+
+			EventLog log(chunk);
+			if (!ExpectOkay(log.Open("Ut_EventLog.dat"), "Opening the log file"))
+				return;
+			AddEvents(log, 13*tests, cnt);
+			ExpectOkay(log.GetCount() == cnt, "Count %d instead of %d", log.GetCount(), cnt);
+			ExpectOkay(log.GetSize() < chunk, "Pool holds %d events, chunk size %d", log.GetSize(), chunk);
+			ExpectOkay(log.Close(), "Closing the log file");
+
+			EventLog loaded;
+			ExpectOkay(loaded.LoadFromFile("Ut_EventLog.dat"), "Loading the log file");
+			ExpectOkay(SameEvents(loaded, 13*tests, cnt), "Loaded events of %d in chunks of %d differ", cnt, chunk);
+		}
+
+		TestGroup();
+	}
+
+	void RunTests() {
+		TestMemoryLog();
+		TestChunkedFile();
+	}
+};
+
+UtEventLog test_EventLog;  ///< Global instance automatically registers to UnitTestManager
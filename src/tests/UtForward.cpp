@@ -7,10 +7,12 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "UnitTest.h"
 
 #include "../soar_lib/Decision.h"
+#include "../soar_lib/Backward.h"
 #include "../soar_lib/Forward.h"
 #include "../soar_lib/Settings.h"
 
@@ -21,15 +23,490 @@
  */
 class UtForward: public UnitTest {
 private:
+	Decision _decision;			///< Decision shared by the tests of one setting, see LoadSettingAndDecision()
+	char     _decision_test[128];	///< Setting of _decision, empty before the first one
+	int      _decision_years;	///< Backward iterations of _decision
 
 public:
 
 	/// \brief The constructor registers at the UnitTestManager 
-	UtForward() : UnitTest("Forward")
+	UtForward() : UnitTest("Forward") , _decision_years(0)
 	{
+		_decision_test[0] = 0;
+	}
+
+	/// \brief Loads the setting with years backward iterations and the forward start location 1 and returns
+	/// its decision, which is computed once per setting and shared by the tests, so they must not change it
+	Decision *LoadSettingAndDecision(char *test, int years, Settings &settings) {
+		char setName[512];
+
+		sprintf_s(setName,"%s/Input_%s.cfg",GetInputPath(),test );
+		if (!ExpectOkay( settings.LoadAsciiFile(setName), "Loading '%s', see Logfile for details",setName) )
+			return 0;
+
+		settings.SetN(years);
+		settings.SetStartLocationFW(1);
+
+		if (strcmp(_decision_test, test) != 0 || _decision_years != years) {
+			_decision.Reset();
+			Backward backward;
+			backward.SetDecision(&_decision);
+			backward.Compute(&settings, settings.GetTheta());
+
+			sprintf_s(_decision_test,"%s",test);
+			_decision_years = years;
+		}
+		return &_decision;
+	}
+
+	/// \brief The eigen solver finds the lambda and stable distribution of a long power iteration
+	void TestEigenSolverWithSetting(char *test, int years, int years_fw) {
+		char group[128];
+
+		sprintf_s(group,"%s Eigen solver",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		Forward forward, forwardE;
+		settings.SetNFW(years_fw);
+		settings.SetNMinFW(years_fw);
+		forward.SetDecision(decision);
+		double lambda = forward.ComputePopulationDynamics(&settings);
+
+		settings.SetNFW(years);
+		settings.SetNMinFW(0);
+		settings.SetForwardEigenSolver(true);
+		forwardE.SetDecision(decision);
+		double lambdaE = forwardE.ComputePopulationDynamics(&settings);
+
+		ExpectOkay(fabs(lambda - lambdaE) < 1.0e-8, "Eigen solver lambda %.10f differs from %.10f",lambdaE,lambda);
+
+		// Stable distributions normalised to the total of the first week
+		NArray<double> &p  = forward.GetPopulationDynamics();
+		NArray<double> &pE = forwardE.GetPopulationDynamics();
+		unsigned int week = p.GetSize() / p.GetDim(6);
+		double sum = 0, sumE = 0, err = 0;
+		for (unsigned int i=0;i<week;i++) {
+			sum  += p.GetData()[i];
+			sumE += pE.GetData()[i];
+		}
+		for (unsigned int i=0;i<p.GetSize();i++) {
+			double d = fabs(p.GetData()[i]/sum - pE.GetData()[i]/sumE);
+			if (d > err)
+				err = d;
+		}
+		ExpectOkay(err < 1.0e-10, "Eigen solver distribution differs by %g",err);
+
+		TestGroup();
+	}
+
+	/// \brief The Monte Carlo simulation reproduces the lambda of the state distribution and is reproducible for a seed
+	void TestMonteCarloWithSetting(char *test, int years, int years_fw, unsigned int cohort) {
+		char group[128];
+
+		sprintf_s(group,"%s Monte Carlo",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		settings.SetNFW(years_fw);
+
+		Forward forward, forwardMC, forwardMC2, forwardMC3;
+		forward.SetDecision(decision);
+		double lambda = forward.ComputePopulationDynamics(&settings);
+
+		settings.SetForwardUsingMonteCarlo(true);
+		settings.SetForwardMonteCarloStartCohortSize(cohort);
+		forwardMC.SetDecision(decision);
+		forwardMC2.SetDecision(decision);
+		double lambdaMC  = forwardMC.ComputePopulationDynamics(&settings);
+		double lambdaMC2 = forwardMC2.ComputePopulationDynamics(&settings);
+
+		settings.SetForwardMonteCarloSeed(2);
+		forwardMC3.SetDecision(decision);
+		double lambdaMC3 = forwardMC3.ComputePopulationDynamics(&settings);
+
+		ExpectOkay(fabs(lambda - lambdaMC) < 0.005, "Monte Carlo lambda %.6f differs from %.6f",lambdaMC,lambda);
+		ExpectOkay(fabs(lambda - lambdaMC3) < 0.005, "Monte Carlo lambda %.6f with seed 2 differs from %.6f",lambdaMC3,lambda);
+		ExpectOkay(lambdaMC == lambdaMC2, "Monte Carlo lambda %.10f not reproduced, %.10f",lambdaMC2,lambdaMC);
+		ExpectOkay(forwardMC.GetPopulationDynamics() == forwardMC2.GetPopulationDynamics(), "Monte Carlo distribution not reproduced");
+		ExpectFail(forwardMC.GetPopulationDynamics() == forwardMC3.GetPopulationDynamics(), "Monte Carlo distribution independent of the seed");
+
+		TestGroup();
+	}
+
+	/// \brief The batched run reproduces the single runs of its seeds and the lambda of the eigen solver
+	void TestBatchWithSetting(char *test, int years, int years_fw) {
+		char group[128];
+
+		sprintf_s(group,"%s Batch",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		settings.SetNFW(years_fw);
+		settings.SetNMinFW(years_fw);
+		settings.SetForwardBatchAllStarts(true);
+		Forward forwardB;
+		forwardB.SetDecision(decision);
+		double lambdaB = forwardB.ComputePopulationDynamics(&settings);
+
+		NArray<double> &lambdas = forwardB.GetBatchLambda();
+		NArray<double> &props   = forwardB.GetBatchDistribution();
+		unsigned int t_cnt = settings.GetTCnt();
+		unsigned int o_cnt = settings.GetOCnt();
+		unsigned int week  = props.GetSize() / (t_cnt*o_cnt);
+		if (!ExpectOkay(lambdas.GetSize() == t_cnt*o_cnt && props.GetDims() == 8, "Batch results have %d seeds",(int)lambdas.GetSize()))
+			return;
+		ExpectOkay(lambdaB == lambdas(settings.GetStartWeekFW(),0), "Batch lambda %.10f is not the one of the start week",lambdaB);
+
+		// Single runs of some seeds, their distribution of week 0 normalised to a total of one
+		settings.SetForwardBatchAllStarts(false);
+		unsigned int seeds[3][2] = { { 0, 1 }, { settings.GetStartWeekFW(), 1 }, { t_cnt-1, o_cnt } };
+		for (unsigned int i=0;i<3;i++) {
+			settings.SetStartWeekFW(seeds[i][0]);
+			settings.SetStartLocationFW(seeds[i][1]);
+			Forward forward;
+			forward.SetDecision(decision);
+			forward.ComputePopulationDynamics(&settings);
+
+			NArray<double> &p = forward.GetPopulationDynamics();
+			const double *pB = props.GetData() + week*(seeds[i][0] + t_cnt*(seeds[i][1]-1));
+			double sum = 0, err = 0;
+			for (unsigned int j=0;j<week;j++)
+				sum += p.GetData()[j];
+			for (unsigned int j=0;j<week;j++) {
+				double d = fabs(p.GetData()[j]/sum - pB[j]);
+				if (d > err)
+					err = d;
+			}
+			ExpectOkay(err < 1.0e-12, "Batch distribution of start week %d location %d differs by %g",seeds[i][0],seeds[i][1],err);
+		}
+
+		// All seeds share the dominant eigenvalue
+		settings.SetNFW(300);
+		settings.SetNMinFW(0);
+		settings.SetForwardEigenSolver(true);
+		Forward forwardE;
+		forwardE.SetDecision(decision);
+		double lambdaE = forwardE.ComputePopulationDynamics(&settings);
+
+		double err = 0;
+		for (unsigned int k=0;k<lambdas.GetSize();k++) {
+			double d = fabs(lambdas.GetData()[k] - lambdaE);
+			if (d > err)
+				err = d;
+		}
+		ExpectOkay(err < 1.0e-6, "Batch lambdas differ from the eigen solver lambda %.10f by %g",lambdaE,err);
+
+		TestGroup();
+	}
+
+	/// \brief The low-cost convergence check estimates the lambda of the per-state check from the weekly totals
+	void TestLowCostConvergenceWithSetting(char *test, int years, int years_fw) {
+		char group[128];
+
+		sprintf_s(group,"%s Low-cost convergence",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		Forward forward, forwardL, forwardE;
+		settings.SetNFW(years_fw);
+		settings.SetNMinFW(years_fw);
+		forward.SetDecision(decision);
+		double lambda = forward.ComputePopulationDynamics(&settings);
+
+		settings.SetForwardLowCostConvergence(true);
+		settings.SetForwardLowCostConvergenceFinalCheck(true);
+		forwardL.SetDecision(decision);
+		double lambdaL = forwardL.ComputePopulationDynamics(&settings);
+
+		ExpectOkay(fabs(lambda - lambdaL) < 1.0e-8, "Low-cost lambda %.10f differs from %.10f",lambdaL,lambda);
+		ExpectOkay(forward.GetPopulationDynamics() == forwardL.GetPopulationDynamics(), "Low-cost check changed the distribution");
+
+		// Stopping at convergence of the totals gives the dominant eigenvalue
+		settings.SetNMinFW(0);
+		settings.SetNFW(300);
+		Forward forwardC;
+		forwardC.SetDecision(decision);
+		double lambdaC = forwardC.ComputePopulationDynamics(&settings);
+
+		settings.SetForwardLowCostConvergence(false);
+		settings.SetForwardEigenSolver(true);
+		forwardE.SetDecision(decision);
+		double lambdaE = forwardE.ComputePopulationDynamics(&settings);
+
+		ExpectOkay(fabs(lambdaC - lambdaE) < settings.GetCrit(), "Converged low-cost lambda %.10f differs from %.10f",lambdaC,lambdaE);
+
+		TestGroup();
+	}
+
+	/// \brief The marginal summaries streamed during the sweep match the marginals of the final distribution
+	void TestMarginalsWithSetting(char *test, int years, int years_fw) {
+		char group[128], fileName[FILENAME_MAX];
+
+		sprintf_s(group,"%s Marginals",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		settings.SetNFW(years_fw);
+		settings.SetNMinFW(years_fw);
+
+		Forward forward, forwardM;
+		forward.SetDecision(decision);
+		double lambda = forward.ComputePopulationDynamics(&settings);
+
+		settings.SetForwardSaveMarginals(true);
+		forwardM.SetDecision(decision);
+		double lambdaM = forwardM.ComputePopulationDynamics(&settings);
+
+		ExpectOkay(lambda == lambdaM && forward.GetPopulationDynamics() == forwardM.GetPopulationDynamics(), "Marginals changed the distribution");
+
+		// Weeks 1.._t_cnt-1 of the final year are still in the distribution, week 0 belongs to the next year
+		NArray<double> &p = forwardM.GetPopulationDynamics();
+		NArray<double> occ, res, health;
+		occ.Init(4, p.GetDim(4), p.GetDim(6));
+		res.Init(p.GetDim(0), p.GetDim(6));
+		health.Init(p.GetDim(1), p.GetDim(6));
+		for (unsigned int t=1;t<p.GetDim(6);t++) 
+			for (unsigned int s=0;s<p.GetDim(5);s++) 
+				for (unsigned int o=0;o<p.GetDim(4);o++) 
+					for (unsigned int a=0;a<p.GetDim(3);a++) 
+						for (unsigned int e=0;e<p.GetDim(2);e++) 
+							for (unsigned int y=0;y<p.GetDim(1);y++) 
+								for (unsigned int x=0;x<p.GetDim(0);x++) {
+									double v = p(x,y,e,a,o,s,t);
+									res(x,t)    += v;
+									health(y,t) += v;
+									if (x > 0) {
+										char strat = decision->GetF_strat(x,y,e,a,o,s,t);
+										int  act   = (strat=='s') ? 1 : (strat=='c') ? 2 : (strat=='m') ? 3 : 0;
+										occ(act,o,t) += v;
+									}
+								}
+
+		double err = 0;
+		NArray<double> *mine[3] = { &occ, &res, &health };
+		NArray<double> *marg[3] = { &forwardM.GetMarginalOccupancy(), &forwardM.GetMarginalReserves(), &forwardM.GetMarginalHealth() };
+		for (unsigned int m=0;m<3;m++) {
+			if (!ExpectOkay(mine[m]->GetSize() == marg[m]->GetSize(), "Marginal %d has size %d instead of %d",m,(int)marg[m]->GetSize(),(int)mine[m]->GetSize()))
+				return;
+			unsigned int first = mine[m]->GetSize() / p.GetDim(6);
+			for (unsigned int i=first;i<mine[m]->GetSize();i++) {
+				double d = fabs(mine[m]->GetData()[i] - marg[m]->GetData()[i]);
+				if (d > err)
+					err = d;
+			}
+		}
+		ExpectOkay(err < 1.0e-12, "Marginals differ from the final distribution by %g",err);
+
+		// The file holds one record per year, the last one is the final year
+		sprintf_s(fileName,"%s_marginals_FW.bin",settings.GetFilePrefixFW());
+		FILE *file = fopen(fileName,"rb");
+		if (!ExpectOkay(file != 0, "Opening '%s'",fileName))
+			return;
+		unsigned int y = 0, year = 0, records = 0, expected = years_fw;
+		NArray<double> fOcc, fRes, fHealth;
+		while (fread(&y,1,sizeof(unsigned int),file) == sizeof(unsigned int) && fOcc.LoadBinary(file) && fRes.LoadBinary(file) && fHealth.LoadBinary(file)) {
+			year = y;
+			records++;
+		}
+		fclose(file);
+		ExpectOkay(records == expected && year == expected-1, "File has %u records, last year %u",records,year);
+		ExpectOkay(fOcc == forwardM.GetMarginalOccupancy() && fRes == forwardM.GetMarginalReserves() && fHealth == forwardM.GetMarginalHealth(), "Last record differs from the final year");
+
+		TestGroup();
+	}
+
+	/// \brief The life-history metrics are consistent and their survivorship matches a forward run without young
+	void TestLifeHistoryWithSetting(char *test, int years, int years_fw) {
+		char group[128];
+
+		sprintf_s(group,"%s Life history",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		settings.SetNFW(years_fw);
+		settings.SetNMinFW(years_fw);
+
+		Forward forwardL;
+		forwardL.SetDecision(decision);
+		forwardL.ComputeLifeHistory(&settings);
+		Forward::FwLifeHistoryStruct &lh = forwardL.GetLifeHistory();
+
+		double total = lh.p_death[0] + lh.p_death[1] + lh.p_death[2] + lh.remaining;
+		ExpectOkay(fabs(total - 1.0) < 1.0e-10, "Death probabilities and remaining sum up to %.12f",total);
+		ExpectOkay(lh.remaining < 1.0e-9, "Remaining probability %g",lh.remaining);
+		ExpectOkay(lh.reproductive_output > 0 && lh.p_breeding > 0 && lh.p_breeding <= 1.0, "Reproductive output %g, probability of breeding %g",lh.reproductive_output,lh.p_breeding);
+
+		bool decreasing = lh.survivorship.size() > (unsigned int)years_fw && lh.survivorship[0] == 1.0;
+		for (unsigned int i=1;i<lh.survivorship.size();i++)
+			decreasing = decreasing && lh.survivorship[i] <= lh.survivorship[i-1];
+		ExpectOkay(decreasing, "Survivorship of %d years not decreasing from 1",lh.survivorship.size());
+
+		double weeks = 0;
+		for (unsigned int i=0;i<lh.departures.GetSize();i++)
+			weeks += lh.departures.GetData()[i];
+		ExpectOkay(weeks < lh.life_expectancy, "Departures %g exceed the life expectancy %g",weeks,lh.life_expectancy);
+
+		// Without young the forward run follows the starting cohort, the start week of the final year is years_fw-1 years old
+		settings.SetNBrood(0);
+		Forward forward;
+		forward.SetDecision(decision);
+		forward.ComputePopulationDynamics(&settings);
+
+		NArray<double> &p = forward.GetPopulationDynamics();
+		unsigned int week = p.GetSize() / p.GetDim(6);
+		const double *pw  = p.GetData() + settings.GetStartWeekFW()*week;
+		double alive = 0;
+		for (unsigned int i=0;i<week;i++) {
+			if (i % p.GetDim(0) != 0)
+				alive += pw[i];
+		}
+		double d = fabs(alive - lh.survivorship[years_fw-1]);
+		ExpectOkay(d < 1.0e-12, "Survivorship %.12f of year %d differs from the forward run %.12f",lh.survivorship[years_fw-1],years_fw-1,alive);
+
+		TestGroup();
+	}
+
+	/// \brief Loads the policy of a year of the horizon saved by Backward::ComputeHorizon()
+	bool LoadHorizonPolicy(Settings &settings, unsigned int year, NArray<double> &f_u, NArray<char> &f_strat) {
+		char fileName[FILENAME_MAX];
+		sprintf_s(fileName,DC_HORIZON_POLICY_FILE,settings.GetFilePrefix(),year);
+		FILE *file = fopen(fileName,"rb");
+		if (!ExpectOkay(file != 0, "Opening '%s'",fileName))
+			return false;
+		bool ok = f_u.LoadBinary(file) && f_strat.LoadBinary(file);
+		fclose(file);
+		return ExpectOkay(ok, "Reading '%s'",fileName);
+	}
+
+	/// \brief The horizon of a repeated year reproduces the stationary run, a different first year only changes its own policy
+	void TestHorizonWithSetting(char *test, int years, unsigned int horizon) {
+		char group[128];
+
+		sprintf_s(group,"%s Horizon",test);
+
+		TestGroup(group);
+
+		Settings settings;
+		Decision *decision = LoadSettingAndDecision(test, years, settings);
+		if (!decision)
+			return;
+
+		settings.SetNFW(horizon);
+		settings.SetNMinFW(horizon);
+
+		Forward forward;
+		forward.SetDecision(decision);
+		forward.ComputePopulationDynamics(&settings);
+
+		// The food supply of the sine wave repeated for each year of the horizon
+		unsigned int t_cnt = settings.GetTCnt();
+		unsigned int o_cnt = settings.GetOCnt();
+		NArray<double> eps  = settings.GetEps();
+		NArray<double> abar = settings.GetABar();
+		NArray<double> food;
+		food.Init(t_cnt*horizon, o_cnt);
+		for (unsigned int y=0;y<horizon;y++)
+			for (unsigned int t=0;t<t_cnt;t++)
+				for (unsigned int o=0;o<o_cnt;o++)
+					food(y*t_cnt+t,o) = (eps[o] * sin( (t - (t_cnt / 4.0)) * 2.0 * M_PI / t_cnt ) + abar[o]) * (settings.GetXMax() - settings.GetXMin());
+
+		settings.SetEnvFoodSupply(food);
+		settings.SetEnvYears(horizon);
+
+		Decision decisionH;
+		Backward backwardH;
+		backwardH.SetDecision(&decisionH);
+		backwardH.ComputeHorizon(&settings, settings.GetTheta());
+
+		Forward forwardH;
+		forwardH.SetDecision(&decisionH);
+		forwardH.ComputePopulationDynamics(&settings);
+
+		NArray<double> &p  = forward.GetPopulationDynamics();
+		NArray<double> &pH = forwardH.GetPopulationDynamics();
+		if (!ExpectOkay(p.GetSize() == pH.GetSize(), "Horizon distribution has size %d instead of %d",(int)pH.GetSize(),(int)p.GetSize()))
+			return;
+		double sum = 0, err = 0;
+		for (unsigned int i=0;i<p.GetSize();i++) {
+			double d = fabs(p.GetData()[i] - pH.GetData()[i]);
+			sum += p.GetData()[i];
+			if (d > err)
+				err = d;
+		}
+		ExpectOkay(err < 1.0e-6*sum, "Horizon of a repeated year differs from the stationary run by %g of %g",err,sum);
+
+		std::vector<NArray<double> > f_u(horizon);
+		std::vector<NArray<char> >   f_strat(horizon);
+		for (unsigned int y=0;y<horizon;y++) {
+			if (!LoadHorizonPolicy(settings, y, f_u[y], f_strat[y]))
+				return;
+		}
+
+		// A poorer first year leaves the policies of the later years unchanged
+		for (unsigned int t=0;t<t_cnt;t++)
+			for (unsigned int o=0;o<o_cnt;o++)
+				food(t,o) *= 0.8;
+		settings.SetEnvFoodSupply(food);
+
+		Decision decisionP;
+		Backward backwardP;
+		backwardP.SetDecision(&decisionP);
+		backwardP.ComputeHorizon(&settings, settings.GetTheta());
+
+		for (unsigned int y=0;y<horizon;y++) {
+			NArray<double> u;
+			NArray<char>   strat;
+			if (!LoadHorizonPolicy(settings, y, u, strat))
+				return;
+			bool same = (u == f_u[y]) && (strat == f_strat[y]);
+			if (y == 0)
+				ExpectFail(same, "Policy of the poorer year %d unchanged",y);
+			else
+				ExpectOkay(same, "Policy of year %d changed by the first year",y);
+		}
+
+		TestGroup();
 	}
 
 	void RunTests() {		
+		TestEigenSolverWithSetting("NoHealth", 30, 300);
+		TestMonteCarloWithSetting("NoHealth", 30, 40, 20000);
+		TestBatchWithSetting("NoHealth", 30, 60);
+		TestLowCostConvergenceWithSetting("NoHealth", 30, 60);
+		TestMarginalsWithSetting("NoHealth", 30, 20);
+		TestLifeHistoryWithSetting("Reproduction_4x4", 30, 5);
+		TestHorizonWithSetting("NoHealth", 30, 3);
 	}
 };
 
@@ -0,0 +1,145 @@
+/**
+* \file UtGridAxis.cpp
+* \brief Implementation of UtGridAxis to test the GridAxis class
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <math.h>
+#include <stdlib.h>
+
+#include "UnitTest.h"
+
+#include "../soar_support_lib/GridAxis.h"
+
+
+/**
+ * \ingroup Tests
+ * \brief UnitTest for GridAxis class
+ */
+class UtGridAxis : public UnitTest {
+private:
+	double _eps;				///< Epsilon used for comparison
+
+public:
+
+	/// \brief The constructor registers at the UnitTestManager
+	UtGridAxis() : UnitTest("GridAxis") , _eps(0.0000001)
+	{
+	}
+
+	/// \brief Returns the last node <= v by linear search, limited to the grid
+	int LinearLowerIndex(GridAxis &grid, double v) {
+		int i = 0;
+		while (i+1 < (int)grid.GetCount() && grid[i+1] <= v)
+			i++;
+		return i;
+	}
+
+	/// \brief Returns a value in [lo,hi] taken from the test values
+	double GenValue(int &idx, double lo, double hi) {
+		return lo + (hi-lo) * GetNextIntTestValue(idx, 0, 100000) / 100000.0;
+	}
+
+	void TestUniformGrid() {
+		TestGroup("Uniform grid");
+		//=============================== Nodes and lookup equal the fixed dx arithmetic (N-test cases)
+
+		int idx0 = 17;
+		for(int tests=0; tests<20; tests++) {
+			int    intervals = GetNextIntTestValue(idx0, 1, 40);
+			double min       = GenValue(idx0, -5.0, 5.0);
+			double max       = min + GenValue(idx0, 0.5, 20.0);
+			double d         = (max-min) / intervals;
+
+			GridAxis grid;
+			grid.Init(min, max, intervals);
+			ExpectOkay(grid.IsUniform(), "Ratio 1.0 gives a uniform grid");
+			ExpectOkay(grid.GetCount() == (unsigned int)intervals+1, "Node count");
+
+			bool same = true;
+			for(int i=0; i<=intervals; i++) {
+				if (fabs(grid[i] - (min+i*d)) > _eps || fabs(grid.InverseSpacing(i) - 1.0/d) > _eps)
+					same = false;
+			}
+			ExpectOkay(same, "Uniform nodes differ from min+i*dx");
+
+			for(int v=0; v<10; v++) {
+				double val = GenValue(idx0, min-1.0, max+1.0);
+				int    exp = (int)((val-min) / d);
+				if (exp < 0)
+					exp = 0;
+				if (exp > intervals)
+					exp = intervals;
+				ExpectOkay(grid.LowerIndex(val) == exp, "Uniform lookup of %f", val);
+			}
+		}
+		TestGroup();
+	}
+
+	void TestGeometricGrid() {
+		TestGroup("Geometric grid");
+		//=============================== Nodes span [min,max] and lookup equals a linear search (N-test cases)
+
+		int idx0 = 43;
+		for(int tests=0; tests<20; tests++) {
+			int    intervals = GetNextIntTestValue(idx0, 2, 60);
+			double ratio     = GenValue(idx0, 0.8, 1.3);
+			double min       = GenValue(idx0, -2.0, 2.0);
+			double max       = min + GenValue(idx0, 1.0, 30.0);
+
+			GridAxis grid;
+			grid.Init(min, max, intervals, ratio);
+			ExpectOkay(fabs(grid[0]-min) < _eps && fabs(grid[intervals]-max) < _eps, "First and last node equal min and max");
+
+			bool monotonic = true;
+			bool spacing   = true;
+			for(int i=0; i<intervals; i++) {
+				if (grid[i+1] <= grid[i])
+					monotonic = false;
+				if (fabs(grid.InverseSpacing(i) * (grid[i+1]-grid[i]) - 1.0) > _eps)
+					spacing = false;
+				if (i>0 && fabs((grid[i+1]-grid[i]) / (grid[i]-grid[i-1]) - ratio) > 0.00001)
+					spacing = false;
+			}
+			ExpectOkay(monotonic, "Nodes are increasing");
+			ExpectOkay(spacing,   "Interval widths follow the ratio %f", ratio);
+
+			// Random values and the nodes themselves
+			for(int v=0; v<20; v++) {
+				double val = GenValue(idx0, min-1.0, max+1.0);
+				ExpectOkay(grid.LowerIndex(val) == LinearLowerIndex(grid,val), "Geometric lookup of %f", val);
+			}
+			bool nodes = true;
+			for(int i=0; i<=intervals; i++) {
+				if (grid.LowerIndex(grid[i]) != i)
+					nodes = false;
+			}
+			ExpectOkay(nodes, "Lookup of the node values");
+		}
+		TestGroup();
+	}
+
+	void RunTests() {
+		TestUniformGrid();
+		TestGeometricGrid();
+	}
+};
+
+UtGridAxis test_GridAxis;  ///< Global instance automatically registers to UnitTestManager
@@ -0,0 +1,185 @@
+/**
+* \file UtGridStencil.cpp
+* \brief Implementation of UtGridStencil to test the GridStencil templates
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <math.h>
+#include <stdlib.h>
+
+#include "UnitTest.h"
+
+#include "../soar_support_lib/GridStencil.h"
+
+
+/**
+ * \ingroup Tests
+ * \brief UnitTest for GridStencil templates
+ */
+class UtGridStencil : public UnitTest {
+private:
+	double _eps;				///< Epsilon used for comparison
+
+public:
+
+	/// \brief The constructor registers at the UnitTestManager
+	UtGridStencil() : UnitTest("GridStencil") , _eps(0.0000001)
+	{
+	}
+
+	/// \brief Returns a value in [lo,hi] taken from the test values
+	double GenValue(int &idx, double lo, double hi) {
+		return lo + (hi-lo) * GetNextIntTestValue(idx, 0, 100000) / 100000.0;
+	}
+
+	/// \brief Checks the weights of an axis: within the grid, summing up to 1 and keeping the mean value
+	template <int W>
+	void CheckAxis(GridAxis &grid, double v, double stochfac, bool interior) {
+		int    idx[W];
+		double p[W];
+		GridStencilAxis<W>::Nodes(grid, v, stochfac, idx, p);
+
+		bool   inside = true;
+		double sum = 0, mean = 0;
+		for (int i=0;i<W;i++) {
+			if (idx[i] < 0 || idx[i] >= (int)grid.GetCount() || p[i] < -_eps)
+				inside = false;
+			sum  += p[i];
+			mean += p[i] * grid[idx[i]];
+		}
+		ExpectOkay(inside, "Width %d nodes of %f within the grid, weights not negative", W, v);
+		ExpectOkay(fabs(sum-1.0) < _eps, "Width %d weights of %f sum up to %f", W, v, sum);
+		if (interior)
+			ExpectOkay(fabs(mean-v) < _eps, "Width %d interpolation of %f gives %f", W, v, mean);
+	}
+
+	/// \brief Checks the separable interpolation against the sum over all node pairs
+	template <int WX, int WY>
+	void CheckStencil(GridAxis &x_grid, GridAxis &y_grid, NArray<double> &f, double x, double y, double stochfac) {
+		GridStencil<WX,WY> st(x_grid, y_grid, x, y, stochfac);
+
+		double sum = 0;
+		for (int i=0;i<WX;i++)
+			for (int j=0;j<WY;j++)
+				sum += st.x_p[i] * st.y_p[j] * f(st.x_idx[i], st.y_idx[j]);
+
+		double val = st.Apply(f.GetData(), f.GetDim(0));
+		ExpectOkay(fabs(val-sum) < _eps * (1.0+fabs(sum)), "Stencil %dx%d at (%f,%f) gives %f instead of %f", WX, WY, x, y, val, sum);
+	}
+
+	void TestAxis() {
+		TestGroup("Axis weights");
+		//=============================== Weights on uniform and geometric grids (N-test cases)
+
+		int idx0 = 29;
+		for(int tests=0; tests<20; tests++) {
+			int    intervals = GetNextIntTestValue(idx0, 2, 40);
+			double ratio     = (tests%2) ? GenValue(idx0, 0.8, 1.3) : 1.0;
+			double min       = GenValue(idx0, -2.0, 2.0);
+			double max       = min + GenValue(idx0, 1.0, 20.0);
+			double stochfac  = GenValue(idx0, 0.0, 0.5);
+
+			GridAxis grid;
+			grid.Init(min, max, intervals, ratio);
+
+			for(int v=0; v<10; v++) {
+				double val = GenValue(idx0, min, max);
+				CheckAxis<2>(grid, val, stochfac, true);
+
+				// The stochasticity keeps the mean only for equally wide intervals inside the grid
+				bool interior = grid.IsUniform() && grid.LowerIndex(val) > 0 && grid.LowerIndex(val)+2 < (int)grid.GetCount();
+				CheckAxis<4>(grid, val, stochfac, interior);
+			}
+		}
+		TestGroup();
+	}
+
+	void TestSeparable() {
+		TestGroup("Separable interpolation");
+		//=============================== All width combinations against the full sum (N-test cases)
+
+		int idx0 = 71;
+		for(int tests=0; tests<10; tests++) {
+			int    x_int    = GetNextIntTestValue(idx0, 2, 30);
+			int    y_int    = GetNextIntTestValue(idx0, 2, 30);
+			double stochfac = GenValue(idx0, 0.0, 0.5);
+
+			GridAxis x_grid, y_grid;
+			x_grid.Init(0.0, 10.0, x_int, (tests%2) ? 1.1 : 1.0);
+			y_grid.Init(0.0,  5.0, y_int);
+
+			NArray<double> f;
+			f.Init(x_int+1, y_int+1);
+			for (unsigned int i=0;i<f.GetSize();i++)
+				f.GetData()[i] = GenValue(idx0, 0.0, 3.0);
+
+			for(int v=0; v<10; v++) {
+				double x = GenValue(idx0, 0.0, 10.0);
+				double y = GenValue(idx0, 0.0,  5.0);
+				CheckStencil<2,2>(x_grid, y_grid, f, x, y, stochfac);
+				CheckStencil<4,2>(x_grid, y_grid, f, x, y, stochfac);
+				CheckStencil<2,4>(x_grid, y_grid, f, x, y, stochfac);
+				CheckStencil<4,4>(x_grid, y_grid, f, x, y, stochfac);
+			}
+		}
+		TestGroup();
+	}
+
+	void TestStrided() {
+		TestGroup("Strided slices");
+		//=============================== Transposed slice gives the same interpolation (N-test cases)
+
+		int idx0 = 53;
+		for(int tests=0; tests<10; tests++) {
+			int x_int = GetNextIntTestValue(idx0, 2, 30);
+			int y_int = GetNextIntTestValue(idx0, 2, 30);
+
+			GridAxis x_grid, y_grid;
+			x_grid.Init(0.0, 10.0, x_int);
+			y_grid.Init(0.0,  5.0, y_int);
+
+			NArray<double> f, ft;
+			f.Init(x_int+1, y_int+1);
+			ft.Init(y_int+1, x_int+1);
+			for (int x=0;x<=x_int;x++)
+				for (int y=0;y<=y_int;y++)
+					f(x,y) = ft(y,x) = GenValue(idx0, 0.0, 3.0);
+
+			for(int v=0; v<10; v++) {
+				double x = GenValue(idx0, 0.0, 10.0);
+				double y = GenValue(idx0, 0.0,  5.0);
+				GridStencil<4,4> st(x_grid, y_grid, x, y, 0.2);
+
+				double val  = st.Apply(f.GetData(), f.GetDim(0));
+				double valT = st.Apply(ft.GetData(), ft.GetDim(0), 1);
+				ExpectOkay(val == valT, "Transposed slice at (%f,%f) gives %f instead of %f", x, y, valT, val);
+			}
+		}
+		TestGroup();
+	}
+
+	void RunTests() {
+		TestAxis();
+		TestSeparable();
+		TestStrided();
+	}
+};
+
+UtGridStencil test_GridStencil;  ///< Global instance automatically registers to UnitTestManager
@@ -546,12 +546,123 @@ public:
 			ExpectFail(assertThrown, "Did throw assert()");
 		}
 
+		TestGroup("Array swap");
+		//=============================== Swap exchanges dimensions and data without copying
+		idxA = 23;
+		idxB = 57;
+		for(int tests=0; tests<100; tests++) {
+			int dimsA = GetNextIntTestValue(idxA, 1, 10);
+			int dimsB = GetNextIntTestValue(idxB, 1, 10);
+			int dimA[10],dimB[10];
+
+			NArray<int> arrA,arrB;
+			GenNArray<int>(arrA, idxA, dimsA, dimA);
+			GenNArray<int>(arrB, idxB, dimsB, dimB);
+
+			NArray<int> copyA(arrA), copyB(arrB);
+			int *dataA = arrA.GetData();
+			int *dataB = arrB.GetData();
+
+			arrA.Swap(arrB);
+
+			ExpectOkay(arrA == copyB, "Swapped array A differs from B");
+			ExpectOkay(arrB == copyA, "Swapped array B differs from A");
+			ExpectOkay(arrA.GetData() == dataB && arrB.GetData() == dataA, "Swap copied the data");
+
+			swap(arrA, arrB);
+			ExpectOkay(arrA.GetData() == dataA && arrB.GetData() == dataB, "swap() did not exchange the data");
+		}
+
+		TestGroup("Array assignment in place");
+		//=============================== Assignment of same dimensions keeps the data memory
+		idxA = 31;
+		for(int tests=0; tests<100; tests++) {
+			int dimsA = GetNextIntTestValue(idxA, 1, 10);
+			int dimA[10];
+
+			NArray<int> arrA;
+			GenNArray<int>(arrA, idxA, dimsA, dimA);
+			for(size_t i=0; i<arrA.GetSize(); i++)
+				arrA.GetData()[i] = GetNextIntTestValue(idxA, -100, 100);
+
+			NArray<int> arrB(arrA);
+			arrB.Fill(0);
+			int *dataB = arrB.GetData();
+
+			arrB = arrA;
+			arrB = arrB;
+			ExpectOkay(arrB == arrA && arrB.GetData() == dataB, "Assignment reallocated or differs");
+		}
+
+#ifdef NARRAY_HAS_MOVE
+		TestGroup("Array move");
+		//=============================== Move construction and assignment take over the data memory
+		idxA = 47;
+		for(int tests=0; tests<100; tests++) {
+			int dimsA = GetNextIntTestValue(idxA, 1, 10);
+			int dimA[10];
+
+			NArray<int> arrA;
+			GenNArray<int>(arrA, idxA, dimsA, dimA);
+			arrA.Fill(tests);
+			NArray<int> copyA(arrA);
+			int *dataA = arrA.GetData();
+
+			NArray<int> arrB(static_cast<NArray<int> &&>(arrA));
+			ExpectOkay(arrB == copyA && arrB.GetData() == dataA && arrA.GetDims() == 0, "Move construction");
+
+			NArray<int> arrC;
+			arrC = static_cast<NArray<int> &&>(arrB);
+			ExpectOkay(arrC == copyA && arrC.GetData() == dataA && arrB.GetDims() == 0, "Move assignment");
+		}
+#endif
+
 		TestGroup();
 	}
 
 
 
 
+	void TestStorage() {
+		TestGroup("Aligned storage");
+		//=============================== Small arrays come from the aligned heap (N-test cases)
+		int idx0 = 71;
+		for(int tests=0; tests<100; tests++) {
+			int dims = GetNextIntTestValue(idx0, 1, 10);
+			int dim[10];
+
+			NArray<char> arr;
+			GenNArray<char>(arr, idx0, dims, dim);
+			NArray<char> copy(arr);
+
+			ExpectOkay( ((size_t)arr.GetData()  % NARRAY_ALIGNMENT)==0, "Data not aligned");
+			ExpectOkay( ((size_t)copy.GetData() % NARRAY_ALIGNMENT)==0, "Copied data not aligned");
+		}
+
+		TestGroup("Large storage");
+		//=============================== Large arrays are mapped and zeroed lazily (5 test cases)
+		NArray<double> big(512,512,4);
+		ExpectOkay( big.GetSize()*sizeof(double) >= NARRAY_LARGE_BYTES, "Array is not large");
+		ExpectOkay( ((size_t)big.GetData() % NARRAY_ALIGNMENT)==0, "Large data not aligned");
+
+		bool zero = true;
+		for(size_t i=0; i<big.GetSize(); i+=97)
+			zero &= big.GetData()[i]==0.0;
+		ExpectOkay( zero && big(511,511,3)==0.0, "Large data not zeroed");
+
+		big(511,511,3) = 42.0;
+		NArray<double> bigCopy(big);
+		ExpectOkay( bigCopy==big && bigCopy(511,511,3)==42.0, "Large copy differs");
+
+		// Swapping a large with a small array keeps the free mechanism of each data block
+		NArray<double> small(3,4);
+		small.Swap(big);
+		big.Init(2,2);
+		ExpectOkay( small(511,511,3)==42.0 && big.GetSize()==4, "Swap of large and small array");
+
+		TestGroup();
+	}
+
 	void Test1DArraySpecials() {
 		TestGroup("1D array with const array");
 		//=============================== For 1D Array check initialization with constant array
@@ -783,6 +894,7 @@ public:
 		TestCompareOperator();
 		Test1DArraySpecials();
 		TestBinaryFileIO();
+		TestStorage();
 	}
 };
 
@@ -0,0 +1,149 @@
+/**
+* \file UtNArrayFixed.cpp
+* \brief Implementation of UtNArrayFixed to test the NArrayFixed class
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <math.h>
+#include <stdlib.h>
+
+#include "UnitTest.h"
+
+#include "../soar_support_lib/NArrayFixed.h"
+
+
+/**
+ * \ingroup Tests
+ * \brief UnitTest for NArrayFixed class
+ */
+class UtNArrayFixed : public UnitTest {
+
+public:
+
+	/// \brief The constructor registers at the UnitTestManager
+	UtNArrayFixed() : UnitTest("NArrayFixed")
+	{
+	}
+
+	void TestAccess() {
+		TestGroup("Access 2D and 7D");
+		//=============================== Same elements as the NArray access operators (N-test cases)
+
+		int idx0 = 17;
+		for(int tests=0; tests<20; tests++) {
+			unsigned int d[7];
+			for (int i=0;i<7;i++)
+				d[i] = GetNextIntTestValue(idx0, 1, 5);
+
+			NArray<int> arr(d[0],d[1],d[2],d[3],d[4],d[5],d[6]);
+			for (unsigned int i=0;i<arr.GetSize();i++)
+				arr.GetData()[i] = (int)i;
+
+			NArrayFixed<int,7> fix(arr);
+			bool same = fix.GetData()==arr.GetData();
+			for (unsigned int i=0;i<7;i++)
+				same &= fix.GetDim(i)==d[i];
+			for (int k=0;k<50;k++) {
+				unsigned int x = GetNextIntTestValue(idx0, 0, d[0]-1), y = GetNextIntTestValue(idx0, 0, d[1]-1);
+				unsigned int e = GetNextIntTestValue(idx0, 0, d[2]-1), a = GetNextIntTestValue(idx0, 0, d[3]-1);
+				unsigned int o = GetNextIntTestValue(idx0, 0, d[4]-1), s = GetNextIntTestValue(idx0, 0, d[5]-1);
+				unsigned int t = GetNextIntTestValue(idx0, 0, d[6]-1);
+				same &= &fix(x,y,e,a,o,s,t) == &arr(x,y,e,a,o,s,t);
+			}
+			ExpectOkay(same, "7D access differs from NArray");
+
+			NArray<double> arr2(d[0],d[1]);
+			NArrayFixed<double,2> fix2(arr2);
+			fix2(d[0]-1,d[1]-1) = 42.0;
+			ExpectOkay(arr2(d[0]-1,d[1]-1)==42.0, "2D write through NArrayFixed");
+		}
+		TestGroup();
+	}
+
+	void TestAttach() {
+		TestGroup("Attach");
+		//=============================== Re-attachment after Swap, empty arrays and rank mismatch (4 test cases)
+
+		NArray<double> a(3,4,5), b(2,2,2);
+		a(2,3,4) = 1.0;
+		b(1,1,1) = 2.0;
+
+		NArrayFixed<double,3> fix(a);
+		a.Swap(b);
+		fix.Attach(a);
+		ExpectOkay(fix.GetDim(0)==2 && fix(1,1,1)==2.0, "Attach after Swap");
+
+		NArray<double> empty;
+		fix.Attach(empty);
+		ExpectOkay(fix.GetData()==0, "Attach to an empty NArray");
+
+		bool assertThrown = false;
+		try { NArrayFixed<double,2> wrong(b); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "Attach to an NArray of other dimensionality");
+
+		assertThrown = false;
+		fix.Attach(b);
+		try { fix(3,0,0); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "Access out of bounds");
+
+		TestGroup();
+	}
+
+	void TestAttachView() {
+		TestGroup("Attach view");
+		//=============================== Permuted and fixed views of an NArray (3 test cases)
+
+		NArray<int> arr(3,4,5);
+		for (unsigned int i=0;i<arr.GetSize();i++)
+			arr.GetData()[i] = (int)i;
+
+		// Dimensions 0 and 1 swapped
+		unsigned int dims[3]    = { 4, 3, 5 };
+		size_t       strides[3] = { 3, 1, 12 };
+		NArrayFixed<int,3> perm(NArrayView<int>(arr.GetData(), 3, dims, strides));
+		bool same = perm.GetDim(0)==4 && perm.GetDim(1)==3;
+		for (unsigned int x=0;x<3;x++)
+			for (unsigned int y=0;y<4;y++)
+				for (unsigned int z=0;z<5;z++)
+					same &= &perm(y,x,z) == &arr(x,y,z);
+		ExpectOkay(same, "Access through a permuted view");
+
+		// Dimension 1 fixed, dimension 0 is no longer the fastest
+		NArrayFixed<int,2> fix(arr.View().Fix(0, 2));
+		same = fix.GetDim(0)==4 && fix.GetDim(1)==5;
+		for (unsigned int y=0;y<4;y++)
+			for (unsigned int z=0;z<5;z++)
+				same &= &fix(y,z) == &arr(2,y,z);
+		ExpectOkay(same, "Access through a view with fixed dimension 0");
+
+		fix.Attach(NArrayView<int>());
+		ExpectOkay(fix.GetData()==0, "Attach to an empty view");
+
+		TestGroup();
+	}
+
+	void RunTests() {
+		TestAccess();
+		TestAttach();
+		TestAttachView();
+	}
+};
+
+UtNArrayFixed test_NArrayFixed;  ///< Global instance automatically registers to UnitTestManager
@@ -0,0 +1,289 @@
+/**
+* \file UtNArrayView.cpp
+* \brief Implementation of UtNArrayView to test the NArrayView class and the NArray slices
+*
+*  Copyright (C) 2015-2016 Damaris Zurell (damaris.zurell@wsl.ch), 
+*  Merlin Schaefer (mschaefer@uni-potsdam.de). All rights reserved.
+*
+*  This file is part of sOAR.
+*
+*  sOAR is free software: you can redistribute it and/or modify
+*  it under the terms of the GNU General Public License as published by
+*  the Free Software Foundation, either version 3 of the License, or
+*  (at your option) any later version.
+*
+*  sOAR is distributed in the hope that it will be useful,
+*  but WITHOUT ANY WARRANTY; without even the implied warranty of
+*  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*  GNU General Public License for more details.
+*
+*  You should have received a copy of the GNU General Public License
+*  along with sOAR.  If not, see <http://www.gnu.org/licenses/>.
+*
+*/
+#include <math.h>
+#include <stdlib.h>
+
+#include "UnitTest.h"
+
+#include "../soar_support_lib/NArray.h"
+
+
+/**
+ * \ingroup Tests
+ * \brief UnitTest for NArrayView class
+ */
+class UtNArrayView : public UnitTest {
+
+public:
+
+	/// \brief The constructor registers at the UnitTestManager
+	UtNArrayView() : UnitTest("NArrayView")
+	{
+	}
+
+	/// \brief Fills a 7D array with the linear index of each element
+	void GenArray(NArray<int> &arr, int &idx, int dim[7]) {
+		for (int i=0;i<7;i++)
+			dim[i] = GetNextIntTestValue(idx, 1, 5);
+		arr.Init(dim[0],dim[1],dim[2],dim[3],dim[4],dim[5],dim[6]);
+		for (unsigned int i=0;i<arr.GetSize();i++)
+			arr.GetData()[i] = (int)i;
+	}
+
+	void TestSlice() {
+		TestGroup("Slices");
+		//=============================== Slices of the leading dimensions (N-test cases)
+
+		int idx0 = 13;
+		for(int tests=0; tests<20; tests++) {
+			NArray<int> arr;
+			int dim[7];
+			GenArray(arr, idx0, dim);
+
+			int x = GetNextIntTestValue(idx0, 0, dim[0]-1);
+			int e = GetNextIntTestValue(idx0, 0, dim[2]-1);
+			int a = GetNextIntTestValue(idx0, 0, dim[3]-1);
+			int o = GetNextIntTestValue(idx0, 0, dim[4]-1);
+			int s = GetNextIntTestValue(idx0, 0, dim[5]-1);
+			int t = GetNextIntTestValue(idx0, 0, dim[6]-1);
+
+			// f(:,:,e,a,o,s,t)
+			NArrayView<int> xy = arr.Slice(2, e,a,o,s,t);
+			bool same = xy.IsContiguous() && xy.GetDims()==2 && xy.GetSize()==(unsigned int)(dim[0]*dim[1]);
+			for (int yi=0;yi<dim[1];yi++)
+				for (int xi=0;xi<dim[0];xi++)
+					same &= xy(xi,yi)==arr(xi,yi,e,a,o,s,t) && xy.GetData()[xi+yi*dim[0]]==arr(xi,yi,e,a,o,s,t);
+			ExpectOkay(same, "Slice(2) of a 7D array");
+
+			// f(:,:,:,:,:,:,t)
+			NArrayView<int> week = arr.Slice(6, t);
+			same = week.IsContiguous() && week.GetDims()==6 && week.GetData()==&arr(0,0,0,0,0,0,t);
+			ExpectOkay(same, "Slice(6) of a 7D array");
+
+			// f(x,:,e,a,o,s,t) is strided
+			NArrayView<int> col = xy.Fix(0, x);
+			same = col.GetDims()==1 && col.GetStride(0)==(unsigned int)dim[0];
+			for (int yi=0;yi<dim[1];yi++)
+				same &= col(yi)==arr(x,yi,e,a,o,s,t);
+			ExpectOkay(same, "Fix(0) of a 2D slice");
+
+			// the whole array
+			NArrayView<int> all = arr.View();
+			ExpectOkay(all.IsContiguous() && all.GetSize()==arr.GetSize() && all.GetData()==arr.GetData(), "View of a 7D array");
+		}
+		TestGroup();
+	}
+
+	void TestBulk() {
+		TestGroup("Bulk operations");
+		//=============================== Fill, Zero and CopyFrom on contiguous and strided views (N-test cases)
+
+		int idx0 = 37;
+		for(int tests=0; tests<20; tests++) {
+			NArray<int> arr;
+			int dim[7];
+			GenArray(arr, idx0, dim);
+			NArray<int> ref(arr);
+
+			int y = GetNextIntTestValue(idx0, 0, dim[1]-1);
+			int t = GetNextIntTestValue(idx0, 0, dim[6]-1);
+
+			// Strided fill of all elements with y fixed in week t
+			arr.Slice(6, t).Fix(1, y).Fill(-1);
+			for (int x=0;x<dim[0];x++)
+			for (int e=0;e<dim[2];e++)
+			for (int a=0;a<dim[3];a++)
+			for (int o=0;o<dim[4];o++)
+			for (int s=0;s<dim[5];s++)
+				ref(x,y,e,a,o,s,t) = -1;
+			ExpectOkay(arr==ref, "Strided Fill() of a 5D view");
+
+			// Contiguous zeroing of week t
+			arr.Slice(6, t).Zero();
+			for (unsigned int i=0;i<ref.GetSize()/dim[6];i++)
+				ref.GetData()[i + t*(ref.GetSize()/dim[6])] = 0;
+			ExpectOkay(arr==ref, "Contiguous Zero() of a 6D view");
+
+			// Copy of a week into another array, contiguous and strided
+			NArray<int> dst(dim[0],dim[1],dim[2],dim[3],dim[4],dim[5],dim[6]);
+			int tt = (t+1) % dim[6];
+			dst.Slice(6, tt).CopyFrom(arr.Slice(6, tt));
+			dst.Slice(6, tt).Fix(1, y).Fill(7);
+			dst.Slice(6, tt).Fix(1, y).CopyFrom(arr.Slice(6, tt).Fix(1, y));
+			bool same = true;
+			for (unsigned int i=0;i<arr.GetSize();i++) {
+				bool inWeek = (i / (arr.GetSize()/dim[6])) == (unsigned int)tt;
+				same &= dst.GetData()[i] == (inWeek ? arr.GetData()[i] : 0);
+			}
+			ExpectOkay(same, "CopyFrom() of contiguous and strided views");
+		}
+		TestGroup();
+	}
+
+	/// \brief Accumulator for Reduce() and ZipReduce() that checks the visiting order
+	struct IndexSum {
+		long long sum, weighted;
+		bool      merged;
+		IndexSum() : sum(0), weighted(0), merged(false) {}
+		void operator()(const int &v, size_t i)					{ sum += v; weighted += v * (long long) i; }
+		void operator()(const int &v, const int &w, size_t i)	{ sum += v*w; weighted += (v-w) * (long long) i; }
+		void Merge(const IndexSum &o)	{ sum += o.sum; weighted += o.weighted; merged = true; }
+	};
+
+	/// \brief Function object for Transform()
+	struct Triple {
+		int operator()(int v) const	{ return 3*v + 1; }
+	};
+
+	void TestReductions() {
+		TestGroup("Parallel bulk operations");
+		//=============================== Transform, Reduce, ZipReduce, Equals, Sum, Min and Max (N-test cases)
+
+		int idx0 = 53;
+		for(int tests=0; tests<20; tests++) {
+			NArray<int> arr;
+			int dim[7];
+			GenArray(arr, idx0, dim);
+			for (size_t i=0;i<arr.GetSize();i++)
+				arr.GetData()[i] = GetNextIntTestValue(idx0, -1000, 1000);
+			NArray<int> other(arr);
+			for (size_t i=0;i<other.GetSize();i++)
+				other.GetData()[i] += (int) (i % 3);
+
+			// Reference values by plain loops
+			long long sum = 0, weighted = 0, zsum = 0, zweighted = 0;
+			int       mn = arr.GetData()[0], mx = mn;
+			size_t    mnArg = 0, mxArg = 0;
+			for (size_t i=0;i<arr.GetSize();i++) {
+				int v = arr.GetData()[i], w = other.GetData()[i];
+				sum += v; weighted += v * (long long) i;
+				zsum += v*w; zweighted += (v-w) * (long long) i;
+				if (v < mn) { mn = v; mnArg = i; }
+				if (v > mx) { mx = v; mxArg = i; }
+			}
+
+			IndexSum acc, zacc;
+			arr.Reduce(acc);
+			arr.ZipReduce(other, zacc);
+			ExpectOkay(acc.sum==sum && acc.weighted==weighted, "Reduce() of %d elements", (int)arr.GetSize());
+			ExpectOkay(zacc.sum==zsum && zacc.weighted==zweighted, "ZipReduce() of %d elements", (int)arr.GetSize());
+
+			size_t argMin = 1, argMax = 1;
+			int    vMin = arr.Min(&argMin), vMax = arr.Max(&argMax);
+			ExpectOkay(arr.Sum()==(int)sum && vMin==mn && argMin==mnArg && vMax==mx && argMax==mxArg, "Sum(), Min() and Max()");
+
+			ExpectOkay(!(arr==other) && arr.View().Equals(arr.View()), "Equals()");
+
+			// Strided week view in column-major order
+			int t = GetNextIntTestValue(idx0, 0, dim[6]-1);
+			int y = GetNextIntTestValue(idx0, 0, dim[1]-1);
+			NArrayView<int> strided = arr.Slice(6, t).Fix(1, y);
+			IndexSum sacc;
+			strided.Reduce(sacc);
+			long long ssum = 0, sweighted = 0;
+			size_t    k = 0;
+			for (int s=0;s<dim[5];s++)
+			for (int o=0;o<dim[4];o++)
+			for (int a=0;a<dim[3];a++)
+			for (int e=0;e<dim[2];e++)
+			for (int x=0;x<dim[0];x++, k++) {
+				ssum += arr(x,y,e,a,o,s,t); sweighted += arr(x,y,e,a,o,s,t) * (long long) k;
+			}
+			ExpectOkay(sacc.sum==ssum && sacc.weighted==sweighted && !sacc.merged, "Reduce() of a strided view");
+
+			other = arr;
+			other.Transform(Triple());
+			strided.Transform(Triple());
+			bool same = true;
+			for (size_t i=0;i<arr.GetSize();i++) {
+				size_t week = arr.GetSize() / dim[6];
+				size_t yi   = (i / dim[0]) % dim[1];
+				if (i / week == (size_t)t && yi == (size_t)y)
+					same &= arr.GetData()[i]==other.GetData()[i];
+			}
+			ExpectOkay(same, "Transform() of contiguous and strided views");
+		}
+
+		// Large array with several blocks, filled in parallel
+		NArray<double> big(300,200,3);
+		big.Fill(0.5);
+		big(17,199,2) = -1.0;
+		big(299,0,1)  = 2.0;
+		big(299,0,2)  = 2.0;
+		size_t argMin, argMax;
+		double vMin = big.Min(&argMin), vMax = big.Max(&argMax);
+		ExpectOkay(vMin==-1.0 && &big.GetData()[argMin]==&big(17,199,2), "Min() of blocked array");
+		ExpectOkay(vMax== 2.0 && &big.GetData()[argMax]==&big(299,0,1),  "Max() of blocked array, first of equal values");
+		ExpectOkay(big.Sum()==0.5*(big.GetSize()-3) + 3.0, "Sum() of blocked array");
+
+		NArray<int> bigI(300,200), bigJ(300,200);
+		long long sum = 0, weighted = 0;
+		for (size_t i=0;i<bigI.GetSize();i++) {
+			bigI.GetData()[i] = (int) (i % 7) - 3;
+			bigJ.GetData()[i] = 1;
+			sum      += bigI.GetData()[i];
+			weighted += bigI.GetData()[i] * (long long) i;
+		}
+		IndexSum acc, zacc;
+		bigI.Reduce(acc);
+		bigI.ZipReduce(bigJ, zacc);
+		ExpectOkay(acc.merged && acc.sum==sum && acc.weighted==weighted, "Reduce() of blocked array");
+		ExpectOkay(zacc.merged && zacc.sum==sum && zacc.weighted==weighted - (long long)(bigI.GetSize()*(bigI.GetSize()-1)/2), "ZipReduce() of blocked array");
+
+		TestGroup();
+	}
+
+	void TestOutOfBounds() {
+		TestGroup("Out of bounds");
+		//=============================== Slice and Fix indices outside of the array (4 test cases)
+
+		NArray<int> arr(3,4,5);
+		bool assertThrown = false;
+		try { arr.Slice(2, 5); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "Slice() index out of bounds");
+
+		assertThrown = false;
+		try { arr.Slice(3, 0); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "Slice() keeping all dimensions");
+
+		assertThrown = false;
+		try { arr.View().Fix(1, 4); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "Fix() index out of bounds");
+
+		assertThrown = false;
+		try { arr.Slice(1, 0,0)(3); } catch(...) { assertThrown = true; }
+		ExpectOkay(assertThrown, "View access out of bounds");
+
+		TestGroup();
+	}
+
+	void RunTests() {
+		TestSlice();
+		TestBulk();
+		TestReductions();
+		TestOutOfBounds();
+	}
+};
+
+UtNArrayView test_NArrayView;  ///< Global instance automatically registers to UnitTestManager